@@ -0,0 +1,18 @@
+#ifndef TIOS_ANALOG_H
+#define TIOS_ANALOG_H
+
+#include <Arduino.h>
+
+/*
+Calibrated analog conversion:
+ - ADC1/ADC2 characteristics are read from eFuse once at boot (esp_adc_cal)
+ - Each unit gets a 257-point raw->mV table (one point every 16 raw codes)
+ - Conversion is integer only: one table segment plus a 4-bit interpolation
+*/
+
+#define ANALOG_VIEWS 2 // analog pin display options: 0 = 0-255, 1 = mV
+
+void analogBegin();
+int analogMillivolts(int gpio, int raw);
+
+#endif
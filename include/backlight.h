@@ -0,0 +1,53 @@
+#ifndef TIOS_BACKLIGHT_H
+#define TIOS_BACKLIGHT_H
+
+#include <Arduino.h>
+
+/*
+Display power management for the LCD backlight (GPIO38, ledc PWM_BACKLIGHT_CHANNEL):
+ - Awake, the backlight runs at the BRIGHTNESS menu level
+ - After the dim time of the SCREEN IDLE setting without a button event or a change of
+   the wake signal, a ledc hardware fade takes it down to BACKLIGHT_DIM_LEVEL, and after
+   the off time it fades out completely
+ - While the screen is off loop() draws and pushes nothing, so the time goes to the
+   free-running scan, or loop() sleeps on the button queue when the scan has its own task
+ - Any button event or change of the wake signal wakes the screen; a button event that
+   wakes an off screen is used up by it, so it does not also act on a page or the menu
+ - A fade cannot be cut short, so a new fade starts once the running one has finished
+ - Headless operation (headless.h) suspends all this: the backlight is held off and
+   button events are left to the page handlers
+*/
+
+#define BACKLIGHT_GPIO 38
+#define BACKLIGHT_FREQUENCY 10000
+#define BACKLIGHT_RESOLUTION 8
+#define BACKLIGHT_DIM_LEVEL 8      // duty while dimmed (0-255)
+#define BACKLIGHT_DIM_FADE_MS 800  // fade from the awake level down to the dim level
+#define BACKLIGHT_OFF_FADE_MS 400  // fade from the dim level to off
+#define BACKLIGHT_WAKE_FADE_MS 150 // fade back up to the awake level
+#define BACKLIGHT_IDLE_OPTIONS 5   // number of SCREEN IDLE options
+#define BACKLIGHT_NO_WAKE 255      // wake signal: buttons only
+
+enum BacklightState {
+  BACKLIGHT_ON,
+  BACKLIGHT_DIM,
+  BACKLIGHT_OFF
+};
+
+// Idle times per SCREEN IDLE option (index stored in EEPROM)
+extern const unsigned long backlightDimTimes[BACKLIGHT_IDLE_OPTIONS]; // s without activity (0 = always on)
+extern const unsigned long backlightOffTimes[BACKLIGHT_IDLE_OPTIONS]; // s without activity
+
+// Settings (stored in EEPROM)
+extern byte backlightIdle; // SCREEN IDLE option
+extern byte backlightWake; // wake signal (BACKLIGHT_NO_WAKE = buttons only)
+
+void backlightBegin(byte level);
+void backlightSetLevel(byte level);
+byte backlightLevel();
+bool backlightService(const int *states);
+void backlightSuspend(bool suspend);
+bool backlightScreenOn();
+BacklightState backlightState();
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef TIOS_BUTTONS_H
+#define TIOS_BUTTONS_H
+
+#include <Arduino.h>
+
+/*
+Button input service for the BOOT (GPIO0) and KEY (GPIO14) buttons:
+ - Pin change interrupts wake a debounce task, so nothing is polled per frame
+ - A level has to be stable for BUTTON_DEBOUNCE_MS before it counts
+ - Events go into a queue: press, release, long-press, auto-repeat while held, and a
+   chord when the second button goes down while the first is held
+ - A press is sent BUTTON_CHORD_MS after the button went down (or on its release, if
+   sooner), so a chord pressed slightly out of step does not also act as a press
+ - After a chord both buttons stay silent until both are released
+*/
+
+#define BUTTON_DEBOUNCE_MS 20
+#define BUTTON_CHORD_MS 80         // window for the second button of a chord
+#define BUTTON_LONG_MS 600         // hold time for a long-press
+#define BUTTON_REPEAT_DELAY_MS 400 // hold time before auto-repeat starts
+#define BUTTON_REPEAT_MS 60        // auto-repeat interval
+
+// Buttons
+#define BUTTON_LEFT 0  // BOOT button GPIO0 (SEL)
+#define BUTTON_RIGHT 1 // KEY button GPIO14 (OK)
+#define BUTTON_BOTH 2  // chord
+
+enum ButtonEventType {
+  BUTTON_PRESS,
+  BUTTON_RELEASE,
+  BUTTON_LONG,
+  BUTTON_REPEAT,
+  BUTTON_CHORD
+};
+
+struct ButtonEvent {
+  ButtonEventType type;
+  byte button;
+  unsigned long time; // ms
+};
+
+void buttonsBegin();
+void buttonsPoll();
+bool buttonsRead(ButtonEvent &event);
+bool buttonsWait(unsigned long timeout);
+uint32_t buttonsEventCount();
+
+#endif
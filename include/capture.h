@@ -0,0 +1,43 @@
+#ifndef TIOS_CAPTURE_H
+#define TIOS_CAPTURE_H
+
+#include <Arduino.h>
+
+/*
+Pulse-width and duty-cycle inputs on the MCPWM capture channels (pin type 9):
+ - Both edges of the pin are timestamped in hardware by the 80 MHz capture timer, so
+   widths are resolved to 12.5 ns regardless of the scan or frame rate
+ - The capture interrupt keeps the last complete cycle (rise to rise) per channel;
+   readPins() only copies it: value = duty 0-255, like the analog-style types, so a
+   capture pin can drive PWM outputs, timers, comparators and timer block times
+ - Without edges for CAPTURE_TIMEOUT_MS the input is steady: duty 0 or 255 from the
+   pin level, period and high time 0
+ - Each edge costs an interrupt, so the input is meant for signals up to some 10 kHz
+   (sensors, RC receivers); the ESP32-S3 has 6 capture channels (2 MCPWM units x 3),
+   pins that cannot get one read 0
+*/
+
+#define CAPTURE_SLOTS 24        // header pin slots (pinTypes[0-23])
+#define CAPTURE_CHANNELS 6      // MCPWM capture channels on the ESP32-S3
+#define CAPTURE_NO_CHANNEL 255  // slot has no capture channel
+#define CAPTURE_TICKS_PER_US 80 // capture timer (APB clock)
+#define CAPTURE_TIMEOUT_MS 200  // no edge for this long = steady level
+#define CAPTURE_VIEWS 3         // value shown on the display
+
+// Display views - order matches the "CAPTURE VIEW" menu
+#define CAPTURE_VIEW_DUTY 0
+#define CAPTURE_VIEW_HIGH 1
+#define CAPTURE_VIEW_PERIOD 2
+
+extern byte captureViews[CAPTURE_SLOTS];             // stored in EEPROM
+extern byte captureChannels[CAPTURE_SLOTS];
+extern uint32_t captureHighMicros[CAPTURE_SLOTS];    // last high time (us)
+extern uint32_t capturePeriodMicros[CAPTURE_SLOTS];  // last period (us)
+
+void captureBegin();
+bool captureAttach(int slot, int gpio);
+void captureDetach(int slot);
+void captureInputsRead(int *states);
+void captureReport(Print &out);
+
+#endif
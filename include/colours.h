@@ -0,0 +1,65 @@
+#ifndef TIOS_COLOURS_H
+#define TIOS_COLOURS_H
+
+#include <TFT_eSPI.h>
+
+/*
+Sprite colour depth (build flag -DSPRITE_DEPTH=4, 8 or 16):
+ - 4:  16-colour palette, colours below are palette indices (27 KB framebuffer)
+       Anti-aliased primitives and smooth fonts blend in RGB565, which has no meaning
+       for palette indices, so plain shapes and the built-in fonts are used instead
+ - 8:  RGB332, colours below are RGB565 and converted when drawn (54 KB framebuffer)
+ - 16: RGB565 (108 KB framebuffer)
+Conversion to RGB565 for the panel happens in pushSprite().
+*/
+
+#ifndef SPRITE_DEPTH
+#define SPRITE_DEPTH 4
+#endif
+
+#if SPRITE_DEPTH == 4
+
+// Palette indices (see spritePalette)
+#define tftBlack 0
+#define blue 1
+#define darkBlue 2
+#define green 3
+#define grey 4
+#define lightBlue 5
+#define offWhite 6
+#define orange 7
+#define purple 8
+#define seaGreen 9
+#define tftRed 10
+#define tftMagenta 11
+#define tftWhite 12
+#define teal 13
+#define olive 14
+
+#else
+
+// Custom colours
+#define blue 0x297F      // converted from #2d2dff
+#define darkBlue 0x09CA  // converted from #083852
+#define green 0x13E3     // converted from #107C1B
+#define grey 0x3A08      // converted from #3B4143
+#define lightBlue 0x8E7F // converted from #8CCDFF
+#define offWhite 0xAD75  // converted from #ADADAD
+#define orange 0xE320    // converted from #E36600
+#define purple 0x38A8    // converted from #3A1442
+#define seaGreen 0x1A8B  // converted from #164f57
+#define teal 0x0514      // converted from #00A0A0
+#define olive 0x8400     // converted from #808000
+
+// TFT_eSPI colours
+#define tftBlack TFT_BLACK
+#define tftRed TFT_RED
+#define tftMagenta TFT_MAGENTA
+#define tftWhite TFT_WHITE
+
+#endif
+
+// RGB565 value of each palette index (used to build the 4-bit sprite palette)
+extern const uint16_t spritePalette[16];
+
+#endif
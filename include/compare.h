@@ -0,0 +1,25 @@
+#ifndef TIOS_COMPARE_H
+#define TIOS_COMPARE_H
+
+#include <Arduino.h>
+#include "signals.h"
+
+/*
+Analog threshold comparators:
+ - Each block watches one analog pin (0-255 value) and drives a virtual signal
+   (SIGNAL_COMPARATORS + block) that OUT pins and timer enables can use as a source
+ - The signal turns ON above the on threshold and OFF below the off threshold,
+   in between it keeps its state (hysteresis)
+ - Evaluated once per scan with integer compares only
+*/
+
+#define COMPARATORS 4
+#define COMPARATOR_OFF 100 // block not used
+
+extern byte comparatorSources[COMPARATORS]; // analog pin slot or COMPARATOR_OFF
+extern byte comparatorOn[COMPARATORS];      // turn on above
+extern byte comparatorOff[COMPARATORS];     // turn off below
+
+void comparatorsEvaluate(int *states);
+
+#endif
@@ -0,0 +1,23 @@
+#ifndef TIOS_CURVES_H
+#define TIOS_CURVES_H
+
+#include <Arduino.h>
+#include "pwm.h"
+
+/*
+Transfer curves for PWM pins:
+ - Each PWM pin has a curve (linear, gamma, invert, deadband, clamp, S-curve)
+ - The curve is precomputed into a 256-entry table already scaled to the pin's
+   resolution, so applying it in the scan is a single indexed load
+ - Tables are only rebuilt when the curve or resolution of a pin changes
+*/
+
+#define CURVE_COUNT 7   // number of selectable curves
+#define CURVE_SIZE 256  // one entry per 8-bit source value
+
+extern byte pwmCurves[PWM_SLOTS];
+extern uint16_t curveTables[PWM_SLOTS][CURVE_SIZE];
+
+bool curveBuild(int slot, byte resolution);
+
+#endif
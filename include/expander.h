@@ -0,0 +1,52 @@
+#ifndef TIOS_EXPANDER_H
+#define TIOS_EXPANDER_H
+
+#include <Arduino.h>
+#include "i2c_bus.h"
+#include "signals.h"
+
+/*
+I2C GPIO expanders (MCP23017 / PCF8575, 16 pins each):
+ - Expander pins are signals SIGNAL_EXPANDERS and up, configured as INP (pull-up) or OUT
+   with a source like the header pins
+ - Per scan each expander costs one burst read of all 16 inputs and, only when an
+   output changed, one burst write of all 16 outputs
+ - With -DEXPANDER_ASYNC the transfers run in a bus task: the scan uses the inputs of
+   the previous transfer and only hands over its outputs, so its cost does not depend
+   on the bus
+ - Direction changes are queued by expanderConfigure() and applied by the next transfer
+*/
+
+#define EXPANDERS 2
+#define EXPANDER_PINS 16
+#define EXPANDER_MCP23017 0
+#define EXPANDER_PCF8575 1
+
+#ifndef EXPANDER_SDA
+#define EXPANDER_SDA 43
+#endif
+
+#ifndef EXPANDER_SCL
+#define EXPANDER_SCL 44
+#endif
+
+#ifndef EXPANDER_FREQUENCY
+#define EXPANDER_FREQUENCY 400000
+#endif
+
+struct ExpanderConfig {
+  byte chip;
+  byte address;
+};
+
+extern const ExpanderConfig expanderConfigs[EXPANDERS];
+extern bool expanderFound[EXPANDERS];
+
+void expanderBegin(I2cBus &bus);
+int expanderConfigure(const byte *types);
+void expanderReadInputs(int *states);
+void expanderWriteOutputs(const int *states);
+bool expanderOwnsPin(int gpio);
+void expanderReport(Print &out, bool devices);
+
+#endif
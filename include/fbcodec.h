@@ -0,0 +1,46 @@
+#ifndef TIOS_FBCODEC_H
+#define TIOS_FBCODEC_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+Framebuffer stream codec (no Arduino dependencies, builds on Linux as well):
+ - A frame is a 16-byte header, a payload and the Adler-32 of header and payload
+     0  "TFB1"                 4  type (FB_KEY / FB_DELTA)   5  colour depth (4, 8, 16)
+     6  width (LE16)           8  height (LE16)             10  frame number (LE16)
+    12  payload length (LE32)
+ - KEY payload: the 16-entry RGB565 palette (4-bit depth only), then the whole buffer
+   PackBits-compressed
+ - DELTA payload: one bit per 16x16 tile (row-major, LSB first) marking changed tiles,
+   then each changed tile's rows PackBits-compressed, in tile order
+ - PackBits works on units of one byte (4 and 8 bit) or two bytes (16 bit): a control
+   byte below 128 is followed by control+1 literal units, 128 and above by one unit
+   repeated control-126 times
+ - Buffers are the raw sprite memory (4-bit: two pixels per byte, left pixel in the
+   high nibble; 16-bit: RGB565 high byte first)
+The host tool tools/mirror.py is the decoder.
+*/
+
+#define FB_KEY 0
+#define FB_DELTA 1
+#define FB_TILE 16        // tile size (pixels)
+#define FB_HEADER_BYTES 16
+#define FB_CHECK_BYTES 4
+
+struct FbFormat {
+  uint16_t width;
+  uint16_t height;
+  uint8_t depth;
+};
+
+size_t fbRowBytes(const FbFormat &format);
+size_t fbBytes(const FbFormat &format);
+size_t fbTiles(const FbFormat &format);
+size_t fbEncodeBound(const FbFormat &format);
+size_t fbPackBits(const uint8_t *in, size_t bytes, uint8_t unit, uint8_t *out);
+uint32_t fbAdler32(const uint8_t *data, size_t bytes, uint32_t adler = 1);
+size_t fbEncodeKey(const uint8_t *frame, const FbFormat &format, const uint16_t *palette, uint16_t number, uint8_t *out);
+size_t fbEncodeDelta(const uint8_t *frame, uint8_t *previous, const FbFormat &format, uint16_t number, uint8_t *out);
+
+#endif
@@ -0,0 +1,30 @@
+#ifndef TIOS_HEADLESS_H
+#define TIOS_HEADLESS_H
+
+#include <Arduino.h>
+
+/*
+Headless operation for units nobody looks at (HEADLESS menu, or -DHEADLESS at build time):
+ - loop() runs the scan, the jobs and the button service but draws and pushes nothing,
+   and the backlight is held off
+ - The menu still works: both buttons open it lit, leaving it returns to headless
+ - A frame is drawn on request - a single button press, or a "frame" line on the serial
+   port (also sent to a running screen mirror); it stays lit for HEADLESS_SHOW_MS
+ - Built with -DHEADLESS the unit boots headless whatever the stored setting is
+ - The scan report shows the cycles per second reached and the rate the execution time
+   alone would allow, so the gain over a rendering loop can be read off
+*/
+
+#define HEADLESS_OFF 0
+#define HEADLESS_ON 1
+#define HEADLESS_MODES 2       // number of HEADLESS menu options
+#define HEADLESS_SHOW_MS 10000 // time a frame on request stays lit
+
+extern byte headlessMode; // stored in EEPROM
+
+void headlessBegin();
+bool headlessService(bool menuOpen);
+void headlessRequestFrame();
+bool headlessFrameDue();
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef TIOS_I2C_BUS_H
+#define TIOS_I2C_BUS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+I2C bus interface used by the expander driver:
+ - WireBus (i2c_wire.h) drives the ESP32 I2C controller through Wire
+ - MockI2cBus (sim/i2c_mock.h) simulates expander chips in memory for the host simulator
+*/
+
+class I2cBus {
+ public:
+  virtual ~I2cBus() {}
+
+  // Write bytes in one transaction (true if the device acknowledged)
+  virtual bool write(uint8_t address, const uint8_t *data, size_t length) = 0;
+
+  // Read bytes in one transaction, after writing a register pointer with a repeated start
+  // (pointerLength 0 = plain read)
+  virtual bool read(uint8_t address, const uint8_t *pointer, size_t pointerLength, uint8_t *buffer, size_t length) = 0;
+};
+
+#endif
@@ -0,0 +1,21 @@
+#ifndef TIOS_I2C_WIRE_H
+#define TIOS_I2C_WIRE_H
+
+#include <Arduino.h>
+#include <Wire.h>
+#include "i2c_bus.h"
+
+// I2C bus on an ESP32 I2C controller (Wire library)
+class WireBus : public I2cBus {
+ public:
+  explicit WireBus(TwoWire &wire) : wire(wire) {}
+
+  void begin(int sda, int scl, uint32_t frequency);
+  bool write(uint8_t address, const uint8_t *data, size_t length) override;
+  bool read(uint8_t address, const uint8_t *pointer, size_t pointerLength, uint8_t *buffer, size_t length) override;
+
+ private:
+  TwoWire &wire;
+};
+
+#endif
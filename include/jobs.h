@@ -0,0 +1,32 @@
+#ifndef TIOS_JOBS_H
+#define TIOS_JOBS_H
+
+#include <Arduino.h>
+
+/*
+Multi-rate job scheduler for housekeeping work:
+ - Jobs are registered once into a rate group (1 kHz, 100 Hz, 10 Hz or 1 Hz) and run
+   from loop() when their group is due, instead of ad-hoc millis() checks per pass
+ - A divider runs a job on every n-th tick of its group (e.g. 1 Hz / 5 = every 5 s)
+ - A group that falls behind skips the missed ticks (counted) rather than catching up
+ - Run count, total and maximum run time are kept per job
+ - The I/O scan is not a job - it has its own cycle (scan.h)
+*/
+
+#define JOBS_MAX 12
+#define JOB_GROUPS 4
+
+enum JobRate {
+  JOB_1KHZ,
+  JOB_100HZ,
+  JOB_10HZ,
+  JOB_1HZ
+};
+
+extern const unsigned long jobPeriods[JOB_GROUPS]; // us
+
+bool jobAdd(const char *name, JobRate rate, void (*function)(), byte divider = 1);
+void jobsRun();
+void jobsReport(Print &out);
+
+#endif
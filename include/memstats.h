@@ -0,0 +1,25 @@
+#ifndef TIOS_MEMSTATS_H
+#define TIOS_MEMSTATS_H
+
+#include <Arduino.h>
+
+/*
+Heap and stack telemetry (MEMORY page and the serial status line):
+ - Once per second the internal heap is sampled: free bytes, largest free block,
+   minimum free since boot and the fragmentation that follows from them, plus the
+   stack high-water mark of every firmware task
+ - Built with -DMEMORY_TRACKING (and the -Wl,--wrap flags in platformio.ini) every
+   malloc/calloc/realloc/free is counted, so the allocations and frees per frame of
+   the String-heavy UI are visible; a realloc that may move counts as one of each
+ - The serial line carries the uptime in seconds so long runs can be logged and plotted
+*/
+
+#define MEMSTATS_TASKS 5 // tasks whose stacks are watched
+
+void memStatsFrame();
+void memStatsSample();
+void memStatsReset();
+void memStatsReport(Print &out);
+void drawMemoryStats();
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef TIOS_MIRROR_H
+#define TIOS_MIRROR_H
+
+#include <Arduino.h>
+
+/*
+Remote screen mirroring over the USB serial port (decoded by tools/mirror.py):
+ - "mirror on", "mirror off" and "mirror key" lines on the port start and stop the
+   stream or ask for a key frame; "frame" asks a headless unit for one frame (headless.h)
+ - After a frame is drawn, at most every MIRROR_INTERVAL ms, the sprite is encoded
+   (fbcodec.h): a key frame at the start and every MIRROR_KEY_EVERY frames, tile deltas
+   otherwise - a frame without changes is not sent
+ - The encoded frame is written in pieces that fit the free space of the serial transmit
+   buffer, so sending never blocks loop() or the scan; no frame is taken while the last
+   one is still being sent
+ - The buffers are allocated on the first start (MEM_BULK) and kept
+ - The periodic status report pauses while streaming
+*/
+
+#define MIRROR_INTERVAL 200  // minimum time between frames (ms)
+#define MIRROR_KEY_EVERY 50  // frames between key frames
+#define MIRROR_CHUNK 1024    // maximum bytes written per pump
+
+void mirrorStart();
+void mirrorStop();
+bool mirrorStreaming();
+void mirrorFrame();
+void mirrorPump();
+void mirrorReport(Print &out);
+
+#endif
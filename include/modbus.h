@@ -0,0 +1,60 @@
+#ifndef TIOS_MODBUS_H
+#define TIOS_MODBUS_H
+
+#include <stdint.h>
+
+/*
+Modbus RTU slave core (no Arduino dependencies, builds on Linux as well):
+ - Requests are answered from a register image that the scan rebuilds once per cycle,
+   so serving a request never touches the I/O
+ - Writes are validated and handed to a callback which queues them for the scan
+ - Supported functions: 01, 02, 03, 04, 05, 06, 15 (0x0F), 16 (0x10)
+
+Register map:
+ - Coils 0-67:              digital state of signals, writable for OUT pins (fixed HIGH/LOW)
+ - Discrete inputs 0-67:    digital state of every signal (pins, PB1, PB2, T1, T2, C1-C4, X0-X31, D1-D4)
+ - Input registers 0-31:    pinStates (0-255 for analog/PWM, 0/1 for digital)
+ - Input registers 32-55:   calibrated analog pin voltage (mV), or high time (us) of CAP pins
+ - Input registers 64-67:   supply mV, uptime seconds (high, low), FPS
+ - Holding registers 0-3:   timer base values (T1 on, T1 off, T2 on, T2 off)
+ - Holding registers 4-7:   timer multipliers
+ - Holding registers 8-11:  timer sources (0 = fixed, else analog signal index)
+ - Holding registers 16-39: pin types (a changed type clears the pin source)
+ - Holding registers 48-71: pin sources
+ - Holding register 96:     analog smoothing x1000
+ - Holding register 100:    command (1 = apply pin config, 2 = apply and save to EEPROM)
+*/
+
+#define MODBUS_COILS 68      // SIGNAL_COUNT
+#define MODBUS_DISCRETES 68  // SIGNAL_COUNT
+#define MODBUS_INPUT_REGS 68
+#define MODBUS_HOLDING_REGS 101
+#define MODBUS_MAX_FRAME 256
+
+// Exception codes
+#define MODBUS_ILLEGAL_FUNCTION 0x01
+#define MODBUS_ILLEGAL_ADDRESS 0x02
+#define MODBUS_ILLEGAL_VALUE 0x03
+#define MODBUS_DEVICE_BUSY 0x06
+
+enum ModbusTable {
+  MODBUS_COIL,
+  MODBUS_HOLDING
+};
+
+struct ModbusImage {
+  uint8_t coils[MODBUS_COILS];
+  uint8_t discretes[MODBUS_DISCRETES];
+  uint16_t inputRegs[MODBUS_INPUT_REGS];
+  uint16_t holdingRegs[MODBUS_HOLDING_REGS];
+};
+
+// Write callback - called once per value with commit = false to validate (return 0 or
+// MODBUS_ILLEGAL_VALUE), then again with commit = true to queue (return 0 or MODBUS_DEVICE_BUSY)
+typedef uint8_t (*ModbusWriteHandler)(ModbusTable table, uint16_t address, uint16_t value, bool commit);
+
+uint16_t modbusCrc(const uint8_t *data, int length);
+int modbusProcess(uint8_t slaveId, const uint8_t *request, int length, const ModbusImage &image,
+                  ModbusWriteHandler onWrite, uint8_t *response);
+
+#endif
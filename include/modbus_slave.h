@@ -0,0 +1,37 @@
+#ifndef TIOS_MODBUS_SLAVE_H
+#define TIOS_MODBUS_SLAVE_H
+
+#include <Arduino.h>
+
+/*
+Modbus RTU slave on a UART (enabled with the -DMODBUS_ENABLE build flag):
+ - A task on core 0 receives frames (t3.5 silence ends a frame) and answers them from
+   the front copy of a double-buffered register image (see modbus.h for the register map)
+ - modbusUpdate() is called once per scan: it rebuilds the back image from the live state,
+   swaps it in, and applies the writes the task has queued since the last scan
+ - The UART pins are claimed by the slave and cannot be configured as I/O
+ - modbusPoll() is one pass of the task; the host simulator calls it every step instead
+*/
+
+#ifndef MODBUS_ID
+#define MODBUS_ID 1          // slave address
+#endif
+
+#ifndef MODBUS_BAUD
+#define MODBUS_BAUD 115200
+#endif
+
+#ifndef MODBUS_TX_PIN
+#define MODBUS_TX_PIN 43
+#endif
+
+#ifndef MODBUS_RX_PIN
+#define MODBUS_RX_PIN 44
+#endif
+
+void modbusBegin();
+void modbusPoll();
+void modbusUpdate(bool applyWrites);
+bool modbusOwnsPin(int gpio);
+
+#endif
@@ -0,0 +1,27 @@
+#ifndef TIOS_PLACEMENT_H
+#define TIOS_PLACEMENT_H
+
+#include <Arduino.h>
+
+/*
+Memory placement policy:
+ - MEM_FAST buffers are touched every scan/frame and stay in internal SRAM
+   (PSRAM is only used if internal SRAM is exhausted)
+ - MEM_BULK buffers (logs, traces, history) go to PSRAM when the board has it
+ - Every large buffer is recorded in a memory map which is printed at boot
+*/
+
+enum MemoryPolicy {
+  MEM_FAST, // bandwidth-critical: internal SRAM
+  MEM_BULK  // bulk data: PSRAM
+};
+
+#define MEMORY_MAP_SIZE 16 // maximum number of recorded buffers
+
+void* memAlloc(const char *name, size_t bytes, MemoryPolicy policy);
+void memRegister(const char *name, const void *address, size_t bytes);
+bool memPrefersPsram(MemoryPolicy policy);
+const char* memRegion(const void *address);
+void memReport(Print &out);
+
+#endif
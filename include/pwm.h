@@ -0,0 +1,39 @@
+#ifndef TIOS_PWM_H
+#define TIOS_PWM_H
+
+#include <Arduino.h>
+
+/*
+PWM channel manager:
+ - Gives every PWM pin a stable ledc channel for as long as its setting is unchanged
+ - ESP32-S3 ledc channels share a timer in pairs (0/1, 2/3, 4/5, 6/7), so a channel is
+   only handed out when its partner is free or already runs at the same frequency/resolution
+ - Pins that cannot get a channel fall back to a plain digital output (curve output >= 50% = HIGH)
+ - Duty goes through the pin's transfer curve (curves.h) and is only written when it
+   changes, optionally through a ledc hardware fade
+*/
+
+#define PWM_SLOTS 24             // header pin slots (pinTypes[0-23])
+#define PWM_CHANNELS 8           // ledc channels on the ESP32-S3
+#define PWM_BACKLIGHT_CHANNEL 0  // channel 0 drives the LCD backlight
+#define PWM_NO_CHANNEL 255       // slot has no ledc channel (digital fallback)
+#define PWM_PRESETS 5            // number of frequency/resolution presets
+#define PWM_FADES 5              // number of fade time options
+
+// Preset tables (index stored per pin in EEPROM)
+extern const unsigned long pwmPresetFrequencies[PWM_PRESETS];
+extern const byte pwmPresetResolutions[PWM_PRESETS];
+extern const unsigned int pwmFadeTimes[PWM_FADES];
+
+// Per-pin PWM configuration and channel mapping
+extern byte pwmPresets[PWM_SLOTS];
+extern byte pwmFades[PWM_SLOTS];
+extern byte pwmChannels[PWM_SLOTS];
+
+void pwmBegin();
+void pwmReserve(byte channel, unsigned long frequency, byte resolution);
+bool pwmAttach(int slot, int gpio);
+void pwmDetach(int slot);
+void pwmWrite(int slot, int duty); // duty 0-255
+
+#endif
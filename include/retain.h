@@ -0,0 +1,19 @@
+#ifndef TIOS_RETAIN_H
+#define TIOS_RETAIN_H
+
+#include <Arduino.h>
+
+/*
+Retained runtime state:
+ - Switch toggles and timer phases are mirrored into RTC no-init memory every scan
+ - After a warm reset (watchdog, panic, software, brownout) the state is restored if
+   the magic, the checksum and the pin configuration it was saved with all match
+ - A power-on reset always starts from the EEPROM configuration only
+ - The configuration hash is taken when the pins are set up, not every scan
+*/
+
+bool retainRestore();
+void retainConfigure();
+void retainSave();
+
+#endif
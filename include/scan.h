@@ -0,0 +1,33 @@
+#ifndef TIOS_SCAN_H
+#define TIOS_SCAN_H
+
+#include <Arduino.h>
+
+/*
+PLC-style scan cycle:
+ - Each cycle snapshots the inputs, evaluates the logic and then commits the outputs
+ - FREE RUN executes one cycle per loop() pass (the original behaviour)
+ - A fixed period runs the cycle in its own task on core 1, woken by an esp_timer, so
+   the display cannot delay it - a cycle that has not finished before the next one is
+   due counts as an overrun and the missed cycles are skipped
+ - Start jitter and execution time are collected in histograms (SCAN_BINS buckets)
+ - The rate reached is measured each second; the exec bound (cycles per second from the
+   mean execution time) is the ceiling of FREE RUN when loop() does nothing else
+*/
+
+#define SCAN_PERIODS 4 // number of selectable periods
+#define SCAN_BINS 10   // histogram buckets
+
+extern const unsigned int scanPeriods[SCAN_PERIODS]; // us (0 = free run)
+extern const unsigned int scanBinLimits[SCAN_BINS-1]; // upper bucket limits (us)
+
+void scanBegin(void (*cycle)());
+void scanSetPeriod(byte index);
+byte scanPeriod();
+bool scanFixed();
+void scanFreeRun();
+void scanReset();
+void scanReport(Print &out, bool histograms);
+void drawScanStats();
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef TIOS_SERVO_H
+#define TIOS_SERVO_H
+
+#include <Arduino.h>
+
+/*
+Servo and pulse-train outputs on the RMT peripheral (pin type 7):
+ - SERVO: a 50 Hz frame with a 500-2500 us pulse (value 0-255), repeated by the RMT in
+   loop mode - a new width is written into the channel memory and taken over at the
+   next frame, so the scan only touches the pin when the value changes
+ - BURST: a rising edge of the source (0 -> non-zero) sends a finite train of 1 kHz
+   pulses, counted by the RMT loop counter and stopped by hardware; edges during a
+   running burst are ignored
+ - The ESP32-S3 has 4 RMT transmit channels; pins that cannot get one are held LOW
+*/
+
+#define SERVO_SLOTS 24       // header pin slots (pinTypes[0-23])
+#define SERVO_CHANNELS 4     // RMT TX channels on the ESP32-S3
+#define SERVO_NO_CHANNEL 255 // slot has no RMT channel (held LOW)
+#define SERVO_MODES 4        // SERVO and three burst lengths
+
+// Modes - order matches the "SERVO MODE" menu
+#define SERVO_PULSE 0
+extern const unsigned int servoBurstCounts[SERVO_MODES]; // pulses per burst (0 = servo)
+
+extern byte servoModes[SERVO_SLOTS];
+extern byte servoChannels[SERVO_SLOTS];
+
+void servoBegin();
+bool servoAttach(int slot, int gpio);
+void servoDetach(int slot);
+void servoWrite(int slot, int value); // servo: 0-255 pulse width, burst: edge trigger
+
+#endif
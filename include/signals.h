@@ -0,0 +1,25 @@
+#ifndef TIOS_SIGNALS_H
+#define TIOS_SIGNALS_H
+
+/*
+Signal table layout (pinStates, pinTypes, pinSources, pin labels):
+ - 0-23:  header pins
+ - 24-25: PB1/PB2 buttons
+ - 26-27: T1/T2 timers
+ - 28-31: comparators C1-C4 (virtual, see compare.h)
+ - 32-63: I2C expander pins X0-X31 (see expander.h)
+ - 64-67: timer blocks D1-D4 (virtual, see timerblocks.h)
+A source below 100 is a signal index, 101-199 is the inverted signal (index + 100),
+100 is no source.
+*/
+
+#define SIGNAL_COUNT 68
+#define SIGNAL_PB1 24
+#define SIGNAL_PB2 25
+#define SIGNAL_T1 26
+#define SIGNAL_T2 27
+#define SIGNAL_COMPARATORS 28  // first comparator signal
+#define SIGNAL_EXPANDERS 32    // first expander pin signal
+#define SIGNAL_TIMER_BLOCKS 64 // first timer block signal (also the end of the expander pins)
+
+#endif
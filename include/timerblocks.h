@@ -0,0 +1,43 @@
+#ifndef TIOS_TIMERBLOCKS_H
+#define TIOS_TIMERBLOCKS_H
+
+#include <Arduino.h>
+#include "signals.h"
+
+/*
+Trigger-driven timer blocks (IEC 61131-3 style):
+ - Each block watches a trigger signal (any signal, direct or inverted) and drives a virtual
+   signal (SIGNAL_TIMER_BLOCKS + block) that OUT pins and timer enables can use as a source
+ - ON DELAY (TON): ON once the trigger has been ON for the time, OFF with the trigger
+ - OFF DELAY (TOF): ON with the trigger, OFF once the trigger has been OFF for the time
+ - PULSE (TP): a rising edge gives one pulse of the time, edges during the pulse are ignored
+ - RETRIGGER: monostable, every rising edge restarts the pulse
+ - The time is one of the BLOCK_PRESETS constants in ms (no free value as base x
+   multiplier like T1/T2), or the preset scaled by an analog pin (0-255 = 0-100%), taken
+   when the timing starts
+ - Running blocks sit in a deadline queue ordered by expiry, so a scan only compares the
+   earliest deadline with the clock - blocks are touched on trigger edges and expiry only
+*/
+
+#define TIMER_BLOCKS 4
+#define BLOCK_PRESETS 9
+#define BLOCK_FIXED 100 // time source: preset only
+
+// Block modes - order matches the "MODE" menu
+#define BLOCK_OFF 0
+#define BLOCK_TON 1
+#define BLOCK_TOF 2
+#define BLOCK_TP 3
+#define BLOCK_RETRIGGER 4
+#define BLOCK_MODES 5
+
+extern const unsigned long blockPresetTimes[BLOCK_PRESETS]; // ms
+extern byte blockModes[TIMER_BLOCKS];
+extern byte blockTriggers[TIMER_BLOCKS];    // signal source (100 = none)
+extern byte blockPresets[TIMER_BLOCKS];     // index into blockPresetTimes
+extern byte blockTimeSources[TIMER_BLOCKS]; // analog pin slot or BLOCK_FIXED
+
+void timerBlocksReset(int *states);
+void timerBlocksEvaluate(int *states);
+
+#endif
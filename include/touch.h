@@ -0,0 +1,38 @@
+#ifndef TIOS_TOUCH_H
+#define TIOS_TOUCH_H
+
+#include <stdint.h>
+
+/*
+Capacitive touch logic (no Arduino dependencies, builds on Linux as well):
+ - The threshold of a pad is a percentage of its baseline (the untouched reading); on the
+   ESP32-S3 the touch FSM compares the filtered reading against baseline + threshold
+   and raises an interrupt on touch and on release
+ - touchOutput() turns those events into the signal value: MOMENTARY follows the
+   finger, TOGGLE flips on every touch
+ - TouchModel mirrors what the S3 does in hardware (IIR filter, baseline that only
+   tracks while released, release hysteresis) so host builds can replay recorded
+   touch traces through the same threshold
+*/
+
+#define TOUCH_MOMENTARY 0
+#define TOUCH_TOGGLE 1
+#define TOUCH_MODES 2
+#define TOUCH_LEVELS 4 // threshold options - order matches the "THRESHOLD" menu
+
+extern const uint8_t touchPercents[TOUCH_LEVELS];
+
+struct TouchModel {
+  uint32_t filtered; // IIR-filtered reading (x16)
+  uint32_t baseline; // untouched reading (x16)
+  bool touched;
+  bool started;
+};
+
+uint32_t touchThreshold(uint32_t baseline, uint8_t level);
+int touchOutput(uint8_t mode, int output, bool touched);
+void touchModelReset(TouchModel &model);
+bool touchModelUpdate(TouchModel &model, uint32_t raw, uint32_t threshold);
+uint32_t touchModelBaseline(const TouchModel &model);
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef TIOS_TOUCH_INPUT_H
+#define TIOS_TOUCH_INPUT_H
+
+#include <Arduino.h>
+#include "touch.h"
+
+/*
+Capacitive touch inputs on the ESP32-S3 touch channels (pin type 8):
+ - Header pins on GPIO1-13 (pins 1, 2, 3, 10, 11, 12, 13) can be TOUCH inputs
+ - The touch FSM measures every pad in hardware with the IIR filter enabled and tracks
+   the baseline itself; the threshold (touch.h) is set once when the pin is attached
+ - Touch and release interrupts queue events, readPins() only drains the queue, so the
+   scan never reads the touch hardware
+ - The raw reading is sampled by a 10 Hz job for the display only
+*/
+
+#define TOUCH_SLOTS 24      // header pin slots (pinTypes[0-23])
+#define TOUCH_EVENT_QUEUE 16
+
+extern byte touchModes[TOUCH_SLOTS];  // TOUCH_MOMENTARY or TOUCH_TOGGLE
+extern byte touchLevels[TOUCH_SLOTS]; // index into touchPercents
+extern uint32_t touchValues[TOUCH_SLOTS]; // last raw reading (display)
+
+void touchInputBegin();
+bool touchCapable(int gpio);
+bool touchInputAttach(int slot, int gpio);
+void touchInputDetach(int slot);
+bool touchInputActive(int slot);
+void touchInputsRead(int *states);
+void touchInputsSample();
+
+#endif
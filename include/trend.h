@@ -0,0 +1,33 @@
+#ifndef TIOS_TREND_H
+#define TIOS_TREND_H
+
+#include <Arduino.h>
+
+/*
+Trend view for analog pins:
+ - Every analog pin keeps a history of TREND_POINTS columns in PSRAM, each column
+   holding the min/max of all samples in its time slot (min/max decimation)
+ - ROLL mode scrolls continuously, TRIGGER mode arms on a rising crossing of the
+   trigger level, keeps TREND_PRETRIGGER columns before it and then holds the capture
+ - The plot is scrolled in place and only the newest columns are drawn
+*/
+
+#define TREND_POINTS 160        // history columns per pin (one per plot pixel)
+#define TREND_HEIGHT 128        // plot height in pixels (value 0-255 >> 1)
+#define TREND_PRETRIGGER 40     // columns kept before the trigger point
+#define TREND_TRIGGER_LEVEL 128 // rising edge level for TRIGGER mode
+#define TREND_TIMEBASES 5       // number of selectable column periods
+
+#define TREND_ROLL 0
+#define TREND_TRIGGER 1
+
+void trendBegin();
+void trendSample();
+void trendEnter(byte mode);
+void trendNextPin();
+void trendNextTimebase();
+void trendArm();
+byte trendMode();
+void drawTrend();
+
+#endif
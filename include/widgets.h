@@ -0,0 +1,28 @@
+#ifndef TIOS_WIDGETS_H
+#define TIOS_WIDGETS_H
+
+#include <TFT_eSPI.h>
+
+/*
+Widget stamps:
+ - Pin boxes, type badges, value pills, state dots and the type legend are rendered
+   once into off-screen stamps and afterwards copied into the frame sprite
+ - Each stamp remembers the colour/state it was drawn with and is redrawn when that
+   changes; widgetsInvalidate() drops all stamps (theme or configuration change)
+ - Text that changes every frame (values) is still drawn on top of the stamps
+*/
+
+#define PIN_TYPES 9 // pin type codes 1-9 (typeColours, pinTypeLabels)
+
+// Drawing primitives (anti-aliased unless the sprite uses a palette)
+void fillBox(TFT_eSprite &target, int x, int y, int w, int h, int radius, unsigned short colour, uint32_t bgColour = 0x00FFFFFF);
+void fillDot(TFT_eSprite &target, int x, int y, int radius, unsigned short colour, uint32_t bgColour = 0x00FFFFFF);
+
+void widgetsInvalidate();
+void drawPinBox(int slot, int x, int y, unsigned short colour);
+void drawTypeBadge(int type, int x, int y);
+void drawValuePill(int x, int y, unsigned short colour, unsigned short lineColour);
+void drawStateDot(int state, int centreX, int centreY);
+void drawTypeLegend(int x, int y, unsigned short bgColour, int textOffset);
+
+#endif
@@ -0,0 +1,4 @@
+Import("env")
+
+# 32-bit host build: unsigned long is 32 bits as on the ESP32, so millis() wraps after 49.7 days
+env.Append(CCFLAGS=["-m32"], LINKFLAGS=["-m32"])
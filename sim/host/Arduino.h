@@ -0,0 +1,225 @@
+#ifndef TIOS_SIM_ARDUINO_H
+#define TIOS_SIM_ARDUINO_H
+
+/*
+Host stand-in for the Arduino-ESP32 core (simulator build only):
+ - Time comes from the virtual clock in sim.h, so millis()/micros() only move when the
+   simulator advances them; built with -m32 they wrap like on the ESP32
+ - Pins are arrays the input script writes and the output trace reads
+ - FreeRTOS tasks are never started - the simulator calls the scan and the button
+   service itself - queues and mutexes work so the modules run unchanged
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdarg.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <string>
+
+using std::min;
+using std::max;
+
+template<class T> T constrain(T value, T low, T high) { return value < low ? low : (value > high ? high : value); }
+
+#define PROGMEM
+#define IRAM_ATTR
+#define RTC_NOINIT_ATTR
+#define RTC_DATA_ATTR
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define INPUT_PULLDOWN 0x09
+#define RISING 0x01
+#define FALLING 0x02
+#define CHANGE 0x03
+
+#define DEC 10
+#define HEX 16
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+// Time (virtual clock)
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// GPIO and ADC
+void pinMode(uint8_t pin, uint8_t mode);
+int digitalRead(uint8_t pin);
+void digitalWrite(uint8_t pin, uint8_t value);
+uint16_t analogRead(uint8_t pin);
+void analogReadResolution(uint8_t bits);
+uint32_t getCpuFrequencyMhz();
+
+#define digitalPinToInterrupt(p) (p)
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode);
+
+// Touch (readings come from the script, interrupts from the host touch model)
+typedef uint32_t touch_value_t;
+touch_value_t touchRead(uint8_t pin);
+void touchAttachInterruptArg(uint8_t pin, void (*handler)(void*), void *arg, touch_value_t threshold);
+void touchDetachInterrupt(uint8_t pin);
+bool touchInterruptGetLastStatus(uint8_t pin);
+
+// ledc PWM
+uint32_t ledcSetup(uint8_t channel, uint32_t frequency, uint8_t resolution);
+void ledcAttachPin(uint8_t pin, uint8_t channel);
+void ledcDetachPin(uint8_t pin);
+void ledcWrite(uint8_t channel, uint32_t duty);
+uint32_t ledcRead(uint8_t channel);
+
+bool psramFound();
+
+// Arduino String (the subset the firmware uses)
+class String {
+ public:
+  String() {}
+  String(const char *text) : text(text ? text : "") {}
+  String(const std::string &text) : text(text) {}
+  String(char c) : text(1, c) {}
+  String(unsigned char value, unsigned char base = DEC) { format(base == HEX ? "%x" : "%u", (unsigned)value); }
+  String(int value) { format("%d", value); }
+  String(unsigned int value) { format("%u", value); }
+  String(long value) { format("%ld", value); }
+  String(unsigned long value) { format("%lu", value); }
+  String(float value, unsigned char decimals = 2) { format("%.*f", decimals, (double)value); }
+  String(double value, unsigned char decimals = 2) { format("%.*f", decimals, value); }
+
+  long toInt() const { return atol(text.c_str()); }
+  float toFloat() const { return atof(text.c_str()); }
+  unsigned int length() const { return text.size(); }
+  const char* c_str() const { return text.c_str(); }
+  char charAt(unsigned int index) const { return index < text.size() ? text[index] : 0; }
+  String substring(unsigned int from) const { return from < text.size() ? String(text.substr(from)) : String(); }
+  String substring(unsigned int from, unsigned int to) const { return from < text.size() ? String(text.substr(from, to - from)) : String(); }
+
+  bool operator==(const String &other) const { return text == other.text; }
+  bool operator!=(const String &other) const { return text != other.text; }
+  String& operator+=(const String &other) { text += other.text; return *this; }
+  friend String operator+(const String &a, const String &b) { return String(a.text + b.text); }
+  friend String operator+(const char *a, const String &b) { return String(std::string(a) + b.text); }
+  friend String operator+(const String &a, const char *b) { return String(a.text + b); }
+
+ private:
+  std::string text;
+
+  void format(const char *pattern, ...) {
+    char buffer[32];
+    va_list args;
+    va_start(args, pattern);
+    vsnprintf(buffer, sizeof(buffer), pattern, args);
+    va_end(args);
+    text = buffer;
+  }
+};
+
+// Print / Serial (the driver decides where Serial goes, stdout carries the output trace)
+class Print {
+ public:
+  virtual ~Print() {}
+  virtual size_t write(uint8_t value) = 0;
+  virtual size_t write(const uint8_t *buffer, size_t length);
+
+  size_t print(const char *text) { return write((const uint8_t*)text, strlen(text)); }
+  size_t print(const String &text) { return print(text.c_str()); }
+  size_t print(int value) { return printf("%d", value); }
+  size_t print(unsigned int value) { return printf("%u", value); }
+  size_t print(long value) { return printf("%ld", value); }
+  size_t print(unsigned long value) { return printf("%lu", value); }
+  size_t print(double value, int decimals = 2) { return printf("%.*f", decimals, value); }
+  size_t println() { return print("\n"); }
+  template<class T> size_t println(T value) { return print(value) + println(); }
+  size_t printf(const char *pattern, ...) __attribute__((format(printf, 2, 3)));
+};
+
+class HardwareSerial : public Print {
+ public:
+  HardwareSerial(FILE *stream) : stream(stream) {}
+  void begin(unsigned long baud, uint32_t config = 0, int8_t rxPin = -1, int8_t txPin = -1) {}
+  size_t setRxBufferSize(size_t size) { return size; }
+  int available() { return input.size() - inputRead; }
+  int read() { return inputRead < input.size() ? (uint8_t)input[inputRead++] : -1; }
+  int availableForWrite() { return 256; } // transmit buffer of the USB serial port
+  void attach(FILE *output) { stream = output; } // nullptr = discard
+  void feed(const std::string &text) { // received text (script, Modbus master)
+    if(inputRead == input.size()) {
+      input.clear();
+      inputRead = 0;
+    }
+
+    input += text;
+  }
+  size_t write(uint8_t value) override { return stream == nullptr || fputc(value, stream) != EOF ? 1 : 0; }
+  size_t write(const uint8_t *buffer, size_t length) override { return stream == nullptr ? length : fwrite(buffer, 1, length, stream); }
+  using Print::write;
+
+ private:
+  FILE *stream;
+  std::string input;
+  size_t inputRead = 0;
+};
+
+#define SERIAL_8N1 0x800001c
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+
+// ESP object
+class EspClass {
+ public:
+  uint32_t getFreeHeap();
+  uint32_t getCycleCount();
+};
+
+extern EspClass ESP;
+
+// FreeRTOS (tasks are not run - see above)
+typedef void* TaskHandle_t;
+typedef void* SemaphoreHandle_t;
+typedef void* QueueHandle_t;
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef int portMUX_TYPE;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define portMAX_DELAY 0xFFFFFFFF
+#define pdMS_TO_TICKS(ms) (ms)
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux) (void)(mux)
+#define portEXIT_CRITICAL(mux) (void)(mux)
+#define portENTER_CRITICAL_ISR(mux) (void)(mux)
+#define portEXIT_CRITICAL_ISR(mux) (void)(mux)
+#define portYIELD_FROM_ISR(woken) (void)(woken)
+
+BaseType_t xTaskCreatePinnedToCore(void (*task)(void*), const char *name, uint32_t stack, void *parameter,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core);
+void vTaskDelay(TickType_t ticks);
+TaskHandle_t xTaskGetHandle(const char *name);
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task);
+BaseType_t xTaskNotifyGive(TaskHandle_t task);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken);
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks);
+
+SemaphoreHandle_t xSemaphoreCreateMutex();
+BaseType_t xSemaphoreTake(SemaphoreHandle_t mutex, TickType_t ticks);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t mutex);
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize);
+BaseType_t xQueueSend(QueueHandle_t queue, const void *item, TickType_t ticks);
+BaseType_t xQueueSendFromISR(QueueHandle_t queue, const void *item, BaseType_t *woken);
+BaseType_t xQueueReceive(QueueHandle_t queue, void *item, TickType_t ticks);
+BaseType_t xQueuePeek(QueueHandle_t queue, void *item, TickType_t ticks);
+
+#endif
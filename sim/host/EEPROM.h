@@ -0,0 +1,26 @@
+#ifndef TIOS_SIM_EEPROM_H
+#define TIOS_SIM_EEPROM_H
+
+#include <Arduino.h>
+
+// Host EEPROM: a byte image the simulator can load from and save to a file
+class EEPROMClass {
+ public:
+  bool begin(size_t size);
+  uint8_t read(int address);
+  void write(int address, uint8_t value);
+  float readFloat(int address);
+  size_t writeFloat(int address, float value);
+  bool commit();
+
+  uint8_t *data();
+  size_t length();
+
+ private:
+  uint8_t *image = nullptr;
+  size_t size = 0;
+};
+
+extern EEPROMClass EEPROM;
+
+#endif
@@ -0,0 +1,160 @@
+#ifndef TIOS_SIM_TFT_ESPI_H
+#define TIOS_SIM_TFT_ESPI_H
+
+#include <Arduino.h>
+
+/*
+Host TFT_eSPI: the simulator runs the display code paths (and finds their bugs); sprite
+shapes are filled into the sprite buffer at its colour depth, so screen mirroring has
+pixels to send, while text, smooth edges and the panel itself are not rendered
+*/
+
+#define TFT_BLACK 0x0000
+#define TFT_WHITE 0xFFFF
+#define TFT_RED 0xF800
+#define TFT_GREEN 0x07E0
+#define TFT_YELLOW 0xFFE0
+#define TFT_MAGENTA 0xF81F
+#define PSRAM_ENABLE 3
+
+class TFT_eSPI {
+ public:
+  void init() {}
+  void setRotation(uint8_t rotation) {}
+  void fillScreen(uint32_t colour) {}
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data) {}
+  int32_t width() { return 170; }
+  int32_t height() { return 320; }
+};
+
+class TFT_eSprite : public TFT_eSPI {
+ public:
+  TFT_eSprite(TFT_eSPI *display) {}
+  ~TFT_eSprite() { deleteSprite(); }
+
+  void* createSprite(int16_t w, int16_t h, uint8_t frames = 1) {
+    deleteSprite();
+    spriteWidth = w;
+    spriteHeight = h;
+    bytes = (size_t)w * h * depth / 8 + 1;
+    buffer = calloc(1, bytes);
+    return buffer;
+  }
+
+  void deleteSprite() { free(buffer); buffer = nullptr; }
+  bool created() { return buffer != nullptr; }
+  void* getPointer() { return buffer; }
+  void* setColorDepth(int8_t bits) { depth = bits; return buffer; }
+  int8_t getColorDepth() { return depth; }
+  void setAttribute(uint8_t attribute, uint8_t value) {}
+  void createPalette(const uint16_t *palette, uint8_t colours = 16) {}
+
+  int32_t width() { return spriteWidth; }
+  int32_t height() { return spriteHeight; }
+
+  void fillSprite(uint32_t colour) { fillRect(0, 0, spriteWidth, spriteHeight, colour); }
+  void fillRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t colour) {
+    int32_t x0 = std::max(x, 0), x1 = std::min(x + w, spriteWidth);
+    int32_t y0 = std::max(y, 0), y1 = std::min(y + h, spriteHeight);
+
+    if(buffer == nullptr) {
+      return;
+    }
+
+    for(int32_t row=y0; row<y1; row++) {
+      int32_t column = x0;
+
+      if(depth == 4 && spriteWidth % 2 == 0) { // whole bytes of a row in one memset (the sim draws every frame)
+        if(column % 2 == 1 && column < x1) {
+          drawPixel(column++, row, colour);
+        }
+
+        int32_t pairs = (x1 - column) / 2;
+        memset((uint8_t*)buffer + ((size_t)row * spriteWidth + column) / 2, (colour & 0x0F) * 0x11, pairs);
+        column += pairs * 2;
+      }
+
+      for(; column<x1; column++) {
+        drawPixel(column, row, colour);
+      }
+    }
+  }
+  void drawRect(int32_t x, int32_t y, int32_t w, int32_t h, uint32_t colour) {
+    drawFastHLine(x, y, w, colour);
+    drawFastHLine(x, y + h - 1, w, colour);
+    drawFastVLine(x, y, h, colour);
+    drawFastVLine(x + w - 1, y, h, colour);
+  }
+  void drawRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t colour) { drawRect(x, y, w, h, colour); }
+  void fillRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t colour) { fillRect(x, y, w, h, colour); }
+  void fillSmoothRoundRect(int32_t x, int32_t y, int32_t w, int32_t h, int32_t r, uint32_t colour, uint32_t bgColour = 0x00FFFFFF, uint8_t quadrants = 0xF) { fillRect(x, y, w, h, colour); }
+  void fillSmoothCircle(int32_t x, int32_t y, int32_t r, uint32_t colour, uint32_t bgColour = 0x00FFFFFF) { fillCircle(x, y, r, colour); }
+  void fillCircle(int32_t x, int32_t y, int32_t r, uint32_t colour) {
+    for(int32_t dy=-r; dy<=r; dy++) {
+      for(int32_t dx=-r; dx<=r; dx++) {
+        if(dx * dx + dy * dy <= r * r) {
+          drawPixel(x + dx, y + dy, colour);
+        }
+      }
+    }
+  }
+  void drawLine(int32_t x0, int32_t y0, int32_t x1, int32_t y1, uint32_t colour) {
+    int32_t steps = std::max(abs(x1 - x0), abs(y1 - y0));
+
+    for(int32_t i=0; i<=steps; i++) {
+      drawPixel(x0 + (steps ? (x1 - x0) * i / steps : 0), y0 + (steps ? (y1 - y0) * i / steps : 0), colour);
+    }
+  }
+  void drawFastVLine(int32_t x, int32_t y, int32_t h, uint32_t colour) { fillRect(x, y, 1, h, colour); }
+  void drawFastHLine(int32_t x, int32_t y, int32_t w, uint32_t colour) { fillRect(x, y, w, 1, colour); }
+
+  // 4-bit: palette index, two pixels per byte (left in the high nibble); 8-bit: RGB332;
+  // 16-bit: RGB565 with the high byte first, as TFT_eSprite keeps it
+  void drawPixel(int32_t x, int32_t y, uint32_t colour) {
+    if(buffer == nullptr || x < 0 || y < 0 || x >= spriteWidth || y >= spriteHeight) {
+      return;
+    }
+
+    uint8_t *pixels = (uint8_t*)buffer;
+    size_t index = (size_t)y * spriteWidth + x;
+
+    if(depth == 4) {
+      uint8_t &pair = pixels[index / 2];
+      pair = x % 2 == 0 ? (pair & 0x0F) | (colour & 0x0F) << 4 : (pair & 0xF0) | (colour & 0x0F);
+    }
+    else if(depth == 8) {
+      pixels[index] = ((colour >> 8) & 0xE0) | ((colour >> 6) & 0x1C) | ((colour >> 3) & 0x03);
+    }
+    else {
+      pixels[index * 2] = colour >> 8;
+      pixels[index * 2 + 1] = colour;
+    }
+  }
+
+  void setTextDatum(uint8_t datum) {}
+  void setTextFont(uint8_t font) {}
+  void setTextColor(uint16_t colour) {}
+  void setTextColor(uint16_t colour, uint16_t background, bool fill = false) {}
+  int16_t drawString(const String &text, int32_t x, int32_t y, uint8_t font = 1) { return text.length() * 6; }
+  int16_t drawString(const char *text, int32_t x, int32_t y, uint8_t font = 1) { return strlen(text) * 6; }
+  void loadFont(const uint8_t *font) {}
+  void unloadFont() {}
+
+  void pushSprite(int32_t x, int32_t y) {}
+  void pushSprite(int32_t x, int32_t y, uint16_t transparent) {}
+  bool pushSprite(int32_t x, int32_t y, int32_t sx, int32_t sy, int32_t sw, int32_t sh) { return true; }
+  void scroll(int16_t dx, int16_t dy = 0) {}
+  bool pushToSprite(TFT_eSprite *target, int32_t x, int32_t y) { return true; }
+  bool pushToSprite(TFT_eSprite *target, int32_t x, int32_t y, uint16_t transparent) { return true; }
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint16_t *data) {}
+  void pushImage(int32_t x, int32_t y, int32_t w, int32_t h, const uint8_t *data, bool bpp8 = true, uint16_t *palette = nullptr) {}
+
+ private:
+  void *buffer = nullptr;
+  size_t bytes = 0;
+  int32_t spriteWidth = 170;
+  int32_t spriteHeight = 320;
+  int8_t depth = 16;
+};
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef TIOS_SIM_WIRE_H
+#define TIOS_SIM_WIRE_H
+
+#include <Arduino.h>
+
+// Host Wire: transactions go to the simulated expander chips (simI2c, sim/i2c_mock.h)
+class TwoWire {
+ public:
+  bool begin(int sda = -1, int scl = -1, uint32_t frequency = 0) { return true; }
+  void beginTransmission(uint16_t address);
+  uint8_t endTransmission(bool sendStop = true);
+  size_t requestFrom(uint16_t address, size_t size, bool sendStop = true);
+  size_t write(uint8_t value);
+  size_t write(const uint8_t *buffer, size_t length);
+  int available() { return receiveLength - receiveRead; }
+  int read() { return receiveRead < receiveLength ? receive[receiveRead++] : -1; }
+  size_t readBytes(uint8_t *buffer, size_t length);
+
+ private:
+  static constexpr size_t BUFFER = 128; // as the ESP32 Wire buffers
+  uint16_t address = 0;
+  uint8_t transmit[BUFFER];
+  size_t transmitLength = 0;
+  uint8_t pointer[BUFFER];   // written before a repeated start
+  size_t pointerLength = 0;
+  uint8_t receive[BUFFER];
+  size_t receiveLength = 0;
+  size_t receiveRead = 0;
+};
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef TIOS_SIM_DRIVER_LEDC_H
+#define TIOS_SIM_DRIVER_LEDC_H
+
+#include <stdint.h>
+
+// Host ledc driver: a hardware fade jumps straight to its target duty
+typedef int esp_err_t;
+typedef enum { LEDC_LOW_SPEED_MODE } ledc_mode_t;
+typedef enum { LEDC_CHANNEL_0 } ledc_channel_t;
+typedef enum { LEDC_FADE_NO_WAIT, LEDC_FADE_WAIT_DONE } ledc_fade_mode_t;
+
+esp_err_t ledc_fade_func_install(int flags);
+esp_err_t ledc_set_fade_with_time(ledc_mode_t mode, ledc_channel_t channel, uint32_t duty, int time);
+esp_err_t ledc_fade_start(ledc_mode_t mode, ledc_channel_t channel, ledc_fade_mode_t wait);
+
+#endif
@@ -0,0 +1,36 @@
+#ifndef TIOS_SIM_DRIVER_MCPWM_H
+#define TIOS_SIM_DRIVER_MCPWM_H
+
+#include <stdint.h>
+
+// Host MCPWM driver (capture only): the pulse trains set by the script are turned into
+// edge timestamps on the 80 MHz capture clock by simCaptureStep() (host.cpp)
+typedef int esp_err_t;
+#ifndef ESP_OK
+#define ESP_OK 0
+#endif
+
+typedef enum { MCPWM_UNIT_0, MCPWM_UNIT_1 } mcpwm_unit_t;
+typedef enum { MCPWM_CAP_0 = 12, MCPWM_CAP_1, MCPWM_CAP_2 } mcpwm_io_signals_t;
+typedef enum { MCPWM_SELECT_CAP0, MCPWM_SELECT_CAP1, MCPWM_SELECT_CAP2 } mcpwm_capture_channel_id_t;
+typedef enum { MCPWM_NEG_EDGE = 1, MCPWM_POS_EDGE = 2, MCPWM_BOTH_EDGE = 3 } mcpwm_capture_on_edge_t;
+
+typedef struct {
+  mcpwm_capture_on_edge_t cap_edge;
+  uint32_t cap_value;
+} cap_event_data_t;
+
+typedef bool (*cap_isr_cb_t)(mcpwm_unit_t mcpwm, mcpwm_capture_channel_id_t cap_channel, const cap_event_data_t *edata, void *user_data);
+
+typedef struct {
+  mcpwm_capture_on_edge_t cap_edge;
+  uint32_t cap_prescale;
+  cap_isr_cb_t capture_cb;
+  void *user_data;
+} mcpwm_capture_config_t;
+
+esp_err_t mcpwm_gpio_init(mcpwm_unit_t unit, mcpwm_io_signals_t signal, int gpio);
+esp_err_t mcpwm_capture_enable_channel(mcpwm_unit_t unit, mcpwm_capture_channel_id_t channel, const mcpwm_capture_config_t *config);
+esp_err_t mcpwm_capture_disable_channel(mcpwm_unit_t unit, mcpwm_capture_channel_id_t channel);
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef TIOS_SIM_DRIVER_RMT_H
+#define TIOS_SIM_DRIVER_RMT_H
+
+#include <stdint.h>
+
+// Host RMT driver: transmissions are accepted and dropped (the trace shows the pin value)
+typedef int esp_err_t;
+#ifndef ESP_OK
+#define ESP_OK 0
+#endif
+
+typedef int gpio_num_t;
+typedef enum { RMT_CHANNEL_0, RMT_CHANNEL_1, RMT_CHANNEL_2, RMT_CHANNEL_3 } rmt_channel_t;
+
+typedef struct {
+  uint32_t duration0 : 15;
+  uint32_t level0 : 1;
+  uint32_t duration1 : 15;
+  uint32_t level1 : 1;
+} rmt_item32_t;
+
+typedef struct {
+  bool loop_en;
+  bool idle_output_en;
+} rmt_tx_config_t;
+
+typedef struct {
+  rmt_channel_t channel;
+  gpio_num_t gpio_num;
+  uint8_t clk_div;
+  rmt_tx_config_t tx_config;
+} rmt_config_t;
+
+#define RMT_DEFAULT_CONFIG_TX(gpio, channel_id) { channel_id, gpio, 80, { false, true } }
+
+esp_err_t rmt_config(const rmt_config_t *config);
+esp_err_t rmt_driver_install(rmt_channel_t channel, size_t rxBufferSize, int flags);
+esp_err_t rmt_driver_uninstall(rmt_channel_t channel);
+esp_err_t rmt_write_items(rmt_channel_t channel, const rmt_item32_t *items, int count, bool wait);
+esp_err_t rmt_fill_tx_items(rmt_channel_t channel, const rmt_item32_t *items, uint16_t count, uint16_t offset);
+esp_err_t rmt_set_tx_loop_mode(rmt_channel_t channel, bool loop);
+esp_err_t rmt_set_tx_loop_count(rmt_channel_t channel, uint32_t count);
+esp_err_t rmt_enable_tx_loop_autostop(rmt_channel_t channel, bool enable);
+esp_err_t rmt_tx_stop(rmt_channel_t channel);
+
+#endif
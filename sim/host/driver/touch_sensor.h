@@ -0,0 +1,29 @@
+#ifndef TIOS_SIM_DRIVER_TOUCH_SENSOR_H
+#define TIOS_SIM_DRIVER_TOUCH_SENSOR_H
+
+#include <stdint.h>
+
+// Host touch sensor driver: the filter settings are accepted and ignored (the host touch
+// model in host.cpp always filters)
+typedef int esp_err_t;
+#ifndef ESP_OK
+#define ESP_OK 0
+#endif
+
+typedef enum { TOUCH_PAD_FILTER_IIR_4, TOUCH_PAD_FILTER_IIR_8, TOUCH_PAD_FILTER_IIR_16 } touch_filter_mode_t;
+typedef enum { TOUCH_PAD_SMOOTH_OFF, TOUCH_PAD_SMOOTH_IIR_2, TOUCH_PAD_SMOOTH_IIR_4 } touch_smooth_mode_t;
+
+typedef struct {
+  touch_filter_mode_t mode;
+  uint32_t debounce_cnt;
+  uint32_t noise_thr;
+  uint32_t noise_neg_thr;
+  uint32_t neg_noise_limit;
+  uint32_t jitter_step;
+  touch_smooth_mode_t smh_lvl;
+} touch_filter_config_t;
+
+esp_err_t touch_pad_filter_set_config(const touch_filter_config_t *config);
+esp_err_t touch_pad_filter_enable();
+
+#endif
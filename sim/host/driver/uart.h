@@ -0,0 +1,12 @@
+#ifndef TIOS_SIM_DRIVER_UART_H
+#define TIOS_SIM_DRIVER_UART_H
+
+typedef int uart_port_t;
+typedef int esp_err_t;
+
+#define UART_NUM_1 1
+
+inline esp_err_t uart_set_rx_full_threshold(uart_port_t port, int threshold) { return 0; }
+inline esp_err_t uart_set_rx_timeout(uart_port_t port, uint8_t symbols) { return 0; }
+
+#endif
@@ -0,0 +1,32 @@
+#ifndef TIOS_SIM_ESP_ADC_CAL_H
+#define TIOS_SIM_ESP_ADC_CAL_H
+
+#include "driver/adc.h"
+
+// Host ADC calibration: an ideal linear 0-3100 mV characteristic
+typedef struct {
+  adc_unit_t adc_num;
+  adc_atten_t atten;
+  adc_bits_width_t bit_width;
+} esp_adc_cal_characteristics_t;
+
+typedef enum {
+  ESP_ADC_CAL_VAL_EFUSE_VREF,
+  ESP_ADC_CAL_VAL_EFUSE_TP,
+  ESP_ADC_CAL_VAL_DEFAULT_VREF,
+  ESP_ADC_CAL_VAL_EFUSE_TP_FIT
+} esp_adc_cal_value_t;
+
+inline esp_adc_cal_value_t esp_adc_cal_characterize(adc_unit_t unit, adc_atten_t atten, adc_bits_width_t width,
+                                                    uint32_t vref, esp_adc_cal_characteristics_t *characteristics) {
+  characteristics->adc_num = unit;
+  characteristics->atten = atten;
+  characteristics->bit_width = width;
+  return ESP_ADC_CAL_VAL_DEFAULT_VREF;
+}
+
+inline uint32_t esp_adc_cal_raw_to_voltage(uint32_t raw, const esp_adc_cal_characteristics_t *characteristics) {
+  return raw * 3100 / 4095;
+}
+
+#endif
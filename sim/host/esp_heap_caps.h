@@ -0,0 +1,20 @@
+#ifndef TIOS_SIM_ESP_HEAP_CAPS_H
+#define TIOS_SIM_ESP_HEAP_CAPS_H
+
+#include <stdlib.h>
+#include <stdint.h>
+
+// Host heap: every capability is the host heap, no PSRAM
+#define MALLOC_CAP_8BIT (1 << 2)
+#define MALLOC_CAP_SPIRAM (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+
+inline void* heap_caps_malloc(size_t size, uint32_t caps) { return caps & MALLOC_CAP_SPIRAM ? nullptr : malloc(size); }
+inline void* heap_caps_calloc(size_t count, size_t size, uint32_t caps) { return caps & MALLOC_CAP_SPIRAM ? nullptr : calloc(count, size); }
+inline void heap_caps_free(void *pointer) { free(pointer); }
+inline size_t heap_caps_get_free_size(uint32_t caps) { return caps & MALLOC_CAP_SPIRAM ? 0 : 320 * 1024; }
+inline size_t heap_caps_get_total_size(uint32_t caps) { return caps & MALLOC_CAP_SPIRAM ? 0 : 400 * 1024; }
+inline size_t heap_caps_get_minimum_free_size(uint32_t caps) { return caps & MALLOC_CAP_SPIRAM ? 0 : 300 * 1024; }
+inline size_t heap_caps_get_largest_free_block(uint32_t caps) { return caps & MALLOC_CAP_SPIRAM ? 0 : 112 * 1024; }
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef TIOS_SIM_ESP_TIMER_H
+#define TIOS_SIM_ESP_TIMER_H
+
+#include <stdint.h>
+
+// Host esp_timer: the 64-bit virtual clock, periodic timers are accepted but never fire
+typedef int esp_err_t;
+typedef void* esp_timer_handle_t;
+typedef void (*esp_timer_cb_t)(void *arg);
+typedef enum { ESP_TIMER_TASK } esp_timer_dispatch_t;
+
+typedef struct {
+  esp_timer_cb_t callback;
+  void *arg;
+  esp_timer_dispatch_t dispatch_method;
+  const char *name;
+  bool skip_unhandled_events;
+} esp_timer_create_args_t;
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *handle);
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period);
+esp_err_t esp_timer_stop(esp_timer_handle_t timer);
+int64_t esp_timer_get_time();
+
+#endif
@@ -0,0 +1,562 @@
+/*************************************************************
+****************** HOST PLATFORM STAND-INS *******************
+**************************************************************/
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <Wire.h>
+#include <esp_timer.h>
+#include <driver/ledc.h>
+#include <driver/mcpwm.h>
+#include <driver/rmt.h>
+#include <driver/touch_sensor.h>
+#include <chrono>
+#include <deque>
+#include <string>
+#include "../sim.h"
+#include "touch.h"
+
+// Simulator state
+uint64_t simMicros = 0;
+byte simLevels[SIM_GPIOS];
+uint16_t simAnalog[SIM_GPIOS];
+uint32_t simTouch[SIM_GPIOS];
+uint32_t simPulsePeriod[SIM_GPIOS];
+uint32_t simPulseHigh[SIM_GPIOS];
+byte simOutputs[SIM_GPIOS];
+MockI2cBus simI2c;
+
+// Global objects of the Arduino core
+HardwareSerial Serial(nullptr); // silent unless the driver attaches a stream
+HardwareSerial Serial1(nullptr);
+EspClass ESP;
+EEPROMClass EEPROM;
+TwoWire Wire;
+
+
+/********************************* TIME *********************************/
+
+// unsigned long is 32 bits in the -m32 build, so these wrap like on the ESP32
+unsigned long millis() {
+  return (unsigned long)(simMicros / 1000);
+}
+
+unsigned long micros() {
+  return (unsigned long)simMicros;
+}
+
+void delay(unsigned long ms) {
+  simMicros += (uint64_t)ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us) {
+  simMicros += us;
+}
+
+int64_t esp_timer_get_time() {
+  return (int64_t)simMicros;
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t *args, esp_timer_handle_t *handle) {
+  *handle = nullptr;
+  return 0;
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period) {
+  return 0;
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+  return 0;
+}
+
+
+/*************************** GPIO, ADC & LEDC ***************************/
+
+void pinMode(uint8_t pin, uint8_t mode) {
+}
+
+int digitalRead(uint8_t pin) {
+  return pin < SIM_GPIOS ? simLevels[pin] : HIGH;
+}
+
+void digitalWrite(uint8_t pin, uint8_t value) {
+  if(pin < SIM_GPIOS) {
+    simOutputs[pin] = value != 0;
+  }
+}
+
+uint16_t analogRead(uint8_t pin) {
+  return pin < SIM_GPIOS ? simAnalog[pin] : 0;
+}
+
+void analogReadResolution(uint8_t bits) {
+}
+
+uint32_t getCpuFrequencyMhz() {
+  return 240;
+}
+
+void attachInterrupt(uint8_t pin, void (*handler)(void), int mode) {
+}
+
+uint32_t ledcSetup(uint8_t channel, uint32_t frequency, uint8_t resolution) {
+  return frequency;
+}
+
+void ledcAttachPin(uint8_t pin, uint8_t channel) {
+}
+
+void ledcDetachPin(uint8_t pin) {
+}
+
+static uint32_t ledcDuties[8];
+
+void ledcWrite(uint8_t channel, uint32_t duty) {
+  ledcDuties[channel & 7] = duty;
+}
+
+uint32_t ledcRead(uint8_t channel) {
+  return ledcDuties[channel & 7];
+}
+
+esp_err_t ledc_fade_func_install(int flags) {
+  return 0;
+}
+
+esp_err_t ledc_set_fade_with_time(ledc_mode_t mode, ledc_channel_t channel, uint32_t duty, int time) {
+  ledcDuties[channel & 7] = duty; // no fade time on the host
+  return 0;
+}
+
+esp_err_t ledc_fade_start(ledc_mode_t mode, ledc_channel_t channel, ledc_fade_mode_t wait) {
+  return 0;
+}
+
+esp_err_t rmt_config(const rmt_config_t *config) {
+  return ESP_OK;
+}
+
+esp_err_t rmt_driver_install(rmt_channel_t channel, size_t rxBufferSize, int flags) {
+  return ESP_OK;
+}
+
+esp_err_t rmt_driver_uninstall(rmt_channel_t channel) {
+  return ESP_OK;
+}
+
+esp_err_t rmt_write_items(rmt_channel_t channel, const rmt_item32_t *items, int count, bool wait) {
+  return ESP_OK;
+}
+
+esp_err_t rmt_fill_tx_items(rmt_channel_t channel, const rmt_item32_t *items, uint16_t count, uint16_t offset) {
+  return ESP_OK;
+}
+
+esp_err_t rmt_set_tx_loop_mode(rmt_channel_t channel, bool loop) {
+  return ESP_OK;
+}
+
+esp_err_t rmt_set_tx_loop_count(rmt_channel_t channel, uint32_t count) {
+  return ESP_OK;
+}
+
+esp_err_t rmt_enable_tx_loop_autostop(rmt_channel_t channel, bool enable) {
+  return ESP_OK;
+}
+
+esp_err_t rmt_tx_stop(rmt_channel_t channel) {
+  return ESP_OK;
+}
+
+
+/******************************** TOUCH *********************************/
+
+// Attached pads run the same threshold model as the S3 touch FSM (touch.h)
+struct HostPad {
+  void (*handler)(void*);
+  void *arg;
+  uint32_t threshold;
+  TouchModel model;
+};
+
+static HostPad touchPads[SIM_GPIOS];
+
+touch_value_t touchRead(uint8_t pin) {
+  return pin < SIM_GPIOS ? simTouch[pin] : 0;
+}
+
+void touchAttachInterruptArg(uint8_t pin, void (*handler)(void*), void *arg, touch_value_t threshold) {
+  if(pin < SIM_GPIOS) {
+    touchPads[pin].handler = handler;
+    touchPads[pin].arg = arg;
+    touchPads[pin].threshold = threshold;
+    touchModelReset(touchPads[pin].model);
+    touchModelUpdate(touchPads[pin].model, simTouch[pin], threshold); // first reading is the baseline
+  }
+}
+
+void touchDetachInterrupt(uint8_t pin) {
+  if(pin < SIM_GPIOS) {
+    touchPads[pin].handler = nullptr;
+  }
+}
+
+bool touchInterruptGetLastStatus(uint8_t pin) {
+  return pin < SIM_GPIOS && touchPads[pin].model.touched;
+}
+
+esp_err_t touch_pad_filter_set_config(const touch_filter_config_t *config) {
+  return ESP_OK;
+}
+
+esp_err_t touch_pad_filter_enable() {
+  return ESP_OK;
+}
+
+// Function to measure every attached pad once and raise the interrupts (once per step)
+void simTouchStep() {
+  for(int pin=0; pin<SIM_GPIOS; pin++) {
+    HostPad &pad = touchPads[pin];
+
+    if(pad.handler != nullptr && touchModelUpdate(pad.model, simTouch[pin], pad.threshold)) {
+      pad.handler(pad.arg);
+    }
+  }
+}
+
+
+/******************************** MCPWM *********************************/
+
+// Capture channels of both units, with the GPIO routed to them by mcpwm_gpio_init()
+struct HostCapture {
+  int gpio;
+  cap_isr_cb_t callback;
+  void *arg;
+};
+
+static HostCapture captures[2][3] = {{{-1}, {-1}, {-1}}, {{-1}, {-1}, {-1}}};
+
+// Pulse train per GPIO, as it runs now
+struct HostPulse {
+  uint32_t period;
+  uint32_t high;
+  uint64_t nextRise; // time of the next rising edge
+  bool falling;      // falling edge of the current cycle still to come
+};
+
+static HostPulse pulses[SIM_GPIOS];
+
+esp_err_t mcpwm_gpio_init(mcpwm_unit_t unit, mcpwm_io_signals_t signal, int gpio) {
+  captures[unit][signal - MCPWM_CAP_0].gpio = gpio;
+  return ESP_OK;
+}
+
+esp_err_t mcpwm_capture_enable_channel(mcpwm_unit_t unit, mcpwm_capture_channel_id_t channel, const mcpwm_capture_config_t *config) {
+  captures[unit][channel].callback = config->capture_cb;
+  captures[unit][channel].arg = config->user_data;
+  return ESP_OK;
+}
+
+esp_err_t mcpwm_capture_disable_channel(mcpwm_unit_t unit, mcpwm_capture_channel_id_t channel) {
+  captures[unit][channel].callback = nullptr;
+  return ESP_OK;
+}
+
+// Function to raise the capture interrupts of an edge (timestamp on the 80 MHz capture clock)
+static void captureEdge(int gpio, uint64_t time, bool rising) {
+  cap_event_data_t edge = {rising ? MCPWM_POS_EDGE : MCPWM_NEG_EDGE, (uint32_t)(time * 80)};
+  simLevels[gpio] = rising;
+
+  for(int u=0; u<2; u++) {
+    for(int c=0; c<3; c++) {
+      if(captures[u][c].callback != nullptr && captures[u][c].gpio == gpio) {
+        captures[u][c].callback((mcpwm_unit_t)u, (mcpwm_capture_channel_id_t)c, &edge, captures[u][c].arg);
+      }
+    }
+  }
+}
+
+// Function to generate the edges of the pulse trains up to now (once per step)
+void simCaptureStep() {
+  for(int gpio=0; gpio<SIM_GPIOS; gpio++) {
+    HostPulse &pulse = pulses[gpio];
+
+    if(simPulsePeriod[gpio] != pulse.period || simPulseHigh[gpio] != pulse.high) { // new waveform from now
+      pulse.period = simPulsePeriod[gpio];
+      pulse.high = simPulseHigh[gpio];
+      pulse.nextRise = simMicros;
+      pulse.falling = false;
+
+      if(pulse.period != 0 && (pulse.high == 0 || pulse.high >= pulse.period)) {
+        simLevels[gpio] = pulse.high != 0; // 0% or 100% duty
+      }
+    }
+
+    if(pulse.period == 0 || pulse.high == 0 || pulse.high >= pulse.period) { // stopped or steady
+      continue;
+    }
+
+    if(simMicros > pulse.nextRise + 4 * (uint64_t)pulse.period) { // long step - the last cycles are enough
+      pulse.nextRise += ((simMicros - pulse.nextRise) / pulse.period - 2) * pulse.period;
+      pulse.falling = false;
+    }
+
+    while(true) {
+      uint64_t edge = pulse.falling ? pulse.nextRise - pulse.period + pulse.high : pulse.nextRise;
+
+      if(edge > simMicros) {
+        break;
+      }
+
+      captureEdge(gpio, edge, !pulse.falling);
+
+      if(!pulse.falling) {
+        pulse.nextRise += pulse.period;
+      }
+
+      pulse.falling = !pulse.falling;
+    }
+  }
+}
+
+bool psramFound() {
+  return false;
+}
+
+uint32_t EspClass::getFreeHeap() {
+  return 200 * 1024;
+}
+
+// Wall-clock time of the host in 240 MHz cycles (benchmarks only, not the virtual clock)
+uint32_t EspClass::getCycleCount() {
+  auto now = std::chrono::steady_clock::now().time_since_epoch();
+  return (uint32_t)(std::chrono::duration_cast<std::chrono::nanoseconds>(now).count() * 240 / 1000);
+}
+
+
+/******************************** PRINT *********************************/
+
+size_t Print::write(const uint8_t *buffer, size_t length) {
+  size_t written = 0;
+
+  while(written < length && write(buffer[written])) {
+    written++;
+  }
+
+  return written;
+}
+
+size_t Print::printf(const char *pattern, ...) {
+  char buffer[256];
+  va_list args;
+  va_start(args, pattern);
+  int length = vsnprintf(buffer, sizeof(buffer), pattern, args);
+  va_end(args);
+
+  return write((const uint8_t*)buffer, min(length, (int)sizeof(buffer) - 1));
+}
+
+
+/********************************* I2C **********************************/
+
+void TwoWire::beginTransmission(uint16_t address) {
+  this->address = address;
+  transmitLength = 0;
+}
+
+// A transmission without a stop is the register pointer of the next requestFrom()
+uint8_t TwoWire::endTransmission(bool sendStop) {
+  if(!sendStop) {
+    memcpy(pointer, transmit, transmitLength);
+    pointerLength = transmitLength;
+    return simI2c.acknowledges(address) ? 0 : 2; // 2 = address NACK
+  }
+
+  return simI2c.write(address, transmit, transmitLength) ? 0 : 2;
+}
+
+size_t TwoWire::requestFrom(uint16_t address, size_t size, bool sendStop) {
+  size = min(size, BUFFER);
+  bool ok = simI2c.read(address, pointer, pointerLength, receive, size);
+  pointerLength = 0;
+  receiveLength = ok ? size : 0;
+  receiveRead = 0;
+  return receiveLength;
+}
+
+size_t TwoWire::write(uint8_t value) {
+  return write(&value, 1);
+}
+
+size_t TwoWire::write(const uint8_t *buffer, size_t length) {
+  length = min(length, BUFFER - transmitLength);
+  memcpy(&transmit[transmitLength], buffer, length);
+  transmitLength += length;
+  return length;
+}
+
+size_t TwoWire::readBytes(uint8_t *buffer, size_t length) {
+  size_t count = 0;
+
+  while(count < length && receiveRead < receiveLength) {
+    buffer[count++] = receive[receiveRead++];
+  }
+
+  return count;
+}
+
+
+/******************************** EEPROM ********************************/
+
+bool EEPROMClass::begin(size_t bytes) {
+  if(image == nullptr) { // erased flash until the driver loads an image
+    image = (uint8_t*)malloc(bytes);
+    memset(image, 0xFF, bytes);
+    size = bytes;
+  }
+
+  return true;
+}
+
+uint8_t EEPROMClass::read(int address) {
+  return address < (int)size ? image[address] : 0xFF;
+}
+
+void EEPROMClass::write(int address, uint8_t value) {
+  if(address < (int)size) {
+    image[address] = value;
+  }
+}
+
+float EEPROMClass::readFloat(int address) {
+  float value = 0;
+
+  if(address + sizeof(value) <= size) {
+    memcpy(&value, &image[address], sizeof(value));
+  }
+
+  return value;
+}
+
+size_t EEPROMClass::writeFloat(int address, float value) {
+  if(address + sizeof(value) > size) {
+    return 0;
+  }
+
+  memcpy(&image[address], &value, sizeof(value));
+  return sizeof(value);
+}
+
+bool EEPROMClass::commit() {
+  return true;
+}
+
+uint8_t* EEPROMClass::data() {
+  return image;
+}
+
+size_t EEPROMClass::length() {
+  return size;
+}
+
+
+/******************************* FREERTOS *******************************/
+
+struct HostQueue {
+  size_t itemSize;
+  size_t capacity;
+  std::deque<std::string> items;
+};
+
+static int taskHandle;  // address used as the handle of every task
+static int mutexHandle; // same for mutexes
+
+BaseType_t xTaskCreatePinnedToCore(void (*task)(void*), const char *name, uint32_t stack, void *parameter,
+                                   UBaseType_t priority, TaskHandle_t *handle, BaseType_t core) {
+  if(handle != nullptr) {
+    *handle = &taskHandle; // never started - the driver calls the work directly
+  }
+
+  return pdPASS;
+}
+
+void vTaskDelay(TickType_t ticks) {
+  delay(ticks);
+}
+
+TaskHandle_t xTaskGetHandle(const char *name) {
+  return nullptr; // no task has a stack of its own on the host
+}
+
+UBaseType_t uxTaskGetStackHighWaterMark(TaskHandle_t task) {
+  return 0;
+}
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *woken) {
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clear, TickType_t ticks) {
+  return 0;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex() {
+  return &mutexHandle;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t mutex, TickType_t ticks) {
+  return pdTRUE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t mutex) {
+  return pdTRUE;
+}
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t itemSize) {
+  HostQueue *queue = new HostQueue;
+  queue->itemSize = itemSize;
+  queue->capacity = length;
+  return queue;
+}
+
+BaseType_t xQueueSend(QueueHandle_t handle, const void *item, TickType_t ticks) {
+  HostQueue *queue = (HostQueue*)handle;
+
+  if(queue->items.size() >= queue->capacity) {
+    return pdFALSE;
+  }
+
+  queue->items.push_back(std::string((const char*)item, queue->itemSize));
+  return pdTRUE;
+}
+
+BaseType_t xQueueSendFromISR(QueueHandle_t handle, const void *item, BaseType_t *woken) {
+  return xQueueSend(handle, item, 0);
+}
+
+BaseType_t xQueueReceive(QueueHandle_t handle, void *item, TickType_t ticks) {
+  HostQueue *queue = (HostQueue*)handle;
+
+  if(queue->items.empty()) {
+    return pdFALSE; // nothing else runs while we wait, so waiting cannot help
+  }
+
+  memcpy(item, queue->items.front().data(), queue->itemSize);
+  queue->items.pop_front();
+  return pdTRUE;
+}
+
+BaseType_t xQueuePeek(QueueHandle_t handle, void *item, TickType_t ticks) {
+  HostQueue *queue = (HostQueue*)handle;
+
+  if(queue->items.empty()) {
+    return pdFALSE;
+  }
+
+  memcpy(item, queue->items.front().data(), queue->itemSize);
+  return pdTRUE;
+}
@@ -0,0 +1,8 @@
+#ifndef TIOS_SIM_SOC_MEMORY_LAYOUT_H
+#define TIOS_SIM_SOC_MEMORY_LAYOUT_H
+
+// Host memory map: everything is internal RAM
+inline bool esp_ptr_external_ram(const void *pointer) { return false; }
+inline bool esp_ptr_internal(const void *pointer) { return true; }
+
+#endif
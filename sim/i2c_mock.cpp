@@ -0,0 +1,156 @@
+/*************************************************************
+*********************** SIMULATED I2C BUS ********************
+**************************************************************/
+
+#include "i2c_mock.h"
+
+// MCP23017 registers (BANK = 0, port A/B pairs)
+#define MCP_IODIR 0x00
+#define MCP_GPPU 0x0C
+#define MCP_GPIO 0x12
+#define MCP_OLAT 0x14
+#define MCP_REGISTERS 0x16
+
+// Function to add a simulated expander (false if the bus is full or the address is used)
+bool MockI2cBus::addDevice(uint8_t address, MockChip chip) {
+  if(find(address) != nullptr) {
+    return false;
+  }
+
+  for(int i=0; i<MOCK_I2C_DEVICES; i++) {
+    Device &device = devices[i];
+
+    if(!device.used) {
+      device = Device();
+      device.used = true;
+      device.address = address;
+      device.chip = chip;
+      device.registers[MCP_IODIR] = 0xFF; // power-on: all inputs
+      device.registers[MCP_IODIR+1] = 0xFF;
+      device.latch = 0xFFFF;
+      device.inputs = 0xFFFF;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Function to check if a device answers at an address
+bool MockI2cBus::acknowledges(uint8_t address) {
+  return find(address) != nullptr;
+}
+
+// Function to drive the pins of a device from outside
+void MockI2cBus::setInputs(uint8_t address, uint16_t inputs) {
+  Device *device = find(address);
+
+  if(device != nullptr) {
+    device->inputs = inputs;
+  }
+}
+
+// Function to get the pin levels of a device
+uint16_t MockI2cBus::levels(uint8_t address) {
+  Device *device = find(address);
+
+  if(device == nullptr) {
+    return 0xFFFF;
+  }
+
+  if(device->chip == MOCK_PCF8575) {
+    return device->latch & device->inputs; // quasi-bidirectional: low wins
+  }
+
+  uint16_t direction = device->registers[MCP_IODIR] | device->registers[MCP_IODIR+1] << 8; // 1 = input
+  uint16_t latch = device->registers[MCP_OLAT] | device->registers[MCP_OLAT+1] << 8;
+  return (latch & ~direction) | (device->inputs & direction);
+}
+
+// Function to find a device by address
+MockI2cBus::Device *MockI2cBus::find(uint8_t address) {
+  for(int i=0; i<MOCK_I2C_DEVICES; i++) {
+    if(devices[i].used && devices[i].address == address) {
+      return &devices[i];
+    }
+  }
+
+  return nullptr;
+}
+
+// Function to read one MCP23017 register
+uint8_t MockI2cBus::readRegister(Device &device, uint8_t reg) {
+  if(reg == MCP_GPIO || reg == MCP_GPIO+1) {
+    uint16_t pins = levels(device.address);
+    return reg == MCP_GPIO ? pins & 0xFF : pins >> 8;
+  }
+
+  return device.registers[reg];
+}
+
+// Function to simulate a write transaction
+bool MockI2cBus::write(uint8_t address, const uint8_t *data, size_t length) {
+  Device *device = find(address);
+  transactions++;
+
+  if(device == nullptr) {
+    return false;
+  }
+
+  if(device->chip == MOCK_PCF8575) {
+    if(length >= 2) {
+      device->latch = data[length-2] | data[length-1] << 8; // last pair wins
+    }
+
+    return true;
+  }
+
+  // MCP23017: first byte is the register pointer, then sequential registers
+  if(length >= 1) {
+    device->pointer = data[0] % MCP_REGISTERS;
+  }
+
+  for(size_t i=1; i<length; i++) {
+    uint8_t reg = device->pointer;
+
+    if(reg == MCP_GPIO || reg == MCP_GPIO+1) {
+      reg += MCP_OLAT - MCP_GPIO; // writing GPIO writes the latch
+    }
+
+    device->registers[reg] = data[i];
+    device->pointer = (device->pointer + 1) % MCP_REGISTERS;
+  }
+
+  return true;
+}
+
+// Function to simulate a read transaction
+bool MockI2cBus::read(uint8_t address, const uint8_t *pointer, size_t pointerLength, uint8_t *buffer, size_t length) {
+  Device *device = find(address);
+  transactions++;
+
+  if(device == nullptr) {
+    return false;
+  }
+
+  if(device->chip == MOCK_PCF8575) {
+    uint16_t pins = levels(address);
+
+    for(size_t i=0; i<length; i++) {
+      buffer[i] = i % 2 == 0 ? pins & 0xFF : pins >> 8;
+    }
+
+    return true;
+  }
+
+  if(pointerLength > 0) {
+    device->pointer = pointer[0] % MCP_REGISTERS;
+  }
+
+  for(size_t i=0; i<length; i++) {
+    buffer[i] = readRegister(*device, device->pointer);
+    device->pointer = (device->pointer + 1) % MCP_REGISTERS;
+  }
+
+  return true;
+}
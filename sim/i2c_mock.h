@@ -0,0 +1,52 @@
+#ifndef TIOS_I2C_MOCK_H
+#define TIOS_I2C_MOCK_H
+
+#include "i2c_bus.h"
+
+/*
+Simulated I2C bus of the host simulator (no Arduino dependencies):
+ - Holds up to MOCK_I2C_DEVICES MCP23017 or PCF8575 expanders with their registers
+ - The host Wire (sim/host/Wire.h) hands its transactions to simI2c, so the firmware's
+   WireBus and expander driver run unchanged against these chips
+ - setInputs() drives the pins from outside (1 = high or open), levels() returns what
+   the pins show, transactions counts bus transactions for cost checks
+ - A write or read to an address without a device is not acknowledged
+*/
+
+#define MOCK_I2C_DEVICES 4
+
+enum MockChip {
+  MOCK_MCP23017,
+  MOCK_PCF8575
+};
+
+class MockI2cBus : public I2cBus {
+ public:
+  unsigned long transactions = 0;
+
+  bool addDevice(uint8_t address, MockChip chip);
+  bool acknowledges(uint8_t address);
+  void setInputs(uint8_t address, uint16_t inputs);
+  uint16_t levels(uint8_t address);
+
+  bool write(uint8_t address, const uint8_t *data, size_t length) override;
+  bool read(uint8_t address, const uint8_t *pointer, size_t pointerLength, uint8_t *buffer, size_t length) override;
+
+ private:
+  struct Device {
+    bool used;
+    uint8_t address;
+    MockChip chip;
+    uint8_t registers[0x16]; // MCP23017 register file (BANK = 0)
+    uint8_t pointer;         // MCP23017 register pointer
+    uint16_t latch;          // PCF8575 output latch (1 = weak high)
+    uint16_t inputs;         // external drive (1 = high or open)
+  };
+
+  Device devices[MOCK_I2C_DEVICES] = {};
+
+  Device *find(uint8_t address);
+  uint8_t readRegister(Device &device, uint8_t reg);
+};
+
+#endif
@@ -0,0 +1,93 @@
+# Screen mirroring test: decodes the recorded stream sim/tests/mirror.bin with tools/mirror.py
+# and checks each frame against sim/tests/mirror.sums (CRC-32 of the RGB pixels)
+#
+#   python sim/mirror_test.py                 # the committed recording
+#   python sim/mirror_test.py --program .pio/build/sim/program   # also a fresh recording
+#   python sim/mirror_test.py --program ... --update             # re-record, rewrite the sums
+#
+# The text around the frames (boot messages, the report of "mirror off") must not show up
+# while the stream runs: the test fails on text between the first and the last frame.
+
+import argparse
+import os
+import subprocess
+import sys
+import tempfile
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+TESTS = os.path.join(HERE, "tests")
+MIRROR = os.path.join(HERE, "..", "tools", "mirror.py")
+
+
+def record(program, stream):
+    """Runs sim/tests/mirror.txt with the serial output recorded into stream."""
+    subprocess.run([program, "-q", "-f", "200ms", "-o", stream, "mirror.txt"], cwd=TESTS, check=True,
+                   stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+
+
+def decode(stream):
+    """Decodes a stream, returns (frame checksum lines, text passed through)."""
+    with tempfile.TemporaryDirectory() as out_dir:
+        sums = os.path.join(out_dir, "sums.txt")
+        result = subprocess.run([sys.executable, MIRROR, "--sums", sums, stream, out_dir], check=True,
+                                stdout=subprocess.PIPE, stderr=subprocess.DEVNULL, text=True)
+
+        with open(sums) as file:
+            return file.read(), result.stdout
+
+
+def check(name, stream, expected):
+    sums, text = decode(stream)
+    problems = []
+
+    if sums != expected:
+        problems.append("frames differ from mirror.sums:\n" + sums)
+
+    # Text between the frames: only the boot messages before and the report after
+    inside = text[text.find("Boot:"):text.rfind("Mirror:")]
+
+    if inside.count("\n") > 1:
+        problems.append("text inside the stream:\n" + inside)
+
+    print("%-20s %s" % (name, "pass" if not problems else "FAIL"))
+
+    for problem in problems:
+        print(problem)
+
+    return not problems
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Screen mirroring stream test")
+    parser.add_argument("--program", help="simulator, to check a fresh recording as well")
+    parser.add_argument("--update", action="store_true", help="re-record mirror.bin and rewrite mirror.sums")
+    options = parser.parse_args()
+
+    stream = os.path.join(TESTS, "mirror.bin")
+    sums_path = os.path.join(TESTS, "mirror.sums")
+
+    if options.update:
+        if options.program is None:
+            parser.error("--update needs --program")
+
+        record(os.path.abspath(options.program), stream)
+
+        with open(sums_path, "w") as file:
+            file.write(decode(stream)[0])
+
+    with open(sums_path) as file:
+        expected = file.read()
+
+    passed = check("recorded stream", stream, expected)
+
+    if options.program is not None:
+        with tempfile.TemporaryDirectory() as directory:
+            fresh = os.path.join(directory, "mirror.bin")
+            record(os.path.abspath(options.program), fresh)
+            passed &= check("fresh recording", fresh, expected)
+
+    sys.exit(0 if passed else 1)
+
+
+if __name__ == "__main__":
+    main()
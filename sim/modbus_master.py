@@ -0,0 +1,252 @@
+# Scripted Modbus RTU master: checks the slave (src/modbus.cpp, src/modbus_slave.cpp) end to end
+#
+# Against the simulator (starts it with -m and sim/modbus_slave.txt, no extra packages needed):
+#   pio run -e sim_modbus && python sim/modbus_master.py
+# Against a unit configured as in sim/modbus_slave.txt:
+#   python sim/modbus_master.py --port /dev/ttyUSB0
+#
+# Covers functions 01-06, 15 and 16, the largest reads of each table at 115200 baud (the
+# default, t3.5 = 1.75 ms), the exception responses, broadcasts (writes applied, never
+# answered - not even with an exception) and frames that must be ignored (other slave,
+# bad CRC, oversized). Exit code 1 when a check fails.
+
+import argparse
+import os
+import select
+import struct
+import subprocess
+import sys
+import tempfile
+import termios
+import time
+import tty
+
+SLAVE = 1
+BROADCAST = 0
+SCAN_WAIT = 0.1  # writes are applied by the next scan
+TIMEOUT = 0.5
+
+# Signal indexes (pins[] in src/main.cpp) of the pins in sim/modbus_slave.txt
+GPIO1, GPIO12, GPIO13, GPIO18 = 13, 18, 19, 4
+
+ILLEGAL_FUNCTION = 1
+ILLEGAL_ADDRESS = 2
+ILLEGAL_VALUE = 3
+
+
+def crc16(data):
+    crc = 0xFFFF
+
+    for byte in data:
+        crc ^= byte
+
+        for _ in range(8):
+            crc = (crc >> 1) ^ 0xA001 if crc & 1 else crc >> 1
+
+    return crc
+
+
+def frame(body):
+    return body + struct.pack("<H", crc16(body))
+
+
+class Link:
+    """Raw serial port (pty of the simulator or a USB adapter)."""
+
+    def __init__(self, path, baud):
+        self.fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+        tty.setraw(self.fd)
+        attributes = termios.tcgetattr(self.fd)
+        speed = getattr(termios, "B%d" % baud)
+        attributes[4] = attributes[5] = speed
+        termios.tcsetattr(self.fd, termios.TCSANOW, attributes)
+        self.gap = 0.00175 if baud > 19200 else 11 / baud * 3.5
+
+    def request(self, data):
+        """Sends one frame, returns the response (None if nothing came)."""
+        termios.tcflush(self.fd, termios.TCIFLUSH)
+        os.write(self.fd, data)
+        response = b""
+        deadline = time.time() + TIMEOUT
+
+        while time.time() < deadline:
+            ready, _, _ = select.select([self.fd], [], [], self.gap * 4 if response else deadline - time.time())
+
+            if not ready:
+                if response:
+                    break  # t3.5 silence after the response
+                continue
+
+            response += os.read(self.fd, 512)
+
+        return response or None
+
+
+class Master:
+    def __init__(self, link):
+        self.link = link
+        self.failures = 0
+        self.checks = 0
+
+    def check(self, name, passed, detail=""):
+        self.checks += 1
+
+        if not passed:
+            self.failures += 1
+
+        print("%-44s %s %s" % (name, "pass" if passed else "FAIL", detail if not passed else ""))
+
+    def call(self, slave, function, payload):
+        """Sends a request, returns (function, data) of a valid response or None."""
+        response = self.link.request(frame(struct.pack("BB", slave, function) + payload))
+
+        if response is None:
+            return None
+
+        if len(response) < 5 or crc16(response[:-2]) != struct.unpack("<H", response[-2:])[0] or response[0] != slave:
+            return ("bad", response)
+
+        return (response[1], response[2:-2])
+
+    def read_bits(self, function, start, count):
+        result = self.call(SLAVE, function, struct.pack(">HH", start, count))
+
+        if result is None or result[0] != function or result[1][0] != (count + 7) // 8:
+            return None
+
+        data = result[1][1:]
+        return [(data[i // 8] >> (i % 8)) & 1 for i in range(count)]
+
+    def read_registers(self, function, start, count):
+        result = self.call(SLAVE, function, struct.pack(">HH", start, count))
+
+        if result is None or result[0] != function or result[1][0] != count * 2:
+            return None
+
+        return list(struct.unpack(">%dH" % count, result[1][1:]))
+
+    def write(self, slave, function, payload):
+        result = self.call(slave, function, payload)
+        time.sleep(SCAN_WAIT)
+        return result
+
+    def expect_exception(self, name, function, payload, code):
+        result = self.call(SLAVE, function, payload)
+        self.check(name, result == (function | 0x80, bytes([code])), repr(result))
+
+    def expect_silence(self, name, data):
+        response = self.link.request(data)
+        time.sleep(SCAN_WAIT)
+        self.check(name, response is None, repr(response))
+
+
+def run(master):
+    # Function 03 and 16: timer base values and multipliers
+    holding = master.read_registers(0x03, 0, 12)
+    master.check("03 read timer registers", holding is not None and holding[0:2] == [100, 100] and holding[4] == 10, repr(holding))
+
+    result = master.write(SLAVE, 0x10, struct.pack(">HHB4H", 0, 4, 8, 20, 30, 40, 50))
+    master.check("16 write 4 registers (echo)", result == (0x10, struct.pack(">HH", 0, 4)), repr(result))
+    holding = master.read_registers(0x03, 0, 4)
+    master.check("16 registers applied", holding == [20, 30, 40, 50], repr(holding))
+
+    # Function 06: single register, and a new pin type clears the pin source
+    result = master.write(SLAVE, 0x06, struct.pack(">HH", 1, 60))
+    master.check("06 write register (echo)", result == (0x06, struct.pack(">HH", 1, 60)), repr(result))
+    master.check("06 register applied", master.read_registers(0x03, 1, 1) == [60])
+
+    master.write(SLAVE, 0x06, struct.pack(">HH", 48 + GPIO12, 19))
+    master.check("06 pin source applied", master.read_registers(0x03, 48 + GPIO12, 1) == [19])
+    master.write(SLAVE, 0x06, struct.pack(">HH", 16 + GPIO12, 5))
+    registers = [master.read_registers(0x03, 16 + GPIO12, 1), master.read_registers(0x03, 48 + GPIO12, 1)]
+    master.check("06 new pin type clears the source", registers == [[5], [100]], repr(registers))
+
+    # Function 05 and 15: coils of OUT pins
+    result = master.write(SLAVE, 0x05, struct.pack(">HH", GPIO13, 0xFF00))
+    master.check("05 write coil (echo)", result == (0x05, struct.pack(">HH", GPIO13, 0xFF00)), repr(result))
+    coils = master.read_bits(0x01, 0, 68)
+    master.check("01 read 68 coils, coil set", coils is not None and coils[GPIO13] == 1, repr(coils))
+
+    master.write(SLAVE, 0x06, struct.pack(">HH", 16 + GPIO12, 3))  # back to OUT
+    result = master.write(SLAVE, 0x0F, struct.pack(">HHBB", GPIO12, 2, 1, 0b01))
+    master.check("15 write 2 coils (echo)", result == (0x0F, struct.pack(">HH", GPIO12, 2)), repr(result))
+    coils = master.read_bits(0x01, GPIO12, 2)
+    master.check("15 coils applied", coils == [1, 0], repr(coils))
+
+    # Function 02 and 04: discrete inputs and input registers, largest reads
+    discretes = master.read_bits(0x02, 0, 68)
+    master.check("02 read 68 discrete inputs", discretes is not None and discretes[GPIO18] == 0 and discretes[GPIO12] == 1, repr(discretes))
+
+    inputs = master.read_registers(0x04, 0, 68)
+    master.check("04 read 68 input registers", inputs is not None and inputs[32 + GPIO1] > 0 and inputs[GPIO12] == 1, repr(inputs))
+
+    holding = master.read_registers(0x03, 0, 101)
+    master.check("03 read 101 holding registers", holding is not None and holding[16 + GPIO13] == 3, repr(holding))
+
+    # Exceptions
+    master.expect_exception("07 unsupported function", 0x07, struct.pack(">HH", 0, 1), ILLEGAL_FUNCTION)
+    master.expect_exception("03 past the table", 0x03, struct.pack(">HH", 100, 2), ILLEGAL_ADDRESS)
+    master.expect_exception("04 count over 125", 0x04, struct.pack(">HH", 0, 126), ILLEGAL_VALUE)
+    master.expect_exception("01 count 0", 0x01, struct.pack(">HH", 0, 0), ILLEGAL_VALUE)
+    master.expect_exception("05 coil value not FF00/0000", 0x05, struct.pack(">HH", GPIO13, 0x1234), ILLEGAL_VALUE)
+    master.expect_exception("05 coil of an ANA pin", 0x05, struct.pack(">HH", GPIO1, 0xFF00), ILLEGAL_ADDRESS)
+    master.expect_exception("06 invalid pin type", 0x06, struct.pack(">HH", 16 + GPIO13, 6), ILLEGAL_VALUE)
+    master.expect_exception("06 OUT source out of range", 0x06, struct.pack(">HH", 48 + GPIO13, 255), ILLEGAL_VALUE)
+    master.expect_exception("06 OUT source an analog pin", 0x06, struct.pack(">HH", 48 + GPIO13, 100 + GPIO1), ILLEGAL_VALUE)
+    master.expect_exception("16 byte count mismatch", 0x10, struct.pack(">HHB2H", 0, 2, 3, 1, 2), ILLEGAL_VALUE)
+
+    # Broadcasts: writes are applied, nothing is ever answered
+    master.expect_silence("broadcast 06 write, no response", frame(struct.pack(">BBHH", BROADCAST, 0x06, 2, 77)))
+    master.check("broadcast 06 write applied", master.read_registers(0x03, 2, 1) == [77])
+    master.expect_silence("broadcast 16 write, no response", frame(struct.pack(">BBHHB2H", BROADCAST, 0x10, 2, 2, 4, 11, 12)))
+    master.check("broadcast 16 write applied", master.read_registers(0x03, 2, 2) == [11, 12])
+    master.expect_silence("broadcast 03 read, no response", frame(struct.pack(">BBHH", BROADCAST, 0x03, 0, 4)))
+    master.expect_silence("broadcast 03 bad count, no exception", frame(struct.pack(">BBHH", BROADCAST, 0x03, 0, 0)))
+    master.expect_silence("broadcast 01 bad address, no exception", frame(struct.pack(">BBHH", BROADCAST, 0x01, 60, 10)))
+    master.expect_silence("broadcast 06 bad value, no exception", frame(struct.pack(">BBHH", BROADCAST, 0x06, 16 + GPIO13, 6)))
+
+    # Frames to ignore
+    master.expect_silence("other slave address", frame(struct.pack(">BBHH", 2, 0x03, 0, 1)))
+    bad = bytearray(frame(struct.pack(">BBHH", SLAVE, 0x03, 0, 1)))
+    bad[-1] ^= 0xFF
+    master.expect_silence("bad CRC", bytes(bad))
+    master.expect_silence("oversized frame (300 bytes)", frame(struct.pack("BB", SLAVE, 0x10) + bytes(296)))
+    master.check("answers again after ignored frames", master.read_registers(0x03, 0, 1) == [20])
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Scripted Modbus RTU master")
+    parser.add_argument("--program", default=".pio/build/sim_modbus/program", help="simulator built with MODBUS_ENABLE")
+    parser.add_argument("--port", help="serial port of a unit (the simulator is not started)")
+    parser.add_argument("--baud", type=int, default=115200)
+    options = parser.parse_args()
+
+    simulator = None
+    port = options.port
+
+    if port is None:
+        here = os.path.dirname(os.path.abspath(__file__))
+        port = os.path.join(tempfile.mkdtemp(), "ttyMODBUS")
+        simulator = subprocess.Popen([os.path.abspath(options.program), "-q", "-m", port, os.path.join(here, "modbus_slave.txt")])
+
+        for _ in range(50):
+            if os.path.exists(port):
+                break
+            time.sleep(0.1)
+
+        time.sleep(0.2)  # setup() and the first scans
+
+    try:
+        master = Master(Link(port, options.baud))
+        run(master)
+    finally:
+        if simulator is not None:
+            simulator.terminate()
+            simulator.wait()
+
+    print("%d of %d checks failed" % (master.failures, master.checks) if master.failures else "%d checks passed" % master.checks)
+    sys.exit(1 if master.failures else 0)
+
+
+if __name__ == "__main__":
+    main()
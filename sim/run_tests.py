@@ -0,0 +1,77 @@
+# Simulator regression scripts: runs sim/tests/*.txt and checks the results
+#
+#   python sim/run_tests.py [--program .pio/build/sim/program] [--update] [name ...]
+#
+# A script's options are on a "# args:" line at its top (e.g. "# args: -t 49d"). A run
+# passes when its exit code is 0 (no failed expect or uptime line) and, if the script
+# has a <name>.out next to it, the trace on stdout is that file. --update writes the
+# .out files of the scripts that have one from the current runs.
+
+import argparse
+import os
+import subprocess
+import sys
+import time
+
+TESTS = os.path.join(os.path.dirname(os.path.abspath(__file__)), "tests")
+
+
+def script_args(path):
+    """Options from the "# args:" line of a script."""
+    with open(path) as script:
+        for line in script:
+            if line.startswith("# args:"):
+                return line[len("# args:"):].split()
+
+    return []
+
+
+def run(program, name, update):
+    """Runs one script, returns True when it passes."""
+    path = os.path.join(TESTS, name + ".txt")
+    expected = os.path.join(TESTS, name + ".out")
+    start = time.time()
+    result = subprocess.run([program] + script_args(path) + [name + ".txt"], cwd=TESTS,
+                            stdout=subprocess.PIPE, stderr=subprocess.PIPE, text=True)
+    passed = result.returncode == 0
+    note = "" if passed else "exit code %d" % result.returncode
+
+    if os.path.exists(expected):
+        if update:
+            with open(expected, "w") as out:
+                out.write(result.stdout)
+        else:
+            with open(expected) as out:
+                if out.read() != result.stdout:
+                    passed = False
+                    note = (note + ", " if note else "") + "trace differs from %s.out" % name
+
+    print("%-14s %s  %5.1f s  %s" % (name, "pass" if passed else "FAIL", time.time() - start, note))
+
+    if not passed:
+        sys.stdout.write(result.stderr)
+        sys.stdout.writelines(line + "\n" for line in result.stdout.splitlines() if " FAIL " in line)
+
+    return passed
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Run the simulator regression scripts")
+    parser.add_argument("--program", default=".pio/build/sim/program", help="simulator binary")
+    parser.add_argument("--update", action="store_true", help="rewrite the expected traces")
+    parser.add_argument("names", nargs="*", help="scripts to run (default: all)")
+    options = parser.parse_args()
+
+    program = os.path.abspath(options.program)
+    names = options.names or sorted(f[:-4] for f in os.listdir(TESTS) if f.endswith(".txt"))
+    failed = [name for name in names if not run(program, name, options.update)]
+
+    if failed:
+        print("%d of %d failed: %s" % (len(failed), len(names), " ".join(failed)))
+        sys.exit(1)
+
+    print("%d passed" % len(names))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,896 @@
+/*************************************************************
+*********************** HOST SIMULATOR ***********************
+**************************************************************/
+
+/*
+Runs the firmware (setup(), scan, button service, menu and pages) on a virtual clock:
+  tios-sim [options] script
+
+  -d <time>  stop after this time (default: at the last script event)
+  -s <time>  scan step (default 10ms)
+  -f <time>  frame interval - how often the page is drawn (default 1s)
+  -t <time>  clock at boot, e.g. -t 49d to run across the millis() wrap
+  -e <file>  EEPROM image, loaded at boot and saved with the configuration at the end
+             (also the input of a frozen build, see tools/freeze_config.py)
+  -o <file>  record the firmware's serial output to a file (e.g. a screen mirroring
+             stream for tools/mirror.py)
+  -m <link>  run the Modbus slave on a pseudo terminal linked at this path, paced to real
+             time so a master can talk to it (sim_modbus build, see sim/modbus_master.py)
+  -q         no signal trace, only the script output
+  -v         show the firmware's serial output (stderr)
+
+Times are milliseconds or take a unit: 250ms, 10s, 5m, 2h, 60d.
+
+Script lines: <time> [every <interval>] <command> [arguments], # starts a comment
+  gpio <gpio> <0|1>                  input level (inputs idle HIGH)
+  analog <gpio> <raw>                ADC reading (0-4095)
+  touch <gpio> <raw>                 touch reading (untouched pads read 20000, a finger raises it)
+  touchtrace <gpio> <file>           replay a recorded touch trace, lines of "<ms> <raw>" from now
+  sine|ramp <gpio> <period> <min> <max>  analog waveform
+  pulse <gpio> <period us> <high us>  pulse train for capture inputs (0 0 stops it)
+  press <left|right|both> [hold]     press buttons and release after hold (default 100ms)
+  type <signal> <none|INP|SW|OUT|ANA|PWM|SRV|TCH|CAP> [burst|TOGGLE|view] [threshold]
+                                     SRV with 10, 100 or 1000 = pulse bursts, TCH with 5, 10, 20
+                                     or 40 (% of the baseline, default 10), CAP with DUTY, HIGH
+                                     or PERIOD (display)
+  source <signal> <signal|!signal|HIGH|LOW|0-155>
+  timer <T1|T2> <on> <off> <multiplier>  base values as in the menu (ms = base x multiplier)
+  compare <C1-C4> <signal|OFF> <on> <off>
+  block <D1-D4> <OFF|TON|TOF|TP|RETRIGGER> <signal|!signal> <preset> [analog signal]
+                                     timer block, preset is one of the nine menu times (100ms 250ms
+                                     500ms 1s 2s 5s 10s 30s 60s) - other times are rejected
+  serial <text>                      send a line to the firmware's serial port (e.g. mirror on)
+  i2c <MCP23017|PCF8575> <address>   expander chip on the I2C bus, e.g. i2c MCP23017 0x20 (time 0
+                                     only - chips are added before boot, so setup() finds them)
+  xgpio <X0-X31> <0|1>               drive an expander pin from outside (pins idle high)
+  xlevel <X0-X31> <0|1>              fail the run if the expander pin shows another level
+  xbus [count]                       print the I2C transactions since the last xbus (fail the run
+                                     if not the given count)
+  idle <0-4> [signal]                screen idle option as in the menu (0 = always on, 1 = dim 30s /
+                                     off 2m ... 4 = dim 15m / off 1h) and the signal that wakes it
+  headless <0|1>                     headless mode as in the menu (frames on request only)
+  screen                             print the screen state, backlight duty, frames drawn and UI mode
+  uptime [text]                      print the uptime text of the display (fail the run if it
+                                     is not the given text)
+  dump                               print every signal in use
+  expect <signal> <value>            fail the run if the signal has another value
+  end                                stop the simulation
+
+Signals use the labels of the display (13, 43, PB1, T1, C2, X5, D1 ...).
+
+The trace on stdout has one line per change of an output, touch or capture input, timer, comparator or timer block:
+  <days>+<hh:mm:ss.mmm> <signal> <value>
+*/
+
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <map>
+#include <vector>
+#include <chrono>
+#include <thread>
+#include <unistd.h>
+#include <fcntl.h>
+#include <termios.h>
+#include "sim.h"
+#include "signals.h"
+#include "compare.h"
+#include "timerblocks.h"
+#include "servo.h"
+#include "touch_input.h"
+#include "capture.h"
+#include "buttons.h"
+#include "scan.h"
+#include "jobs.h"
+#include "memstats.h"
+#include "mirror.h"
+#include "backlight.h"
+#include "headless.h"
+#include "pwm.h"
+#include "modbus_slave.h"
+#include "expander.h"
+
+// Firmware (main.cpp)
+extern byte pinTypes[SIGNAL_COUNT];
+extern byte pinSources[SIGNAL_COUNT];
+extern int pinStates[SIGNAL_COUNT];
+extern String pinLabels2[SIGNAL_COUNT];
+extern int pins[24];
+extern byte timerBaseValues[4];
+extern byte timerMultipliers[4];
+extern byte timerSources[4];
+extern byte uiMode;
+extern bool menuRedraw;
+extern unsigned long frameCount;
+extern char uptimeString[];
+void setup();
+int setupPins();
+void writeEprom();
+void pageButtons();
+void drawPage();
+void calculateUptime();
+
+#define GPIO_LEFT 0   // BOOT button
+#define GPIO_RIGHT 14 // KEY button
+
+enum Waveform { WAVE_NONE, WAVE_SINE, WAVE_RAMP };
+
+struct Wave {
+  Waveform shape;
+  uint64_t period; // us
+  int low;
+  int high;
+};
+
+struct Event {
+  int line;
+  uint64_t every; // us (0 = once)
+  std::vector<std::string> words;
+};
+
+static std::vector<Event> events;
+static std::multimap<std::pair<uint64_t, int>, int> schedule; // (time, order) -> event
+static int order = 0;
+static Wave waves[SIM_GPIOS];
+static bool wavesUsed = false;
+
+// Expander pins driven from outside (bit n = pin n, 1 = high or open)
+static uint16_t expanderDrive[EXPANDERS] = {0xFFFF, 0xFFFF};
+static unsigned long busTransactions = 0; // at the last xbus
+static int traced[SIGNAL_COUNT];
+static uint64_t bootTime = 0; // virtual clock at boot (script time 0)
+static bool quiet = false;
+static bool finished = false;
+static int failures = 0;
+
+
+// Function to parse a time (ms, or with a unit) into us (false if invalid)
+static bool parseTime(const std::string &text, uint64_t &micros) {
+  char *end;
+  double value = strtod(text.c_str(), &end);
+  std::string unit = end;
+  double scale;
+
+  if(end == text.c_str() || value < 0) {
+    return false;
+  }
+
+  if(unit == "" || unit == "ms") scale = 1e3;
+  else if(unit == "us") scale = 1;
+  else if(unit == "s") scale = 1e6;
+  else if(unit == "m") scale = 60e6;
+  else if(unit == "h") scale = 3600e6;
+  else if(unit == "d") scale = 86400e6;
+  else return false;
+
+  micros = (uint64_t)(value * scale + 0.5);
+  return true;
+}
+
+// Function to format the virtual time for the trace
+static std::string formatTime(uint64_t micros) {
+  uint64_t ms = micros / 1000;
+  char text[40];
+  snprintf(text, sizeof(text), "%llu+%02u:%02u:%02u.%03u", (unsigned long long)(ms / 86400000),
+           (unsigned)(ms / 3600000 % 24), (unsigned)(ms / 60000 % 60), (unsigned)(ms / 1000 % 60), (unsigned)(ms % 1000));
+  return text;
+}
+
+// Function to find a signal by its display label (-1 if unknown)
+static int findSignal(const std::string &label) {
+  for(int i=0; i<SIGNAL_COUNT; i++) {
+    if(label == pinLabels2[i].c_str() && label != "G" && label != "NC") {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+// Function to report a script error and stop
+static void scriptError(const Event &event, const char *message) {
+  fprintf(stderr, "line %d: %s\n", event.line, message);
+  exit(2);
+}
+
+// Function to read a number argument
+static long numberArg(const Event &event, size_t index, long low, long high) {
+  if(index >= event.words.size()) {
+    scriptError(event, "missing argument");
+  }
+
+  char *end;
+  long value = strtol(event.words[index].c_str(), &end, 10);
+
+  if(*end != 0 || value < low || value > high) {
+    scriptError(event, "argument out of range");
+  }
+
+  return value;
+}
+
+// Function to read a signal argument
+static int signalArg(const Event &event, size_t index) {
+  int found = index < event.words.size() ? findSignal(event.words[index]) : -1;
+
+  if(found < 0) {
+    scriptError(event, "unknown signal");
+  }
+
+  return found;
+}
+
+// Function to read an expander pin argument (X0-X31) - returns the expander, bit = pin
+static int expanderPinArg(const Event &event, size_t index, int &bit) {
+  int x = signalArg(event, index) - SIGNAL_EXPANDERS;
+
+  if(x < 0 || x >= EXPANDERS * EXPANDER_PINS) {
+    scriptError(event, "expander pin must be X0-X31");
+  }
+
+  bit = x % EXPANDER_PINS;
+  return x / EXPANDER_PINS;
+}
+
+// Function to read a time argument
+static uint64_t timeArg(const Event &event, size_t index) {
+  uint64_t micros;
+
+  if(index >= event.words.size() || !parseTime(event.words[index], micros)) {
+    scriptError(event, "bad time");
+  }
+
+  return micros;
+}
+
+// Function to put an event on the schedule
+static void plan(uint64_t time, int index) {
+  schedule.insert({{time, order++}, index});
+}
+
+// Function to add an internal event (button release)
+static void planInternal(uint64_t time, const Event &event) {
+  events.push_back(event);
+  plan(time, events.size() - 1);
+}
+
+// Function to print every configured signal
+static void dump() {
+  printf("%s dump", formatTime(simMicros).c_str());
+
+  for(int i=0; i<SIGNAL_COUNT; i++) {
+    if(pinTypes[i] != 0 || (i >= SIGNAL_PB1 && i < SIGNAL_EXPANDERS) || i >= SIGNAL_TIMER_BLOCKS) {
+      printf(" %s=%d", pinLabels2[i].c_str(), pinStates[i]);
+    }
+  }
+
+  printf("\n");
+}
+
+// Function to run one script command
+static void runEvent(const Event &event) {
+  const std::string &command = event.words[0];
+
+  if(command == "gpio") {
+    simLevels[numberArg(event, 1, 0, SIM_GPIOS-1)] = numberArg(event, 2, 0, 1);
+  }
+  else if(command == "analog") {
+    int gpio = numberArg(event, 1, 0, SIM_GPIOS-1);
+    waves[gpio].shape = WAVE_NONE;
+    simAnalog[gpio] = numberArg(event, 2, 0, 4095);
+  }
+  else if(command == "touch") {
+    simTouch[numberArg(event, 1, 0, SIM_GPIOS-1)] = numberArg(event, 2, 0, 4000000);
+  }
+  else if(command == "pulse") {
+    int gpio = numberArg(event, 1, 0, SIM_GPIOS-1);
+    simPulsePeriod[gpio] = numberArg(event, 2, 0, 10000000);
+    simPulseHigh[gpio] = numberArg(event, 3, 0, simPulsePeriod[gpio]);
+  }
+  else if(command == "touchtrace") { // each line becomes a touch event
+    int gpio = numberArg(event, 1, 0, SIM_GPIOS-1);
+    FILE *file = event.words.size() > 2 ? fopen(event.words[2].c_str(), "r") : nullptr;
+    unsigned long ms, raw;
+
+    if(file == nullptr) {
+      scriptError(event, "cannot open the touch trace");
+    }
+
+    while(fscanf(file, "%lu %lu", &ms, &raw) == 2) {
+      Event reading = {event.line, 0, {"touch", std::to_string(gpio), std::to_string(raw)}};
+      planInternal(simMicros - bootTime + (uint64_t)ms * 1000, reading);
+    }
+
+    fclose(file);
+  }
+  else if(command == "sine" || command == "ramp") {
+    Wave &wave = waves[numberArg(event, 1, 0, SIM_GPIOS-1)];
+    wave.shape = command == "sine" ? WAVE_SINE : WAVE_RAMP;
+    wavesUsed = true;
+    wave.period = max(timeArg(event, 2), (uint64_t)1);
+    wave.low = numberArg(event, 3, 0, 4095);
+    wave.high = numberArg(event, 4, 0, 4095);
+  }
+  else if(command == "press" || command == "release") {
+    std::string which = event.words.size() > 1 ? event.words[1] : "";
+    bool left = which == "left" || which == "both";
+    bool right = which == "right" || which == "both";
+    byte level = command == "press" ? LOW : HIGH;
+
+    if(!left && !right) {
+      scriptError(event, "button must be left, right or both");
+    }
+
+    if(left) simLevels[GPIO_LEFT] = level;
+    if(right) simLevels[GPIO_RIGHT] = level;
+
+    if(command == "press") { // release after the hold time
+      Event release = {event.line, 0, {"release", which}};
+      planInternal(simMicros - bootTime + (event.words.size() > 2 ? timeArg(event, 2) : 100000), release);
+    }
+  }
+  else if(command == "type") {
+    static const char *types[] = {"none", "INP", "SW", "OUT", "ANA", "PWM", "", "SRV", "TCH", "CAP"};
+    int slot = signalArg(event, 1);
+    int type = -1;
+
+    for(int t=0; t<10; t++) {
+      if(event.words.size() > 2 && event.words[2] == types[t] && t != 6) {
+        type = t;
+      }
+    }
+
+    if(type < 0 || (slot >= 24 && slot < SIGNAL_EXPANDERS) || slot >= SIGNAL_TIMER_BLOCKS || (slot >= SIGNAL_EXPANDERS && type != 0 && type != 1 && type != 3)) {
+      scriptError(event, "type not possible on this signal");
+    }
+
+    if(type == 8 && (slot >= 24 || !touchCapable(pins[slot]))) {
+      scriptError(event, "no touch channel on this signal");
+    }
+
+    if(type == 9 && slot >= 24) {
+      scriptError(event, "capture is only possible on a header pin");
+    }
+
+    if(type == 7) { // servo, or a pulse burst of the given length
+      servoModes[slot] = SERVO_PULSE;
+
+      for(int m=1; m<SERVO_MODES && event.words.size() > 3; m++) {
+        if(numberArg(event, 3, 0, 1000) == (long)servoBurstCounts[m]) {
+          servoModes[slot] = m;
+        }
+      }
+    }
+
+    if(type == 8) { // momentary or toggle, then the threshold
+      size_t next = 3;
+      touchModes[slot] = TOUCH_MOMENTARY;
+      touchLevels[slot] = 1;
+
+      if(event.words.size() > next && event.words[next] == "TOGGLE") {
+        touchModes[slot] = TOUCH_TOGGLE;
+        next++;
+      }
+
+      if(event.words.size() > next) {
+        touchLevels[slot] = TOUCH_LEVELS;
+
+        for(int l=0; l<TOUCH_LEVELS; l++) {
+          if(numberArg(event, next, 0, 100) == touchPercents[l]) {
+            touchLevels[slot] = l;
+          }
+        }
+
+        if(touchLevels[slot] == TOUCH_LEVELS) {
+          scriptError(event, "threshold must be 5, 10, 20 or 40");
+        }
+      }
+    }
+
+    if(type == 9) { // the value shown on the display
+      static const char *views[] = {"DUTY", "HIGH", "PERIOD"}; // order matches the CAPTURE_VIEW_ values
+      captureViews[slot] = CAPTURE_VIEW_DUTY;
+
+      for(int v=0; v<CAPTURE_VIEWS && event.words.size() > 3; v++) {
+        if(event.words[3] == views[v]) {
+          captureViews[slot] = v;
+        }
+      }
+    }
+
+    pinTypes[slot] = type;
+    pinSources[slot] = 100;
+    setupPins();
+  }
+  else if(command == "source") {
+    int slot = signalArg(event, 1);
+    std::string value = event.words.size() > 2 ? event.words[2] : "";
+
+    if(value == "HIGH" || value == "LOW") {
+      pinSources[slot] = value == "HIGH" ? 201 : 200;
+    }
+    else if(value[0] == '!') {
+      Event inverted = {event.line, 0, {"", value.substr(1)}};
+      pinSources[slot] = 100 + signalArg(inverted, 1);
+    }
+    else if(findSignal(value) >= 0) {
+      pinSources[slot] = findSignal(value);
+    }
+    else { // fixed PWM value
+      pinSources[slot] = 100 + numberArg(event, 2, 0, 155);
+    }
+
+    setupPins();
+  }
+  else if(command == "timer") {
+    int timer = signalArg(event, 1) - SIGNAL_T1;
+
+    if(timer != 0 && timer != 1) {
+      scriptError(event, "timer must be T1 or T2");
+    }
+
+    for(int i=0; i<2; i++) {
+      timerBaseValues[timer*2 + i] = numberArg(event, 2 + i, 0, 255);
+      timerMultipliers[timer*2 + i] = numberArg(event, 4, 1, 255);
+      timerSources[timer*2 + i] = 0; // fixed time
+    }
+  }
+  else if(command == "compare") {
+    int block = signalArg(event, 1) - SIGNAL_COMPARATORS;
+
+    if(block < 0 || block >= COMPARATORS) {
+      scriptError(event, "comparator must be C1-C4");
+    }
+
+    comparatorSources[block] = event.words.size() > 2 && event.words[2] == "OFF" ? COMPARATOR_OFF : signalArg(event, 2);
+    comparatorOn[block] = numberArg(event, 3, 0, 255);
+    comparatorOff[block] = numberArg(event, 4, 0, 255);
+  }
+  else if(command == "block") {
+    static const char *modes[BLOCK_MODES] = {"OFF", "TON", "TOF", "TP", "RETRIGGER"};
+    int block = signalArg(event, 1) - SIGNAL_TIMER_BLOCKS;
+    int mode = -1;
+    int preset = -1;
+
+    if(block < 0 || block >= TIMER_BLOCKS) {
+      scriptError(event, "timer block must be D1-D4");
+    }
+
+    for(int m=0; m<BLOCK_MODES; m++) {
+      if(event.words.size() > 2 && event.words[2] == modes[m]) {
+        mode = m;
+      }
+    }
+
+    if(mode < 0) {
+      scriptError(event, "mode must be OFF, TON, TOF, TP or RETRIGGER");
+    }
+
+    blockModes[block] = mode;
+
+    if(mode != BLOCK_OFF) {
+      std::string trigger = event.words.size() > 3 ? event.words[3] : "";
+      Event direct = {event.line, 0, {"", trigger[0] == '!' ? trigger.substr(1) : trigger}};
+      blockTriggers[block] = signalArg(direct, 1) + (trigger[0] == '!' ? 100 : 0);
+
+      for(int p=0; p<BLOCK_PRESETS; p++) {
+        if(timeArg(event, 4) == blockPresetTimes[p] * 1000) {
+          preset = p;
+        }
+      }
+
+      if(preset < 0) {
+        scriptError(event, "time must be a preset (100ms 250ms 500ms 1s 2s 5s 10s 30s 60s)");
+      }
+
+      blockPresets[block] = preset;
+      blockTimeSources[block] = event.words.size() > 5 ? signalArg(event, 5) : BLOCK_FIXED;
+    }
+
+    timerBlocksReset(pinStates);
+  }
+  else if(command == "serial") {
+    std::string line;
+
+    for(size_t i=1; i<event.words.size(); i++) {
+      line += (i > 1 ? " " : "") + event.words[i];
+    }
+
+    Serial.feed(line + "\n");
+  }
+  else if(command == "idle") {
+    backlightIdle = numberArg(event, 1, 0, BACKLIGHT_IDLE_OPTIONS-1);
+    backlightWake = event.words.size() > 2 ? signalArg(event, 2) : BACKLIGHT_NO_WAKE;
+  }
+  else if(command == "headless") {
+    headlessMode = numberArg(event, 1, 0, HEADLESS_MODES-1);
+  }
+  else if(command == "screen") {
+    const char *states[] = {"ON", "DIM", "OFF"};
+    printf("%s screen %s backlight %u frames %lu ui %d\n", formatTime(simMicros).c_str(), states[backlightState()],
+           ledcRead(PWM_BACKLIGHT_CHANNEL), frameCount, uiMode);
+  }
+  else if(command == "uptime") {
+    calculateUptime();
+    printf("%s uptime %s\n", formatTime(simMicros).c_str(), uptimeString);
+
+    if(event.words.size() > 1 && event.words[1] != uptimeString) { // expected text
+      printf("%s FAIL line %d: uptime is %s, expected %s\n", formatTime(simMicros).c_str(), event.line,
+             uptimeString, event.words[1].c_str());
+      failures++;
+    }
+  }
+  else if(command == "xgpio") {
+    int bit;
+    int e = expanderPinArg(event, 1, bit);
+    expanderDrive[e] = numberArg(event, 2, 0, 1) ? expanderDrive[e] | 1 << bit : expanderDrive[e] & ~(1 << bit);
+    simI2c.setInputs(expanderConfigs[e].address, expanderDrive[e]);
+  }
+  else if(command == "xlevel") {
+    int bit;
+    int e = expanderPinArg(event, 1, bit);
+    long expected = numberArg(event, 2, 0, 1);
+    int level = (simI2c.levels(expanderConfigs[e].address) >> bit) & 1;
+
+    if(level != expected) {
+      printf("%s FAIL line %d: %s shows %d on the chip, expected %ld\n", formatTime(simMicros).c_str(), event.line,
+             event.words[1].c_str(), level, expected);
+      failures++;
+    }
+  }
+  else if(command == "xbus") {
+    unsigned long count = simI2c.transactions - busTransactions;
+    busTransactions = simI2c.transactions;
+    printf("%s xbus %lu\n", formatTime(simMicros).c_str(), count);
+
+    if(event.words.size() > 1 && (long)count != numberArg(event, 1, 0, 1000000000)) { // expected count
+      printf("%s FAIL line %d: %lu bus transactions, expected %s\n", formatTime(simMicros).c_str(), event.line,
+             count, event.words[1].c_str());
+      failures++;
+    }
+  }
+  else if(command == "dump") {
+    dump();
+  }
+  else if(command == "expect") {
+    int slot = signalArg(event, 1);
+    long expected = numberArg(event, 2, -32768, 32767);
+
+    if(pinStates[slot] != expected) {
+      printf("%s FAIL line %d: %s is %d, expected %ld\n", formatTime(simMicros).c_str(), event.line,
+             pinLabels2[slot].c_str(), pinStates[slot], expected);
+      failures++;
+    }
+  }
+  else if(command == "end") {
+    finished = true;
+  }
+  else {
+    scriptError(event, "unknown command");
+  }
+}
+
+// Function to load the script
+static void loadScript(const char *path) {
+  FILE *file = fopen(path, "r");
+  char text[256];
+  int line = 0;
+
+  if(file == nullptr) {
+    perror(path);
+    exit(2);
+  }
+
+  while(fgets(text, sizeof(text), file)) {
+    line++;
+    char *comment = strchr(text, '#');
+
+    if(comment != nullptr) {
+      *comment = 0;
+    }
+
+    Event event = {line, 0, {}};
+    uint64_t time;
+
+    for(char *word = strtok(text, " \t\r\n"); word != nullptr; word = strtok(nullptr, " \t\r\n")) {
+      event.words.push_back(word);
+    }
+
+    if(event.words.empty()) {
+      continue;
+    }
+
+    if(event.words.size() < 2 || !parseTime(event.words[0], time)) {
+      scriptError(event, "expected <time> <command>");
+    }
+
+    event.words.erase(event.words.begin());
+
+    if(event.words[0] == "every") {
+      event.every = timeArg(event, 1);
+      event.words.erase(event.words.begin(), event.words.begin() + 2);
+
+      if(event.words.empty() || event.every == 0) {
+        scriptError(event, "expected every <interval> <command>");
+      }
+    }
+
+    if(event.words[0] == "i2c") { // added now, before boot
+      char *end;
+      long address = strtol(event.words.size() > 2 ? event.words[2].c_str() : "", &end, 0);
+      bool mcp = event.words.size() > 1 && event.words[1] == "MCP23017";
+      bool pcf = event.words.size() > 1 && event.words[1] == "PCF8575";
+
+      if(time != 0 || event.every != 0 || (!mcp && !pcf) || address < 0x08 || address > 0x77 || *end != 0) {
+        scriptError(event, "expected 0 i2c <MCP23017|PCF8575> <address>");
+      }
+
+      if(!simI2c.addDevice(address, mcp ? MOCK_MCP23017 : MOCK_PCF8575)) {
+        scriptError(event, "address in use or too many chips");
+      }
+
+      continue;
+    }
+
+    events.push_back(event);
+    plan(time, events.size() - 1);
+  }
+
+  fclose(file);
+}
+
+// Function to set the analog inputs that follow a waveform
+static void updateWaves(uint64_t now) {
+  for(int gpio=0; gpio<SIM_GPIOS; gpio++) {
+    const Wave &wave = waves[gpio];
+
+    if(wave.shape != WAVE_NONE) {
+      double phase = (double)(now % wave.period) / wave.period;
+      double level = wave.shape == WAVE_SINE ? 0.5 - 0.5 * cos(2 * M_PI * phase) : phase;
+      simAnalog[gpio] = wave.low + (int)lround(level * (wave.high - wave.low));
+    }
+  }
+}
+
+// Function to print the signals that changed since the last step
+static void traceChanges() {
+  for(int i=0; i<SIGNAL_COUNT; i++) {
+    bool output = pinTypes[i] == 3 || pinTypes[i] == 5 || pinTypes[i] == 7 || pinTypes[i] == 8 || pinTypes[i] == 9 || (i >= SIGNAL_T1 && i < SIGNAL_EXPANDERS) || i >= SIGNAL_TIMER_BLOCKS;
+
+    if(output && pinStates[i] != traced[i]) {
+      traced[i] = pinStates[i];
+
+      if(!quiet) {
+        printf("%s %s %d\n", formatTime(simMicros).c_str(), pinLabels2[i].c_str(), pinStates[i]);
+      }
+    }
+  }
+}
+
+// Function to load or save the EEPROM image
+static void eepromFile(const char *path, bool save) {
+  FILE *file = path != nullptr ? fopen(path, save ? "wb" : "rb") : nullptr;
+
+  if(file == nullptr) {
+    return; // no image yet - starts erased
+  }
+
+  if(save) {
+    fwrite(EEPROM.data(), 1, EEPROM.length(), file);
+  }
+  else {
+    size_t loaded = fread(EEPROM.data(), 1, EEPROM.length(), file);
+    (void)loaded;
+  }
+
+  fclose(file);
+}
+
+// Function to open a pseudo terminal for the Modbus UART and link it at path
+static int modbusOpen(const char *path) {
+  int master = posix_openpt(O_RDWR | O_NOCTTY);
+
+  if(master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) {
+    return -1;
+  }
+
+  // The port stays open here as well, so it keeps its raw mode between the master's opens
+  const char *port = ptsname(master);
+  int slave = open(port, O_RDWR | O_NOCTTY);
+  struct termios raw;
+
+  if(slave < 0 || tcgetattr(slave, &raw) != 0) {
+    return -1;
+  }
+
+  cfmakeraw(&raw);
+  tcsetattr(slave, TCSANOW, &raw);
+  fcntl(master, F_SETFL, O_NONBLOCK);
+  unlink(path);
+
+  if(symlink(port, path) != 0) {
+    return -1;
+  }
+
+  FILE *output = fdopen(master, "wb");
+  setvbuf(output, nullptr, _IONBF, 0); // each response goes out in one write
+  Serial1.attach(output);
+  fprintf(stderr, "Modbus slave on %s (%s)\n", path, port);
+  return master;
+}
+
+// Function to hand the bytes from the master to the UART and run the slave (every step)
+static void modbusStep(int master) {
+#ifdef MODBUS_ENABLE
+  char buffer[512];
+  ssize_t length;
+
+  while((length = read(master, buffer, sizeof(buffer))) > 0) {
+    Serial1.feed(std::string(buffer, length));
+  }
+
+  modbusPoll();
+#endif
+}
+
+int main(int argc, char **argv) {
+  uint64_t stopTime = 0;
+  uint64_t step = 10000;
+  uint64_t frame = 1000000;
+  const char *eepromPath = nullptr;
+  const char *serialPath = nullptr;
+  const char *modbusPath = nullptr;
+  bool verbose = false;
+  int option;
+
+  while((option = getopt(argc, argv, "d:s:f:t:e:o:m:qv")) != -1) {
+    bool valid = true;
+
+    switch(option) {
+      case 'd': valid = parseTime(optarg, stopTime); break;
+      case 's': valid = parseTime(optarg, step) && step > 0; break;
+      case 'f': valid = parseTime(optarg, frame) && frame > 0; break;
+      case 't': valid = parseTime(optarg, bootTime); break;
+      case 'e': eepromPath = optarg; break;
+      case 'o': serialPath = optarg; break;
+      case 'm': modbusPath = optarg; break;
+      case 'q': quiet = true; break;
+      case 'v': verbose = true; break;
+      default: valid = false;
+    }
+
+    if(!valid) {
+      fprintf(stderr, "usage: %s [-d time] [-s step] [-f frame] [-t boot time] [-e eeprom] [-o serial] [-m link] [-q] [-v] script\n", argv[0]);
+      return 2;
+    }
+  }
+
+  if(optind != argc - 1) {
+    fprintf(stderr, "usage: %s [-d time] [-s step] [-f frame] [-t boot time] [-e eeprom] [-o serial] [-m link] [-q] [-v] script\n", argv[0]);
+    return 2;
+  }
+
+  if(sizeof(unsigned long) != 4) {
+    fprintf(stderr, "warning: 64-bit build - millis() does not wrap like on the ESP32 (build with -m32)\n");
+  }
+
+  loadScript(argv[optind]);
+
+  FILE *serialFile = serialPath != nullptr ? fopen(serialPath, "wb") : nullptr;
+
+  if(serialPath != nullptr && serialFile == nullptr) {
+    fprintf(stderr, "cannot write %s\n", serialPath);
+    return 2;
+  }
+
+#ifndef MODBUS_ENABLE
+  if(modbusPath != nullptr) {
+    fprintf(stderr, "-m needs a build with MODBUS_ENABLE (env:sim_modbus)\n");
+    return 2;
+  }
+#endif
+
+  int modbusMaster = modbusPath != nullptr ? modbusOpen(modbusPath) : -1;
+
+  if(modbusPath != nullptr && modbusMaster < 0) {
+    fprintf(stderr, "cannot open a pseudo terminal at %s\n", modbusPath);
+    return 2;
+  }
+
+  if(stopTime == 0 && !schedule.empty()) {
+    stopTime = schedule.rbegin()->first.first;
+  }
+
+  // Boot
+  memset(simLevels, HIGH, sizeof(simLevels));
+
+  for(int gpio=1; gpio<=14; gpio++) {
+    simTouch[gpio] = SIM_TOUCH_IDLE;
+  }
+
+  simMicros = bootTime;
+  Serial.attach(serialFile != nullptr ? serialFile : verbose ? stderr : nullptr);
+  EEPROM.begin(4096); // larger than EEPROM_SIZE, so setup() keeps this image
+  eepromFile(eepromPath, false);
+  setup();
+  scanSetPeriod(0); // one scan per step, like FREE RUN
+
+  for(int i=0; i<SIGNAL_COUNT; i++) {
+    traced[i] = pinStates[i];
+  }
+
+  auto wallStart = std::chrono::steady_clock::now();
+  uint64_t stop = bootTime + stopTime;
+  uint64_t nextFrame = simMicros;
+  unsigned long long scans = 0;
+
+  while(!finished && simMicros <= stop) {
+    uint64_t now = simMicros - bootTime; // script time
+
+    // Script events due by now
+    while(!schedule.empty() && schedule.begin()->first.first <= now && !finished) {
+      int index = schedule.begin()->second;
+      schedule.erase(schedule.begin());
+
+      if(events[index].every > 0) {
+        plan(now + events[index].every, index);
+      }
+
+      Event event = events[index]; // a press adds its release to the list
+      runEvent(event);
+    }
+
+    if(wavesUsed) {
+      updateWaves(now);
+    }
+
+    // One loop() pass, with the page drawn at the frame rate only (not while the screen is off,
+    // and only on request when headless)
+    simTouchStep();
+    simCaptureStep();
+
+    if(modbusMaster >= 0) {
+      std::this_thread::sleep_until(wallStart + std::chrono::microseconds(simMicros - bootTime)); // real time
+      modbusStep(modbusMaster);
+    }
+
+    buttonsPoll();
+    scanFreeRun();
+
+    if(backlightService(pinStates)) {
+      menuRedraw = true;
+    }
+
+    bool headless = headlessService(uiMode == 1);
+
+    if(backlightScreenOn() || headless) {
+      pageButtons();
+    }
+
+    jobsRun();
+
+    if(headless ? headlessFrameDue() : backlightScreenOn() && (uiMode == 1 || simMicros >= nextFrame)) {
+      drawPage();
+      memStatsFrame();
+      mirrorFrame();
+      nextFrame = simMicros + frame;
+    }
+
+    traceChanges();
+    scans++;
+    simMicros += step;
+  }
+
+  double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+  double simSeconds = (simMicros - bootTime) / 1e6;
+  fprintf(stderr, "Simulated %s in %.1f s (%.0fx real time), %llu scans, %d failed expectations\n",
+          formatTime(simMicros - bootTime).c_str(), wallSeconds, simSeconds / max(wallSeconds, 1e-6), scans, failures);
+
+  writeEprom(); // as on menu exit
+  eepromFile(eepromPath, true);
+
+  if(serialFile != nullptr) {
+    fclose(serialFile);
+  }
+
+  return failures > 0 ? 1 : 0;
+}
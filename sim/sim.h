@@ -0,0 +1,33 @@
+#ifndef TIOS_SIM_H
+#define TIOS_SIM_H
+
+#include <Arduino.h>
+#include "i2c_mock.h"
+
+/*
+Host simulator state shared by the platform stand-ins (sim/host) and the driver (sim.cpp):
+ - simMicros is the virtual clock - nothing advances it but the driver, so a scan takes
+   no simulated time and days of operation run in seconds
+ - Digital inputs idle HIGH (pull-ups, buttons released), analog inputs at 0, touch pads
+   untouched (SIM_TOUCH_IDLE), no pulse trains
+ - A pulse train drives the input level of its GPIO and the capture interrupts of the
+   MCPWM channels routed to it; edges fall on the virtual clock, not on the scan steps
+ - Expander chips sit on simI2c, which the host Wire drives; the script adds them before boot
+*/
+
+#define SIM_GPIOS 49 // GPIO0-48
+#define SIM_TOUCH_IDLE 20000 // touch reading of an untouched pad (GPIO1-14)
+
+extern uint64_t simMicros;                 // virtual time since boot (us)
+extern byte simLevels[SIM_GPIOS];          // input level per GPIO (script)
+extern uint16_t simAnalog[SIM_GPIOS];      // ADC reading per GPIO (script)
+extern byte simOutputs[SIM_GPIOS];         // level last written per GPIO (firmware)
+extern uint32_t simTouch[SIM_GPIOS];       // touch reading per GPIO (script)
+extern uint32_t simPulsePeriod[SIM_GPIOS]; // pulse train per GPIO (script, us - 0 = none)
+extern uint32_t simPulseHigh[SIM_GPIOS];   // high time of the pulse train (us)
+extern MockI2cBus simI2c;                  // expander chips (script)
+
+void simTouchStep();
+void simCaptureStep();
+
+#endif
@@ -0,0 +1,45 @@
+/*************************************************************
+**************** CALIBRATED ANALOG CONVERSION ****************
+**************************************************************/
+
+#include <Arduino.h>
+#include <driver/adc.h>  // for ADC control
+#include "esp_adc_cal.h" // for ADC calibration
+#include "analog.h"
+#include "placement.h" // memory map
+
+#define TABLE_STEP_BITS 4                      // one table point every 16 raw codes
+#define TABLE_POINTS ((4096 >> TABLE_STEP_BITS) + 1)
+#define DEFAULT_VREF 1100                      // mV, used when eFuse holds no calibration
+
+// raw->mV tables for ADC1 (GPIO1-10) and ADC2 (GPIO11-20)
+static uint16_t millivoltTables[2][TABLE_POINTS];
+
+
+// Function to characterise both ADC units and build their conversion tables
+void analogBegin() {
+  const adc_unit_t units[2] = {ADC_UNIT_1, ADC_UNIT_2};
+
+  for(int u=0; u<2; u++) {
+    esp_adc_cal_characteristics_t characteristics;
+
+    // Arduino reads the header pins with 11dB attenuation and 12-bit width
+    esp_adc_cal_characterize(units[u], ADC_ATTEN_DB_11, ADC_WIDTH_BIT_12, DEFAULT_VREF, &characteristics);
+
+    for(int p=0; p<TABLE_POINTS; p++) {
+      uint32_t raw = min(p << TABLE_STEP_BITS, 4095);
+      millivoltTables[u][p] = esp_adc_cal_raw_to_voltage(raw, &characteristics);
+    }
+  }
+
+  memRegister("ADC tables", millivoltTables, sizeof(millivoltTables));
+}
+
+// Function to convert a raw 12-bit reading of a GPIO to calibrated millivolts
+int analogMillivolts(int gpio, int raw) {
+  const uint16_t *table = millivoltTables[gpio > 10 ? 1 : 0];
+  int index = raw >> TABLE_STEP_BITS;
+  int fraction = raw & ((1 << TABLE_STEP_BITS) - 1);
+
+  return table[index] + (((table[index+1] - table[index]) * fraction) >> TABLE_STEP_BITS);
+}
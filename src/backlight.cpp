@@ -0,0 +1,168 @@
+/*************************************************************
+****************** DISPLAY POWER MANAGEMENT ******************
+**************************************************************/
+
+#include <Arduino.h>
+#include <driver/ledc.h> // for ledc hardware fades
+#include "backlight.h"
+#include "buttons.h"
+#include "pwm.h"     // backlight channel
+#include "signals.h" // wake signal range
+
+// Idle times - order must match the "SCREEN IDLE" menu
+const unsigned long backlightDimTimes[BACKLIGHT_IDLE_OPTIONS] = {0, 30, 60, 300, 900};
+const unsigned long backlightOffTimes[BACKLIGHT_IDLE_OPTIONS] = {0, 120, 300, 900, 3600};
+
+// Settings
+byte backlightIdle = 0;
+byte backlightWake = BACKLIGHT_NO_WAKE;
+
+// Backlight state
+static BacklightState state = BACKLIGHT_ON;
+static byte awakeLevel = 150;      // BRIGHTNESS menu level
+static byte targetDuty = 0;        // duty the backlight is at, or fading to
+static unsigned int fadeTime = 0;  // time of the fade waiting for the running one (0 = none)
+static unsigned long fadeEndTime = 0;
+static bool suspended = false;     // held off (headless)
+
+// Activity tracking
+static unsigned long lastActivity = 0;
+static uint32_t seenButtonEvents = 0;
+static byte wakeSlot = BACKLIGHT_NO_WAKE; // signal of wakeState
+static int wakeState = 0;
+
+
+// Function to start a fade, or keep it until the running fade has finished
+static void fadeTo(byte duty, unsigned int time) {
+  targetDuty = duty;
+  fadeTime = time;
+
+  if((long)(millis() - fadeEndTime) < 0) {
+    return; // started by backlightService()
+  }
+
+  fadeEndTime = millis() + time + 1;
+  fadeTime = 0;
+  ledc_set_fade_with_time(LEDC_LOW_SPEED_MODE, (ledc_channel_t)PWM_BACKLIGHT_CHANNEL, duty, time);
+  ledc_fade_start(LEDC_LOW_SPEED_MODE, (ledc_channel_t)PWM_BACKLIGHT_CHANNEL, LEDC_FADE_NO_WAIT);
+}
+
+// Function to set up the backlight at a level (the ledc fade service is installed by pwmBegin)
+void backlightBegin(byte level) {
+  ledcSetup(PWM_BACKLIGHT_CHANNEL, BACKLIGHT_FREQUENCY, BACKLIGHT_RESOLUTION);
+  ledcAttachPin(BACKLIGHT_GPIO, PWM_BACKLIGHT_CHANNEL);
+  ledcWrite(PWM_BACKLIGHT_CHANNEL, level);
+
+  awakeLevel = targetDuty = level;
+  state = BACKLIGHT_ON;
+  lastActivity = millis();
+  seenButtonEvents = buttonsEventCount();
+}
+
+// Function to set the awake level (BRIGHTNESS menu) - the menu is in use, so the screen is on
+void backlightSetLevel(byte level) {
+  awakeLevel = level;
+  fadeTo(level, BACKLIGHT_WAKE_FADE_MS);
+}
+
+// Function to get the awake level
+byte backlightLevel() {
+  return awakeLevel;
+}
+
+// Function to check for activity, dim or switch off when idle, and start a waiting fade
+// (call every loop pass, before the buttons are read - returns true when the screen woke up)
+bool backlightService(const int *states) {
+  bool activity = false;
+  bool woken = false;
+  uint32_t buttonEvents = buttonsEventCount();
+
+  if(suspended) { // headless - only a waiting fade
+    seenButtonEvents = buttonEvents;
+
+    if(fadeTime > 0) {
+      fadeTo(targetDuty, fadeTime);
+    }
+
+    return false;
+  }
+
+  if(buttonEvents != seenButtonEvents) {
+    seenButtonEvents = buttonEvents;
+    activity = true;
+
+    if(state == BACKLIGHT_OFF) { // the event only wakes the screen
+      ButtonEvent event;
+
+      while(buttonsRead(event)) {
+      }
+    }
+  }
+
+  // Wake signal (a new selection is taken as the reference, not as a change)
+  byte slot = backlightWake < SIGNAL_COUNT ? backlightWake : BACKLIGHT_NO_WAKE;
+
+  if(slot != wakeSlot) {
+    wakeSlot = slot;
+    wakeState = slot != BACKLIGHT_NO_WAKE ? states[slot] : 0;
+  }
+  else if(slot != BACKLIGHT_NO_WAKE && states[slot] != wakeState) {
+    wakeState = states[slot];
+    activity = true;
+  }
+
+  unsigned long idle = millis() - lastActivity;
+  byte option = backlightIdle < BACKLIGHT_IDLE_OPTIONS ? backlightIdle : 0;
+
+  if(activity) {
+    lastActivity = millis();
+    woken = state != BACKLIGHT_ON;
+
+    if(woken) {
+      state = BACKLIGHT_ON;
+      fadeTo(awakeLevel, BACKLIGHT_WAKE_FADE_MS);
+    }
+  }
+  else if(backlightDimTimes[option] == 0) { // always on (the setting may have just changed)
+    if(state != BACKLIGHT_ON) {
+      state = BACKLIGHT_ON;
+      fadeTo(awakeLevel, BACKLIGHT_WAKE_FADE_MS);
+    }
+  }
+  else if(state != BACKLIGHT_OFF && idle >= backlightOffTimes[option] * 1000) {
+    state = BACKLIGHT_OFF;
+    fadeTo(0, BACKLIGHT_OFF_FADE_MS);
+  }
+  else if(state == BACKLIGHT_ON && idle >= backlightDimTimes[option] * 1000) {
+    state = BACKLIGHT_DIM;
+    fadeTo(min(awakeLevel, (byte)BACKLIGHT_DIM_LEVEL), BACKLIGHT_DIM_FADE_MS);
+  }
+
+  if(fadeTime > 0) {
+    fadeTo(targetDuty, fadeTime);
+  }
+
+  return woken;
+}
+
+// Function to hold the backlight off (headless) or give it back to the idle handling, lit
+void backlightSuspend(bool suspend) {
+  if(suspend == suspended) {
+    return;
+  }
+
+  suspended = suspend;
+  state = suspend ? BACKLIGHT_OFF : BACKLIGHT_ON;
+  lastActivity = millis();
+  fadeTo(suspend ? 0 : awakeLevel, suspend ? BACKLIGHT_OFF_FADE_MS : BACKLIGHT_WAKE_FADE_MS);
+}
+
+// Function to check if the screen is to be drawn
+bool backlightScreenOn() {
+  return state != BACKLIGHT_OFF;
+}
+
+// Function to get the power state of the screen
+BacklightState backlightState() {
+  return state;
+}
@@ -0,0 +1,199 @@
+/*************************************************************
+*********************** BUTTON SERVICE ***********************
+**************************************************************/
+
+#include <Arduino.h>
+#include "buttons.h"
+
+#define EVENT_QUEUE_SIZE 16
+
+const byte buttonGpios[2] = {0, 14};
+
+// Debounce state per button
+struct ButtonState {
+  byte rawLevel;           // last level read
+  byte stableLevel;        // debounced level (LOW = pressed)
+  unsigned long changeTime;   // time of the last raw change
+  unsigned long pressTime;    // time of the debounced press
+  unsigned long nextRepeat;   // time of the next auto-repeat
+  bool longSent;
+  bool pressHeld;             // press not sent yet - a chord may still follow
+};
+
+static ButtonState buttons[2];
+static bool chorded = false; // chord sent - silent until both released
+static TaskHandle_t buttonTask;
+static QueueHandle_t eventQueue;
+static volatile uint32_t eventCount = 0; // events generated, for activity tracking
+
+
+// Function to wake the debounce task on a pin change
+static void IRAM_ATTR buttonChange() {
+  BaseType_t woken = pdFALSE;
+  vTaskNotifyGiveFromISR(buttonTask, &woken);
+  portYIELD_FROM_ISR(woken);
+}
+
+// Function to queue an event (dropped if nobody reads the queue)
+static void sendEvent(ButtonEventType type, byte button, unsigned long now) {
+  ButtonEvent event = {type, button, now};
+  xQueueSend(eventQueue, &event, 0);
+  eventCount++;
+}
+
+// Function to debounce one button and generate its events
+static void updateButton(byte b, unsigned long now) {
+  ButtonState &state = buttons[b];
+  byte level = digitalRead(buttonGpios[b]);
+
+  if(level != state.rawLevel) {
+    state.rawLevel = level;
+    state.changeTime = now;
+  }
+
+  // New stable level
+  if(state.rawLevel != state.stableLevel && now - state.changeTime >= BUTTON_DEBOUNCE_MS) {
+    state.stableLevel = state.rawLevel;
+
+    if(state.stableLevel == LOW) {
+      state.pressTime = now;
+      state.nextRepeat = now + BUTTON_REPEAT_DELAY_MS;
+      state.longSent = false;
+      state.pressHeld = false;
+
+      if(buttons[b ^ 1].stableLevel == LOW && !chorded) { // other button already held
+        chorded = true;
+        buttons[b ^ 1].pressHeld = false; // its press within the window is part of the chord
+        sendEvent(BUTTON_CHORD, BUTTON_BOTH, now);
+      }
+      else if(!chorded) {
+        state.pressHeld = true; // sent once the chord window has passed
+      }
+    }
+    else {
+      if(state.pressHeld) { // tap shorter than the chord window
+        state.pressHeld = false;
+        sendEvent(BUTTON_PRESS, b, state.pressTime);
+      }
+
+      if(!chorded) {
+        sendEvent(BUTTON_RELEASE, b, now);
+      }
+
+      if(buttons[b ^ 1].stableLevel == HIGH) {
+        chorded = false;
+      }
+    }
+  }
+
+  // Held - press after the chord window, long-press and auto-repeat
+  if(state.stableLevel == LOW && !chorded) {
+    if(state.pressHeld && now - state.pressTime >= BUTTON_CHORD_MS) {
+      state.pressHeld = false;
+      sendEvent(BUTTON_PRESS, b, state.pressTime);
+    }
+
+    if(!state.longSent && now - state.pressTime >= BUTTON_LONG_MS) {
+      state.longSent = true;
+      sendEvent(BUTTON_LONG, b, now);
+    }
+
+    if((long)(now - state.nextRepeat) >= 0) {
+      state.nextRepeat += BUTTON_REPEAT_MS;
+      sendEvent(BUTTON_REPEAT, b, now);
+    }
+  }
+}
+
+// Function to find how long the task may sleep before a button needs attention (ms)
+static TickType_t sleepTime(unsigned long now) {
+  long shortest = -1; // -1 = nothing pending, wait for an interrupt
+
+  for(int b=0; b<2; b++) {
+    ButtonState &state = buttons[b];
+    long wait = -1;
+
+    if(state.rawLevel != state.stableLevel) {
+      wait = BUTTON_DEBOUNCE_MS - (long)(now - state.changeTime);
+    }
+    else if(state.stableLevel == LOW && !chorded) {
+      wait = (long)(state.nextRepeat - now);
+
+      if(state.pressHeld) {
+        wait = min(wait, BUTTON_CHORD_MS - (long)(now - state.pressTime));
+      }
+
+      if(!state.longSent) {
+        wait = min(wait, BUTTON_LONG_MS - (long)(now - state.pressTime));
+      }
+    }
+
+    if(wait >= 0 && (shortest < 0 || wait < shortest)) {
+      shortest = wait;
+    }
+  }
+
+  return shortest < 0 ? portMAX_DELAY : pdMS_TO_TICKS(max(shortest, 1L));
+}
+
+// Function to debounce the buttons (button task)
+static void buttonLoop(void *parameter) {
+  TickType_t timeout = portMAX_DELAY;
+
+  for(;;) {
+    ulTaskNotifyTake(pdTRUE, timeout);
+    unsigned long now = millis();
+
+    for(byte b=0; b<2; b++) {
+      updateButton(b, now);
+    }
+
+    timeout = sleepTime(now);
+  }
+}
+
+// Function to start the button service
+void buttonsBegin() {
+  eventQueue = xQueueCreate(EVENT_QUEUE_SIZE, sizeof(ButtonEvent));
+
+  for(int b=0; b<2; b++) {
+    pinMode(buttonGpios[b], INPUT_PULLUP);
+    buttons[b].rawLevel = digitalRead(buttonGpios[b]);
+    buttons[b].stableLevel = HIGH; // a button held at boot counts as a press
+    buttons[b].changeTime = millis();
+  }
+
+  xTaskCreatePinnedToCore(buttonLoop, "buttons", 2048, nullptr, 3, &buttonTask, 0);
+
+  for(int b=0; b<2; b++) {
+    attachInterrupt(digitalPinToInterrupt(buttonGpios[b]), buttonChange, CHANGE);
+  }
+
+  xTaskNotifyGive(buttonTask); // check the initial levels
+}
+
+// Function to run the debounce step without the task (host simulator)
+void buttonsPoll() {
+  unsigned long now = millis();
+
+  for(byte b=0; b<2; b++) {
+    updateButton(b, now);
+  }
+}
+
+// Function to take the next event (false if there is none)
+bool buttonsRead(ButtonEvent &event) {
+  return xQueueReceive(eventQueue, &event, 0) == pdTRUE;
+}
+
+// Function to wait until an event is queued or the timeout (ms) expires
+bool buttonsWait(unsigned long timeout) {
+  ButtonEvent event;
+  return xQueuePeek(eventQueue, &event, pdMS_TO_TICKS(timeout)) == pdTRUE;
+}
+
+// Function to get the number of events generated so far (changes on any button activity,
+// also when the events are read elsewhere)
+uint32_t buttonsEventCount() {
+  return eventCount;
+}
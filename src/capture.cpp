@@ -0,0 +1,197 @@
+/*************************************************************
+*********************** CAPTURE INPUTS ***********************
+**************************************************************/
+
+#include <Arduino.h>
+#include <driver/mcpwm.h> // for the capture channels
+#include "capture.h"
+
+#define NO_GPIO 255
+#define NO_SLOT 255
+
+// Edge state of a capture channel (written by the capture interrupt)
+struct CaptureChannel {
+  uint32_t riseTicks;   // last rising edge
+  uint32_t fallTicks;   // last falling edge after it
+  bool risen;
+  bool fallen;
+  uint32_t periodTicks; // last complete cycle, rise to rise (0 = none yet)
+  uint32_t highTicks;
+  uint32_t edges;       // edges seen
+};
+
+// Per-pin configuration (stored in EEPROM) and measurements
+byte captureViews[CAPTURE_SLOTS] = {0};
+byte captureChannels[CAPTURE_SLOTS];
+uint32_t captureHighMicros[CAPTURE_SLOTS] = {0};
+uint32_t capturePeriodMicros[CAPTURE_SLOTS] = {0};
+
+// Channel bookkeeping
+static CaptureChannel channels[CAPTURE_CHANNELS];
+static byte channelOwners[CAPTURE_CHANNELS];
+static portMUX_TYPE channelLock = portMUX_INITIALIZER_UNLOCKED;
+
+// Per-slot state
+static byte slotGpios[CAPTURE_SLOTS];
+static uint32_t slotEdges[CAPTURE_SLOTS];          // edge count at the last read
+static unsigned long slotEdgeTime[CAPTURE_SLOTS];  // time of the last read with new edges
+
+
+// Functions to map a channel to its MCPWM unit, capture channel and input signal
+static mcpwm_unit_t channelUnit(byte c) {
+  return c < 3 ? MCPWM_UNIT_0 : MCPWM_UNIT_1;
+}
+
+static mcpwm_capture_channel_id_t channelSelect(byte c) {
+  return (mcpwm_capture_channel_id_t)(MCPWM_SELECT_CAP0 + c % 3);
+}
+
+static mcpwm_io_signals_t channelSignal(byte c) {
+  return (mcpwm_io_signals_t)(MCPWM_CAP_0 + c % 3);
+}
+
+// Function to take an edge timestamp (capture interrupt)
+static bool IRAM_ATTR captureEdge(mcpwm_unit_t unit, mcpwm_capture_channel_id_t capture, const cap_event_data_t *edge, void *parameter) {
+  CaptureChannel &channel = channels[(uintptr_t)parameter];
+  uint32_t ticks = edge->cap_value;
+
+  portENTER_CRITICAL_ISR(&channelLock);
+
+  if(edge->cap_edge == MCPWM_POS_EDGE) {
+    if(channel.risen && channel.fallen) { // rise, fall, rise - a whole cycle
+      channel.periodTicks = ticks - channel.riseTicks;
+      channel.highTicks = channel.fallTicks - channel.riseTicks;
+    }
+
+    channel.riseTicks = ticks;
+    channel.risen = true;
+    channel.fallen = false;
+  }
+  else if(channel.risen) {
+    channel.fallTicks = ticks;
+    channel.fallen = true;
+  }
+
+  channel.edges++;
+  portEXIT_CRITICAL_ISR(&channelLock);
+  return false; // no task to wake
+}
+
+// Function to initialize the channel bookkeeping (call once before any attach)
+void captureBegin() {
+  for(byte c=0; c<CAPTURE_CHANNELS; c++) {
+    channelOwners[c] = NO_SLOT;
+  }
+
+  for(int i=0; i<CAPTURE_SLOTS; i++) {
+    captureChannels[i] = CAPTURE_NO_CHANNEL;
+    slotGpios[i] = NO_GPIO;
+  }
+}
+
+// Function to attach a pin slot to a capture channel (returns false when none is free -
+// called again, a pin without a channel retries)
+bool captureAttach(int slot, int gpio) {
+  if(slotGpios[slot] == gpio && captureChannels[slot] != CAPTURE_NO_CHANNEL) {
+    return true; // unchanged
+  }
+
+  captureDetach(slot);
+  slotGpios[slot] = gpio;
+  pinMode(gpio, INPUT_PULLDOWN); // an open input reads 0 instead of catching noise
+
+  byte c = 0;
+
+  while(c < CAPTURE_CHANNELS && channelOwners[c] != NO_SLOT) {
+    c++;
+  }
+
+  if(c == CAPTURE_CHANNELS) { // out of channels - the pin reads 0
+    return false;
+  }
+
+  channels[c] = CaptureChannel();
+  channelOwners[c] = slot;
+  captureChannels[slot] = c;
+  slotEdges[slot] = 0;
+  slotEdgeTime[slot] = millis();
+
+  mcpwm_capture_config_t config = {};
+  config.cap_edge = MCPWM_BOTH_EDGE;
+  config.cap_prescale = 1;
+  config.capture_cb = captureEdge;
+  config.user_data = (void*)(uintptr_t)c;
+
+  mcpwm_gpio_init(channelUnit(c), channelSignal(c), gpio);
+  mcpwm_capture_enable_channel(channelUnit(c), channelSelect(c), &config);
+
+  return true;
+}
+
+// Function to release a pin slot and its channel
+void captureDetach(int slot) {
+  byte c = captureChannels[slot];
+
+  if(c != CAPTURE_NO_CHANNEL) {
+    mcpwm_capture_disable_channel(channelUnit(c), channelSelect(c));
+    channelOwners[c] = NO_SLOT;
+    captureChannels[slot] = CAPTURE_NO_CHANNEL;
+  }
+
+  slotGpios[slot] = NO_GPIO;
+  captureHighMicros[slot] = capturePeriodMicros[slot] = 0;
+}
+
+// Function to take over the last measured cycle of each capture pin (duty 0-255)
+void captureInputsRead(int *states) {
+  for(byte c=0; c<CAPTURE_CHANNELS; c++) {
+    byte slot = channelOwners[c];
+
+    if(slot == NO_SLOT) {
+      continue;
+    }
+
+    CaptureChannel &channel = channels[c];
+
+    portENTER_CRITICAL(&channelLock);
+    uint32_t period = channel.periodTicks;
+    uint32_t high = channel.highTicks;
+    uint32_t edges = channel.edges;
+    portEXIT_CRITICAL(&channelLock);
+
+    if(edges != slotEdges[slot]) {
+      slotEdges[slot] = edges;
+      slotEdgeTime[slot] = millis();
+    }
+    else if(period != 0 && millis() - slotEdgeTime[slot] >= CAPTURE_TIMEOUT_MS) {
+      // Signal stopped - the next cycle is measured from scratch
+      portENTER_CRITICAL(&channelLock);
+      channel.periodTicks = 0;
+      channel.risen = false;
+      portEXIT_CRITICAL(&channelLock);
+      period = 0;
+    }
+
+    if(period == 0) { // steady level
+      states[slot] = digitalRead(slotGpios[slot]) ? 255 : 0;
+      captureHighMicros[slot] = capturePeriodMicros[slot] = 0;
+    }
+    else {
+      states[slot] = ((uint64_t)high * 255 + period / 2) / period;
+      captureHighMicros[slot] = (high + CAPTURE_TICKS_PER_US / 2) / CAPTURE_TICKS_PER_US;
+      capturePeriodMicros[slot] = (period + CAPTURE_TICKS_PER_US / 2) / CAPTURE_TICKS_PER_US;
+    }
+  }
+}
+
+// Function to print the measurements of the capture pins
+void captureReport(Print &out) {
+  for(byte c=0; c<CAPTURE_CHANNELS; c++) {
+    byte slot = channelOwners[c];
+
+    if(slot != NO_SLOT) {
+      out.printf("Capture GPIO%d: period %lu us, high %lu us\n", slotGpios[slot],
+                 (unsigned long)capturePeriodMicros[slot], (unsigned long)captureHighMicros[slot]);
+    }
+  }
+}
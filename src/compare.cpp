@@ -0,0 +1,33 @@
+/*************************************************************
+******************** THRESHOLD COMPARATORS *******************
+**************************************************************/
+
+#include <Arduino.h>
+#include "compare.h"
+
+// Comparator configuration (stored in EEPROM)
+byte comparatorSources[COMPARATORS] = {COMPARATOR_OFF, COMPARATOR_OFF, COMPARATOR_OFF, COMPARATOR_OFF};
+byte comparatorOn[COMPARATORS] = {180, 180, 180, 180};
+byte comparatorOff[COMPARATORS] = {160, 160, 160, 160};
+
+
+// Function to update the comparator signals from the analog values (called once per scan)
+void comparatorsEvaluate(int *states) {
+  for(int c=0; c<COMPARATORS; c++) {
+    int *output = &states[SIGNAL_COMPARATORS + c];
+
+    if(comparatorSources[c] >= 24) { // not used
+      *output = 0;
+      continue;
+    }
+
+    int value = states[comparatorSources[c]];
+
+    if(*output == 0 && value > comparatorOn[c]) {
+      *output = 1;
+    }
+    else if(*output != 0 && value < comparatorOff[c]) {
+      *output = 0;
+    }
+  }
+}
@@ -0,0 +1,96 @@
+/*************************************************************
+********************** TRANSFER CURVES ***********************
+**************************************************************/
+
+#include <Arduino.h>
+#include "curves.h"
+
+// Curve definition - applied in order: deadband, points, gamma, invert, clamp
+struct CurveSpec {
+  float gamma;             // 1.0 = linear
+  byte deadband;           // inputs below this are treated as 0
+  byte minOut;             // output clamp (0-255)
+  byte maxOut;
+  bool invert;
+  const byte (*points)[2]; // piecewise-linear (x, y) points or nullptr
+  byte pointCount;
+};
+
+static const byte sCurvePoints[5][2] = {{0, 0}, {64, 20}, {128, 128}, {192, 235}, {255, 255}};
+
+// Curve table - order must match the "PWM CURVE" menu
+static const CurveSpec curveSpecs[CURVE_COUNT] = {
+  {1.0f, 0,  0,   255, false, nullptr,      0}, // LINEAR
+  {2.2f, 0,  0,   255, false, nullptr,      0}, // GAMMA 2.2
+  {2.8f, 0,  0,   255, false, nullptr,      0}, // GAMMA 2.8
+  {1.0f, 0,  0,   255, true,  nullptr,      0}, // INVERT
+  {1.0f, 16, 0,   255, false, nullptr,      0}, // DEADBAND
+  {1.0f, 0,  51,  204, false, nullptr,      0}, // CLAMP 20-80%
+  {1.0f, 0,  0,   255, false, sCurvePoints, 5}  // S-CURVE
+};
+
+// Per-pin curve selection and lookup tables
+byte pwmCurves[PWM_SLOTS] = {0};
+uint16_t curveTables[PWM_SLOTS][CURVE_SIZE];
+
+// Key of the table currently built for each slot
+static byte builtCurves[PWM_SLOTS];
+static byte builtResolutions[PWM_SLOTS] = {0}; // 0 = not built
+
+
+// Function to interpolate between the piecewise-linear points of a curve
+static float interpolate(const CurveSpec &spec, float x) {
+  for(int p=1; p<spec.pointCount; p++) {
+    if(x <= spec.points[p][0]) {
+      float x0 = spec.points[p-1][0], y0 = spec.points[p-1][1];
+      float x1 = spec.points[p][0], y1 = spec.points[p][1];
+      return y0 + (x - x0) * (y1 - y0) / (x1 - x0);
+    }
+  }
+
+  return spec.points[spec.pointCount-1][1];
+}
+
+// Function to precompute the lookup table of a pin slot for a resolution (in bits)
+// Returns true if the table was rebuilt
+bool curveBuild(int slot, byte resolution) {
+  if(pwmCurves[slot] >= CURVE_COUNT) {
+    pwmCurves[slot] = 0;
+  }
+
+  byte curve = pwmCurves[slot];
+
+  if(builtCurves[slot] == curve && builtResolutions[slot] == resolution) {
+    return false; // already up to date
+  }
+
+  const CurveSpec &spec = curveSpecs[curve];
+  float maxDuty = (float)((1UL << resolution) - 1);
+
+  for(int x=0; x<CURVE_SIZE; x++) {
+    float level = 0.0f; // 0.0 to 1.0
+
+    if(x >= spec.deadband) {
+      level = (float)(x - spec.deadband) / (255 - spec.deadband);
+    }
+
+    if(spec.pointCount > 0) {
+      level = interpolate(spec, level * 255.0f) / 255.0f;
+    }
+
+    if(spec.gamma != 1.0f) {
+      level = powf(level, spec.gamma);
+    }
+
+    if(spec.invert) {
+      level = 1.0f - level;
+    }
+
+    level = (spec.minOut + level * (spec.maxOut - spec.minOut)) / 255.0f;
+    curveTables[slot][x] = (uint16_t)(level * maxDuty + 0.5f);
+  }
+
+  builtCurves[slot] = curve;
+  builtResolutions[slot] = resolution;
+  return true;
+}
@@ -0,0 +1,313 @@
+/*************************************************************
+************************ I2C EXPANDERS ***********************
+**************************************************************/
+
+#include <Arduino.h>
+#include "expander.h"
+
+// MCP23017 registers (BANK = 0, port A/B pairs)
+#define MCP_IODIR 0x00
+#define MCP_GPPU 0x0C
+#define MCP_GPIO 0x12
+#define MCP_OLAT 0x14
+
+// Expander chips and addresses (-DEXPANDER1_CHIP=1 -DEXPANDER1_ADDRESS=0x22 etc.)
+#ifndef EXPANDER1_CHIP
+#define EXPANDER1_CHIP EXPANDER_MCP23017
+#endif
+
+#ifndef EXPANDER1_ADDRESS
+#define EXPANDER1_ADDRESS 0x20
+#endif
+
+#ifndef EXPANDER2_CHIP
+#define EXPANDER2_CHIP EXPANDER_PCF8575
+#endif
+
+#ifndef EXPANDER2_ADDRESS
+#define EXPANDER2_ADDRESS 0x21
+#endif
+
+const ExpanderConfig expanderConfigs[EXPANDERS] = {
+  {EXPANDER1_CHIP, EXPANDER1_ADDRESS},
+  {EXPANDER2_CHIP, EXPANDER2_ADDRESS}
+};
+bool expanderFound[EXPANDERS] = {false};
+
+// Bus and pin words (bit n = pin n of the expander)
+static I2cBus *bus = nullptr;
+static uint16_t inputMasks[EXPANDERS];   // 1 = input pin
+static uint16_t outputMasks[EXPANDERS];  // 1 = output pin
+static uint16_t inputWords[EXPANDERS];   // last read levels
+static uint16_t outputWords[EXPANDERS];  // levels wanted by the scan
+static uint16_t writtenWords[EXPANDERS]; // levels last written to the chip
+static volatile bool configPending = false;
+static bool writePending[EXPANDERS];
+
+// Cost accounting
+static unsigned long busMicros = 0;    // bus time of the last transfer
+static unsigned long busMicrosMax = 0;
+static unsigned long busErrors = 0;
+static unsigned long transfers = 0;
+
+#ifdef EXPANDER_ASYNC
+static TaskHandle_t busTask;
+static portMUX_TYPE wordLock = portMUX_INITIALIZER_UNLOCKED;
+#endif
+
+
+// Function to write the direction and pull-ups of one expander
+static bool writeConfig(int e, uint16_t inputs, uint16_t outputs) {
+  const ExpanderConfig &config = expanderConfigs[e];
+
+  if(config.chip == EXPANDER_MCP23017) {
+    uint16_t direction = ~outputs; // unused pins stay inputs
+    uint8_t iodir[3] = {MCP_IODIR, (uint8_t)(direction & 0xFF), (uint8_t)(direction >> 8)};
+    uint8_t gppu[3] = {MCP_GPPU, (uint8_t)(inputs & 0xFF), (uint8_t)(inputs >> 8)};
+    return bus->write(config.address, gppu, 3) && bus->write(config.address, iodir, 3);
+  }
+
+  return true; // PCF8575 has no direction register - inputs are written high
+}
+
+// Function to write all 16 outputs of one expander in one transaction
+static bool writeOutputs(int e, uint16_t word, uint16_t outputs) {
+  const ExpanderConfig &config = expanderConfigs[e];
+
+  if(config.chip == EXPANDER_MCP23017) {
+    uint8_t data[3] = {MCP_OLAT, (uint8_t)(word & 0xFF), (uint8_t)(word >> 8)};
+    return bus->write(config.address, data, 3);
+  }
+
+  word |= ~outputs; // quasi-bidirectional: inputs and unused pins must be high
+  uint8_t data[2] = {(uint8_t)(word & 0xFF), (uint8_t)(word >> 8)};
+  return bus->write(config.address, data, 2);
+}
+
+// Function to read all 16 pins of one expander in one transaction
+static bool readInputs(int e, uint16_t &word) {
+  const ExpanderConfig &config = expanderConfigs[e];
+  uint8_t data[2];
+  uint8_t pointer = MCP_GPIO;
+  bool ok = config.chip == EXPANDER_MCP23017 ? bus->read(config.address, &pointer, 1, data, 2)
+                                              : bus->read(config.address, nullptr, 0, data, 2);
+
+  if(ok) {
+    word = data[0] | data[1] << 8;
+  }
+
+  return ok;
+}
+
+// Function to run one bus transfer: pending configuration, changed outputs, then inputs
+static void transfer() {
+  unsigned long start = micros();
+  uint16_t inputs[EXPANDERS];
+  uint16_t outputs[EXPANDERS];
+
+  // Pending flag and masks are taken together, so a configuration the scan is changing
+  // is applied whole by this transfer or left pending for the next
+#ifdef EXPANDER_ASYNC
+  portENTER_CRITICAL(&wordLock);
+#endif
+  bool config = configPending;
+  configPending = false;
+  memcpy(inputs, inputMasks, sizeof(inputs));
+  memcpy(outputs, outputMasks, sizeof(outputs));
+#ifdef EXPANDER_ASYNC
+  portEXIT_CRITICAL(&wordLock);
+#endif
+
+  for(int e=0; e<EXPANDERS; e++) {
+    if(!expanderFound[e]) {
+      continue;
+    }
+
+    if(config && !writeConfig(e, inputs[e], outputs[e])) {
+      busErrors++;
+    }
+
+    uint16_t word;
+#ifdef EXPANDER_ASYNC
+    portENTER_CRITICAL(&wordLock);
+    word = outputWords[e];
+    portEXIT_CRITICAL(&wordLock);
+#else
+    word = outputWords[e];
+#endif
+
+    if(config || writePending[e] || word != writtenWords[e]) {
+      writePending[e] = !writeOutputs(e, word, outputs[e]);
+      busErrors += writePending[e];
+      writtenWords[e] = word;
+    }
+
+    uint16_t levels;
+
+    if(readInputs(e, levels)) {
+#ifdef EXPANDER_ASYNC
+      portENTER_CRITICAL(&wordLock);
+      inputWords[e] = levels;
+      portEXIT_CRITICAL(&wordLock);
+#else
+      inputWords[e] = levels;
+#endif
+    }
+    else {
+      busErrors++;
+    }
+  }
+
+  busMicros = micros() - start;
+  busMicrosMax = max(busMicrosMax, busMicros);
+  transfers++;
+}
+
+#ifdef EXPANDER_ASYNC
+// Function to run transfers when the scan hands over new outputs (bus task)
+static void busLoop(void *parameter) {
+  for(;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    transfer();
+  }
+}
+#endif
+
+// Function to probe the configured expanders and start the bus
+void expanderBegin(I2cBus &i2c) {
+  bus = &i2c;
+
+  for(int e=0; e<EXPANDERS; e++) {
+    uint16_t levels;
+    expanderFound[e] = readInputs(e, levels);
+    inputWords[e] = levels;
+    inputMasks[e] = 0;
+    outputMasks[e] = 0;
+    outputWords[e] = 0;
+    writtenWords[e] = 0;
+    writePending[e] = false;
+  }
+
+  configPending = true;
+
+#ifdef EXPANDER_ASYNC
+  xTaskCreatePinnedToCore(busLoop, "expanders", 2048, nullptr, 4, &busTask, 0);
+#endif
+}
+
+// Function to set the pin directions from the expander pin types (INP = 1, OUT = 3)
+// Returns the number of pins whose direction changed - applied by the next transfer
+int expanderConfigure(const byte *types) {
+  int changed = 0;
+  uint16_t inputs[EXPANDERS] = {0};
+  uint16_t outputs[EXPANDERS] = {0};
+
+  for(int e=0; e<EXPANDERS; e++) {
+    for(int p=0; p<EXPANDER_PINS; p++) {
+      byte type = types[e * EXPANDER_PINS + p];
+      inputs[e] |= (type == 1) << p;
+      outputs[e] |= (type == 3) << p;
+    }
+
+    uint16_t difference = (inputs[e] ^ inputMasks[e]) | (outputs[e] ^ outputMasks[e]);
+
+    for(int p=0; p<EXPANDER_PINS; p++) {
+      changed += (difference >> p) & 1;
+    }
+  }
+
+  if(changed > 0) {
+#ifdef EXPANDER_ASYNC
+    portENTER_CRITICAL(&wordLock);
+#endif
+    memcpy(inputMasks, inputs, sizeof(inputs));
+    memcpy(outputMasks, outputs, sizeof(outputs));
+    configPending = true;
+#ifdef EXPANDER_ASYNC
+    portEXIT_CRITICAL(&wordLock);
+#endif
+  }
+
+  return changed;
+}
+
+// Function to copy the expander inputs into the signal table (scan: snapshot phase)
+void expanderReadInputs(int *states) {
+  if(bus == nullptr) {
+    return;
+  }
+
+#ifndef EXPANDER_ASYNC
+  transfer(); // outputs of the previous scan, then this scan's inputs
+#endif
+
+  for(int e=0; e<EXPANDERS; e++) {
+    uint16_t word;
+#ifdef EXPANDER_ASYNC
+    portENTER_CRITICAL(&wordLock);
+    word = inputWords[e];
+    portEXIT_CRITICAL(&wordLock);
+#else
+    word = inputWords[e];
+#endif
+
+    for(int p=0; p<EXPANDER_PINS; p++) {
+      if((inputMasks[e] >> p) & 1) {
+        states[SIGNAL_EXPANDERS + e * EXPANDER_PINS + p] = (word >> p) & 1;
+      }
+    }
+  }
+}
+
+// Function to hand the expander outputs to the bus (scan: commit phase)
+void expanderWriteOutputs(const int *states) {
+  if(bus == nullptr) {
+    return;
+  }
+
+  for(int e=0; e<EXPANDERS; e++) {
+    uint16_t word = 0;
+
+    for(int p=0; p<EXPANDER_PINS; p++) {
+      if((outputMasks[e] >> p) & 1) {
+        word |= (states[SIGNAL_EXPANDERS + e * EXPANDER_PINS + p] != 0) << p;
+      }
+    }
+
+#ifdef EXPANDER_ASYNC
+    portENTER_CRITICAL(&wordLock);
+    outputWords[e] = word;
+    portEXIT_CRITICAL(&wordLock);
+#else
+    outputWords[e] = word;
+#endif
+  }
+
+#ifdef EXPANDER_ASYNC
+  xTaskNotifyGive(busTask); // transfer now, inputs are ready for the next scan
+#endif
+}
+
+// Function to check if a GPIO is used by the expander bus
+bool expanderOwnsPin(int gpio) {
+#ifdef EXPANDER_ENABLE
+  return gpio == EXPANDER_SDA || gpio == EXPANDER_SCL;
+#else
+  return false;
+#endif
+}
+
+// Function to print the bus cost (and optionally the expander status)
+void expanderReport(Print &out, bool devices) {
+  if(bus == nullptr) {
+    return;
+  }
+
+  for(int e=0; devices && e<EXPANDERS; e++) {
+    out.printf("Expander %d: %s 0x%02X %s\n", e + 1, expanderConfigs[e].chip == EXPANDER_MCP23017 ? "MCP23017" : "PCF8575",
+               expanderConfigs[e].address, expanderFound[e] ? "found" : "not found");
+  }
+
+  out.printf("Expander bus: %lu us per scan (max %lu us), %lu transfers, %lu errors\n",
+             busMicros, busMicrosMax, transfers, busErrors);
+}
@@ -0,0 +1,184 @@
+/*************************************************************
+******************* FRAMEBUFFER STREAM CODEC *****************
+**************************************************************/
+
+#include <string.h>
+#include "fbcodec.h"
+
+#define ADLER_MOD 65521
+#define ADLER_BLOCK 5552 // largest block before the sums can overflow 32 bits
+#define PALETTE_BYTES 32 // 16 RGB565 entries
+
+
+// Function to get the bytes per row of a frame
+size_t fbRowBytes(const FbFormat &format) {
+  return (size_t)format.width * format.depth / 8;
+}
+
+// Function to get the bytes of a whole frame
+size_t fbBytes(const FbFormat &format) {
+  return fbRowBytes(format) * format.height;
+}
+
+// Function to get the number of tiles of a frame
+size_t fbTiles(const FbFormat &format) {
+  return (size_t)((format.width + FB_TILE - 1) / FB_TILE) * ((format.height + FB_TILE - 1) / FB_TILE);
+}
+
+// Function to get the largest encoded frame (PackBits adds one byte per 128 literal units)
+size_t fbEncodeBound(const FbFormat &format) {
+  size_t bytes = fbBytes(format);
+  return FB_HEADER_BYTES + PALETTE_BYTES + (fbTiles(format) + 7) / 8 + bytes + bytes / 64 + fbTiles(format) * 2 + FB_CHECK_BYTES;
+}
+
+// Function to compare two units
+static inline bool sameUnit(const uint8_t *a, const uint8_t *b, uint8_t unit) {
+  return a[0] == b[0] && (unit == 1 || a[1] == b[1]);
+}
+
+// Function to PackBits-compress a buffer of whole units (returns the compressed bytes)
+size_t fbPackBits(const uint8_t *in, size_t bytes, uint8_t unit, uint8_t *out) {
+  size_t units = bytes / unit;
+  size_t i = 0;
+  size_t n = 0;
+
+  while(i < units) {
+    size_t run = 1;
+
+    while(i + run < units && run < 129 && sameUnit(in + (i + run) * unit, in + i * unit, unit)) {
+      run++;
+    }
+
+    if(run >= 2) { // repeated unit
+      out[n++] = run + 126;
+      memcpy(out + n, in + i * unit, unit);
+      n += unit;
+      i += run;
+      continue;
+    }
+
+    // Literal units up to the start of the next run
+    size_t start = i;
+    size_t count = 0;
+
+    while(i < units && count < 128 && !(i + 1 < units && sameUnit(in + (i + 1) * unit, in + i * unit, unit))) {
+      i++;
+      count++;
+    }
+
+    out[n++] = count - 1;
+    memcpy(out + n, in + start * unit, count * unit);
+    n += count * unit;
+  }
+
+  return n;
+}
+
+// Function to update an Adler-32 checksum
+uint32_t fbAdler32(const uint8_t *data, size_t bytes, uint32_t adler) {
+  uint32_t a = adler & 0xFFFF;
+  uint32_t b = adler >> 16;
+
+  while(bytes > 0) {
+    size_t block = bytes < ADLER_BLOCK ? bytes : ADLER_BLOCK;
+    bytes -= block;
+
+    while(block-- > 0) {
+      a += *data++;
+      b += a;
+    }
+
+    a %= ADLER_MOD;
+    b %= ADLER_MOD;
+  }
+
+  return (b << 16) | a;
+}
+
+// Function to write a little-endian value
+static void putLE(uint8_t *out, uint32_t value, int bytes) {
+  for(int i=0; i<bytes; i++) {
+    out[i] = value >> (8 * i);
+  }
+}
+
+// Function to fill in the header and append the checksum (returns the frame size)
+static size_t finishFrame(uint8_t *out, uint8_t type, const FbFormat &format, uint16_t number, size_t payload) {
+  memcpy(out, "TFB1", 4);
+  out[4] = type;
+  out[5] = format.depth;
+  putLE(out + 6, format.width, 2);
+  putLE(out + 8, format.height, 2);
+  putLE(out + 10, number, 2);
+  putLE(out + 12, payload, 4);
+
+  size_t size = FB_HEADER_BYTES + payload;
+  putLE(out + size, fbAdler32(out, size), 4);
+  return size + FB_CHECK_BYTES;
+}
+
+// Function to encode a key frame (whole buffer)
+size_t fbEncodeKey(const uint8_t *frame, const FbFormat &format, const uint16_t *palette, uint16_t number, uint8_t *out) {
+  uint8_t *payload = out + FB_HEADER_BYTES;
+  size_t n = 0;
+
+  if(format.depth == 4) {
+    for(int c=0; c<16; c++) {
+      putLE(payload + n, palette[c], 2);
+      n += 2;
+    }
+  }
+
+  n += fbPackBits(frame, fbBytes(format), format.depth == 16 ? 2 : 1, payload + n);
+  return finishFrame(out, FB_KEY, format, number, n);
+}
+
+// Function to encode the tiles that changed since the previous frame, which is updated
+// to match (returns 0 when nothing changed)
+size_t fbEncodeDelta(const uint8_t *frame, uint8_t *previous, const FbFormat &format, uint16_t number, uint8_t *out) {
+  size_t rowBytes = fbRowBytes(format);
+  size_t tileBytes = (size_t)FB_TILE * format.depth / 8;
+  int tilesX = (format.width + FB_TILE - 1) / FB_TILE;
+  int tilesY = (format.height + FB_TILE - 1) / FB_TILE;
+  uint8_t unit = format.depth == 16 ? 2 : 1;
+  uint8_t *payload = out + FB_HEADER_BYTES;
+  size_t mapBytes = (fbTiles(format) + 7) / 8;
+  size_t n = mapBytes;
+  int changedTiles = 0;
+  uint8_t tile[FB_TILE * FB_TILE * 2];
+
+  memset(payload, 0, mapBytes);
+
+  for(int ty=0; ty<tilesY; ty++) {
+    int y0 = ty * FB_TILE;
+    int rows = format.height - y0 < FB_TILE ? format.height - y0 : FB_TILE;
+
+    for(int tx=0; tx<tilesX; tx++) {
+      size_t x0 = tx * tileBytes;
+      size_t width = rowBytes - x0 < tileBytes ? rowBytes - x0 : tileBytes;
+      bool changed = false;
+
+      for(int y=y0; y<y0+rows && !changed; y++) {
+        changed = memcmp(frame + y * rowBytes + x0, previous + y * rowBytes + x0, width) != 0;
+      }
+
+      if(!changed) {
+        continue;
+      }
+
+      // Gather the tile rows, take them over as the previous frame and compress
+      for(int y=0; y<rows; y++) {
+        size_t offset = (y0 + y) * rowBytes + x0;
+        memcpy(tile + y * width, frame + offset, width);
+        memcpy(previous + offset, frame + offset, width);
+      }
+
+      int index = ty * tilesX + tx;
+      payload[index / 8] |= 1 << (index % 8);
+      n += fbPackBits(tile, rows * width, unit, payload + n);
+      changedTiles++;
+    }
+  }
+
+  return changedTiles > 0 ? finishFrame(out, FB_DELTA, format, number, n) : 0;
+}
@@ -0,0 +1,54 @@
+/*************************************************************
+********************* HEADLESS OPERATION *********************
+**************************************************************/
+
+#include <Arduino.h>
+#include "headless.h"
+#include "backlight.h"
+
+// Setting
+byte headlessMode = HEADLESS_OFF;
+
+// Frames on request
+static volatile bool frameRequested = false;
+static bool frameShown = false;  // a frame on request is lit
+static unsigned long shownTime = 0;
+
+
+// Function to apply the build option (call after the settings are read from EEPROM)
+void headlessBegin() {
+#ifdef HEADLESS
+  headlessMode = HEADLESS_ON; // boots headless whatever is stored
+#endif
+}
+
+// Function to hold the backlight off while headless (call every loop pass - returns true
+// when loop() is to draw nothing but frames on request)
+bool headlessService(bool menuOpen) {
+  bool headless = headlessMode != HEADLESS_OFF && !menuOpen;
+
+  if(frameShown && (!headless || millis() - shownTime >= HEADLESS_SHOW_MS)) {
+    frameShown = false;
+  }
+
+  backlightSuspend(headless && !frameShown);
+  return headless;
+}
+
+// Function to ask for one frame (button press, serial command)
+void headlessRequestFrame() {
+  frameRequested = true;
+}
+
+// Function to check if a frame was asked for - it is lit for HEADLESS_SHOW_MS
+bool headlessFrameDue() {
+  if(!frameRequested) {
+    return false;
+  }
+
+  frameRequested = false;
+  frameShown = true;
+  shownTime = millis();
+  backlightSuspend(false);
+  return true;
+}
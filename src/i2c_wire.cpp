@@ -0,0 +1,36 @@
+/*************************************************************
+************************ WIRE I2C BUS ************************
+**************************************************************/
+
+#include <Arduino.h>
+#include "i2c_wire.h"
+
+// Function to start the controller on the given pins
+void WireBus::begin(int sda, int scl, uint32_t frequency) {
+  wire.begin(sda, scl, frequency);
+}
+
+// Function to write bytes in one transaction
+bool WireBus::write(uint8_t address, const uint8_t *data, size_t length) {
+  wire.beginTransmission(address);
+  wire.write(data, length);
+  return wire.endTransmission() == 0;
+}
+
+// Function to read bytes in one transaction (register pointer, repeated start, read)
+bool WireBus::read(uint8_t address, const uint8_t *pointer, size_t pointerLength, uint8_t *buffer, size_t length) {
+  if(pointerLength > 0) {
+    wire.beginTransmission(address);
+    wire.write(pointer, pointerLength);
+
+    if(wire.endTransmission(false) != 0) {
+      return false;
+    }
+  }
+
+  if(wire.requestFrom((uint16_t)address, length, true) != length) {
+    return false;
+  }
+
+  return wire.readBytes(buffer, length) == length;
+}
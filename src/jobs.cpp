@@ -0,0 +1,104 @@
+/*************************************************************
+*********************** JOB SCHEDULER ************************
+**************************************************************/
+
+#include <Arduino.h>
+#include <esp_timer.h> // for the 64-bit time base
+#include "jobs.h"
+
+// Group periods - order must match JobRate
+const unsigned long jobPeriods[JOB_GROUPS] = {1000, 10000, 100000, 1000000};
+static const char *groupNames[JOB_GROUPS] = {"1kHz", "100Hz", "10Hz", "1Hz"};
+
+struct Job {
+  const char *name;
+  void (*function)();
+  byte group;
+  byte divider;
+  byte countdown;         // group ticks until the next run
+  unsigned long runs;
+  unsigned long totalMicros;
+  unsigned long maxMicros;
+};
+
+static Job jobs[JOBS_MAX];
+static int jobCount = 0;
+static int groupJobs[JOB_GROUPS];             // jobs per group (idle groups are not timed)
+static int64_t groupDue[JOB_GROUPS];          // next tick (us)
+static unsigned long groupSkipped[JOB_GROUPS]; // ticks missed because the group was late
+
+
+// Function to register a job (false when the table is full)
+bool jobAdd(const char *name, JobRate rate, void (*function)(), byte divider) {
+  if(jobCount >= JOBS_MAX) {
+    return false;
+  }
+
+  if(groupJobs[rate] == 0) {
+    groupDue[rate] = esp_timer_get_time(); // first tick on the next run
+  }
+
+  Job &job = jobs[jobCount++];
+  job.name = name;
+  job.function = function;
+  job.group = rate;
+  job.divider = max(divider, (byte)1);
+  job.countdown = 1;
+  job.runs = 0;
+  job.totalMicros = 0;
+  job.maxMicros = 0;
+  groupJobs[rate]++;
+
+  return true;
+}
+
+// Function to run the jobs of every group that is due (call from loop())
+void jobsRun() {
+  int64_t now = esp_timer_get_time();
+
+  for(int g=0; g<JOB_GROUPS; g++) {
+    if(groupJobs[g] == 0 || now < groupDue[g]) {
+      continue;
+    }
+
+    // Skip the ticks that were missed completely
+    int64_t late = now - groupDue[g];
+
+    if(late >= (int64_t)jobPeriods[g]) {
+      groupSkipped[g] += late / jobPeriods[g];
+      groupDue[g] += (late / jobPeriods[g]) * jobPeriods[g];
+    }
+
+    groupDue[g] += jobPeriods[g];
+
+    for(int j=0; j<jobCount; j++) {
+      Job &job = jobs[j];
+
+      if(job.group != g || --job.countdown > 0) {
+        continue;
+      }
+
+      job.countdown = job.divider;
+      int64_t start = esp_timer_get_time();
+      job.function();
+      unsigned long elapsed = esp_timer_get_time() - start;
+
+      job.runs++;
+      job.totalMicros += elapsed;
+      job.maxMicros = max(job.maxMicros, elapsed);
+    }
+  }
+}
+
+// Function to print the run-time accounting of every job
+void jobsReport(Print &out) {
+  out.print("Jobs:");
+
+  for(int j=0; j<jobCount; j++) {
+    const Job &job = jobs[j];
+    unsigned long average = job.runs > 0 ? job.totalMicros / job.runs : 0;
+    out.printf(" %s %s/%u %lux avg %lu max %lu us,", job.name, groupNames[job.group], job.divider, job.runs, average, job.maxMicros);
+  }
+
+  out.printf(" skipped 1kHz:%lu 100Hz:%lu 10Hz:%lu 1Hz:%lu\n", groupSkipped[0], groupSkipped[1], groupSkipped[2], groupSkipped[3]);
+}
@@ -6,12 +6,42 @@
 #include <Arduino.h>     // core Arduino library
 #include <EEPROM.h>      // for EEPROM storage
 #include <TFT_eSPI.h>    // for TFT display control
-#include <driver/adc.h>  // for ADC control
-#include "esp_adc_cal.h" // for ADC calibration
+#include <esp_timer.h>   // for the 64-bit uptime clock
 
 // Font header file
 #include "NotoSansBold15.h"
 
+// Project modules
+#include "pwm.h"     // PWM channel manager
+#include "servo.h"   // RMT servo and pulse-train outputs
+#include "touch_input.h" // capacitive touch inputs
+#include "capture.h" // MCPWM pulse-width capture inputs
+#include "headless.h" // operation without rendering
+#include "curves.h"  // PWM transfer curves
+#include "analog.h"  // calibrated ADC conversion
+#include "colours.h" // UI colours and sprite colour depth
+#include "placement.h" // memory placement policy and map
+#include "widgets.h" // pre-rendered widget stamps
+#include "trend.h"   // analog trend view
+#include "retain.h"  // runtime state retained across warm resets
+#include "modbus_slave.h" // Modbus RTU slave
+#include "scan.h"    // fixed-cycle scan and statistics
+#include "buttons.h" // button event service
+#include "signals.h" // signal table layout
+#include "compare.h" // analog threshold comparators
+#include "expander.h" // I2C GPIO expanders
+#include "i2c_wire.h" // I2C bus on the Wire controller
+#include "jobs.h"    // multi-rate housekeeping jobs
+#include "memstats.h" // heap and stack telemetry
+#include "timerblocks.h" // trigger-driven timer blocks
+#include "mirror.h"  // screen mirroring over USB serial
+#include "backlight.h" // idle dimming and screen off
+
+#ifdef FROZEN_CONFIG
+#include <utility>         // for the compile-time slot sequences
+#include "frozen_config.h" // frozen configuration tables (generated by tools/freeze_config.py)
+#endif
+
 /* 
 Create display and sprite objects:
  - lcd: Main display object
@@ -20,27 +50,25 @@ Create display and sprite objects:
 TFT_eSPI lcd = TFT_eSPI();
 TFT_eSprite sprite = TFT_eSprite(&lcd);
 
-#define EEPROM_SIZE 52 // size of EEPROM storage (was 48, need 4 more bytes for smoothing float)
-
-// Custom colours
-#define blue 0x297F      // converted from #2d2dff
-#define darkBlue 0x09CA  // converted from #083852
-#define green 0x13E3     // converted from #107C1B
-#define grey 0x3A08      // converted from #3B4143
-#define lightBlue 0x8E7F // converted from #8CCDFF
-#define offWhite 0xAD75  // converted from #ADADAD
-#define orange 0xE320    // converted from #E36600
-#define purple 0x38A8    // converted from #3A1442
-#define seaGreen 0x1A8B  // converted from #164f57
-
-// TFT_eSPI colours
-#define tftBlack TFT_BLACK
-#define tftRed TFT_RED
-#define tftMagenta TFT_MAGENTA
-#define tftWhite TFT_WHITE
-
-// Colour arrays for different UI elements
-unsigned short typeColours[5] = {orange, blue, green, purple, tftMagenta};
+#ifdef EXPANDER_ENABLE
+WireBus expanderBus(Wire); // I2C bus of the GPIO expanders
+#endif
+
+// Sprite placement (build flag -DSPRITE_PLACEMENT=MEM_BULK moves it to PSRAM)
+#ifndef SPRITE_PLACEMENT
+#define SPRITE_PLACEMENT MEM_FAST
+#endif
+
+#define EEPROM_SIZE 340 // size of EEPROM storage (types, sources, smoothing float, PWM presets, fades, curves, analog views, scan period, comparators, expander pins, timer blocks, servo & touch modes, screen idle, capture views, headless)
+
+// Palette for the 4-bit sprite (index order matches colours.h)
+const uint16_t spritePalette[16] = {
+  TFT_BLACK, 0x297F, 0x09CA, 0x13E3, 0x3A08, 0x8E7F, 0xAD75, 0xE320,
+  0x38A8, 0x1A8B, TFT_RED, TFT_MAGENTA, TFT_WHITE, 0x0514, 0x8400, TFT_BLACK
+};
+
+// Colour arrays for different UI elements (palette indices in 4-bit mode)
+unsigned short typeColours[PIN_TYPES] = {orange, blue, green, purple, tftMagenta, seaGreen, seaGreen, teal, olive};
 unsigned short pinColours[24] = {
   tftBlack, tftBlack, grey, grey, grey, grey, grey, grey, darkBlue, tftBlack, tftBlack, tftRed, tftRed,
   grey, grey, grey, grey, grey, grey, grey, darkBlue, darkBlue, tftBlack, tftRed
@@ -54,30 +82,30 @@ unsigned long timerIntervals[2][2] = {{1000, 500}, {300, 300}};
 // Pin configuration arrays
 //------------ {  G,   G, 43, 44, 18, 17, 21, 16,  NC,   G,   G,  3V,  3V, 1, 2, 3, 10, 11, 12, 13,  NC,  NC,  G,  5V)
 int pins[24] = {100, 100, 43, 44, 18, 17, 21, 16, 100, 100, 100, 100, 100, 1, 2, 3, 10, 11, 12, 13, 100, 100, 100, 100};
-int pinStates[28] = {0};
-int pinDebounce[28] = {0};
-
-// Button debouncing
-int debounce = 0;
-static unsigned long lastLeftButtonTime = 0;
-static unsigned long lastRightButtonTime = 0;
-const unsigned long debounceInterval = 50; // ms
+int pinStates[SIGNAL_COUNT] = {0};
+int pinDebounce[SIGNAL_COUNT] = {0};
+int pinMillivolts[24] = {0}; // calibrated analog pin voltages
+byte analogViews[24] = {0};  // analog pin display: 0 = 0-255, 1 = mV
 
 // Menu system variables
 int menu = 0;
 int item = 0;
 int selection = 0;
-int pwmChannel = 0;
 int menuTextX, menuTextY, selectorX, selectorY;
 int selectedTimerIndex = 3;
 int timerStateSelection = 3;
+int selectedComparator = 0;
+int selectedExpander = 0;
+int selectedBlock = 0;
+int selectedSlot = 0; // signal slot being configured in the menu
 
 // Menu pin mapping arrays
 int menuPins[18] = {50, 2, 3, 4, 5, 6, 7, 13, 14, 15, 16, 17, 18, 19, 24, 25, 26, 27};
-int menuPins2[18] = {0};
-int menuPins3[18] = {0};
-int menuPins4[18] = {0};
-int menuItems[11] = {6, 14, 7, 7, 3, 3, 4, 5, 5, 5, 13};
+int menuPins2[28] = {0};
+int menuPins3[28] = {0};
+int menuPins4[28] = {0};
+int menuPins5[28] = {0};
+int menuItems[37] = {14, 14, 10, 7, 3, 3, 5, 5, 5, 5, 13, 5, 5, 7, 2, 3, 6, 5, 1, 1, 25, 25, 3, 17, 4, 5, 5, 1, 9, 1, 4, 2, 4, 5, 1, 3, 2};
 
 // UI position variables
 int pinBoxX, pinBoxY, lineStartX, lineEndX, stateCircleX, sourceLabelX, valueDisplayX;
@@ -89,58 +117,97 @@ byte width = 24;
 byte height = 17;
 
 // Pin type configuration arrays
-byte pinTypes[28] = {0, 0, 0, 0, 2, 4, 0, 3, 0, 0, 0, 0, 0, 0, 0, 0, 3, 0, 3, 5, 0, 0, 0, 0, 1, 2, 6, 6};
-byte pinSources[28] = {100, 100, 100, 100, 100, 100, 100, 124, 100, 100, 100, 100, 100, 100, 100, 100, 25, 100, 26, 5, 100, 100, 100, 100, 100, 100};
+byte pinTypes[SIGNAL_COUNT] = {0, 0, 0, 0, 2, 4, 0, 3, 0, 0, 0, 0, 0, 0, 0, 0, 3, 0, 3, 5, 0, 0, 0, 0, 1, 2, 6, 6};
+byte pinSources[SIGNAL_COUNT] = {100, 100, 100, 100, 100, 100, 100, 124, 100, 100, 100, 100, 100, 100, 100, 100, 25, 100, 26, 5, 100, 100, 100, 100, 100, 100};
 
 // Timer configuration arrays
 byte timerBaseValues[4] = {250, 250, 150, 150}; 
 byte timerMultipliers[4] = {10, 10, 10, 10};
 byte timerSources[4] = {0};
+byte timerEnables[2] = {100, 100}; // signal that lets the timer run (100 = always)
 
 // Button state tracking
-bool pinButtonPressed[28] = {0};
-bool waitForButtonRelease = false;
-static bool leftButtonPressed = false;
-static bool rightButtonPressed = false;
-bool uiMode = 0;     // 0 = run mode, 1 = menu mode
+bool pinButtonPressed[SIGNAL_COUNT] = {0};
+byte uiMode = 0;     // 0 = run mode, 1 = menu mode, 2 = trend view, 3 = scan statistics, 4 = memory
 bool menuAction = 0; // prevents multiple menu actions
+bool menuRedraw = true; // menu entered - draw it even without a button event
 
 // Other variables
-unsigned long startTime = 0;       // device startup time
-unsigned long lastFrameTime = 0;   // for FPS calculation
+unsigned long frameCount = 0;      // frames drawn, for the FPS calculation
 float fps = 0;                     // current FPS value
-char uptimeString[9] = "00:00:00"; // HH:MM:SS uptime format
-unsigned long lastPowerRead = 0;   // for battery monitoring
-const unsigned long powerReadInterval = 5000; // 5sec
+char uptimeString[20] = "00:00:00"; // HH:MM:SS uptime format (hours keep counting past 99)
 int millivolts = 0;           // in mV
 float supplyVoltage = 0.0;    // in V
 float smoothingFactor = 0.05; // smoothing factor (default 0.05 - range 0.00 to 1.0)
+unsigned long pushMicros = 0; // time of the last pushSprite (us)
+unsigned long bootOutputsMicros = 0; // time from start to outputs driven (us)
+bool bootResumed = false;            // runtime state restored after a warm reset
+byte scanPeriodIndex = 0;            // scan cycle period (index into scanPeriods, 0 = free run)
 
 // Pin label string arrays
-String pinLabels1[28] = {
-  "G", "G", "43", "44", "18", "17", "21", "16", "NC", "G", "G", "3V", "3V", "1", "2", "3", "10", "11", "12", "13", "NC", "NC", "G", "5V", "0", "14", "T1", "T2"
+String pinLabels1[SIGNAL_COUNT] = {
+  "G", "G", "43", "44", "18", "17", "21", "16", "NC", "G", "G", "3V", "3V", "1", "2", "3", "10", "11", "12", "13", "NC", "NC", "G", "5V", "0", "14", "T1", "T2",
+  "C1", "C2", "C3", "C4",
+  "X0", "X1", "X2", "X3", "X4", "X5", "X6", "X7", "X8", "X9", "X10", "X11", "X12", "X13", "X14", "X15",
+  "X16", "X17", "X18", "X19", "X20", "X21", "X22", "X23", "X24", "X25", "X26", "X27", "X28", "X29", "X30", "X31",
+  "D1", "D2", "D3", "D4"
 };
-String pinLabels2[28] = {
-  "G", "G", "43", "44", "18", "17", "21", "16", "NC", "G", "G", "3V", "3V", "1", "2", "3", "10", "11", "12", "13", "NC", "NC", "G", "5V", "PB1", "PB2", "T1", "T2"
+String pinLabels2[SIGNAL_COUNT] = {
+  "G", "G", "43", "44", "18", "17", "21", "16", "NC", "G", "G", "3V", "3V", "1", "2", "3", "10", "11", "12", "13", "NC", "NC", "G", "5V", "PB1", "PB2", "T1", "T2",
+  "C1", "C2", "C3", "C4",
+  "X0", "X1", "X2", "X3", "X4", "X5", "X6", "X7", "X8", "X9", "X10", "X11", "X12", "X13", "X14", "X15",
+  "X16", "X17", "X18", "X19", "X20", "X21", "X22", "X23", "X24", "X25", "X26", "X27", "X28", "X29", "X30", "X31",
+  "D1", "D2", "D3", "D4"
 };
-String pinTypeLabels[5] = {"INP", "SW", "OUT", "ANA", "PWM"};
+String pinTypeLabels[PIN_TYPES] = {"INP", "SW", "OUT", "ANA", "PWM", "TMR", "SRV", "TCH", "CAP"};
 
 // Menu system string arrays
-String menuTitles[11] = {
-  "MENU", "SELECT PIN", "SELECT TYPE", "SET SOURCE", "PWM", "SET TIMERS", "", "", "MULTIPLIER", "BRIGHTNESS", "SMOOTHING"
+String menuTitles[37] = {
+  "MENU", "SELECT PIN", "SELECT TYPE", "SET SOURCE", "PWM", "SET TIMERS", "", "", "MULTIPLIER", "BRIGHTNESS", "SMOOTHING", "PWM FREQ", "PWM FADE",
+  "PWM CURVE", "ANALOG VIEW", "TREND", "SCAN CYCLE", "COMPARATORS", "ENABLE", "C SOURCE", "ON ABOVE", "OFF BELOW",
+  "EXPANDERS", "EXP PIN", "EXP TYPE", "TIMER BLOCKS", "MODE", "TRIGGER", "TIME", "SCALE BY", "SERVO MODE",
+  "TOUCH MODE", "THRESHOLD", "DIM / OFF", "WAKE INPUT", "CAPTURE VIEW", "HEADLESS"
 };
-String firstMenu[11][28] = {
-  {"EXIT", "Reset All", "Set Pin", "Set Timer", "Brightness", "Smoothing", "", "", "", "", "", "", "", "", "", "", "", "", "", "", "", "", "", "", "", "", "", ""},
+String firstMenu[37][28] = {
+  {"EXIT", "Reset All", "Set Pin", "Set Timer", "Brightness", "Smoothing", "Trend", "Scan Cycle", "Comparators", "Expanders", "Memory", "Timer Blocks", "Screen Idle", "Headless", "", "", "", "", "", "", "", "", "", "", "", "", "", ""},
   {"BACK", "43", "44", "18", "17", "21", "16", "1", "2", "3", "10", "11", "12", "13", "PB1", "PB2", "T1", "T2", "", "", "", "", "", "", "", "", "", ""},
-  {"BACK", "NOT SET", "INP_PULLUP", "ON/OFF SW", "OUTPUT", "ANALOG ", "PWM", "", "", "", "", "", "", "", "", "", "", "", "", "", "", "", "", "", "", "", "", ""},
+  {"BACK", "NOT SET", "INP_PULLUP", "ON/OFF SW", "OUTPUT", "ANALOG ", "PWM", "SERVO", "TOUCH", "CAPTURE", "", "", "", "", "", "", "", "", "", "", "", "", "", "", "", "", "", ""},
   {"HIGH", "LOW", "T1", "!T1", "T2", "!T2", "PB1", "!PB1", "PB2", "!PB2", "9", "9", "9", "9", "9", "9", "9", "10", "", "", "", "", "", "", "", "", "", ""},
   {"50", "100", "150"},
   {"BACK", "SET T1", "SET T2"},
-  {"BACK", "ON TIME", "OFF TIME", "MULTIPLIER"},
+  {"BACK", "ON TIME", "OFF TIME", "MULTIPLIER", "ENABLE"},
   {"1", "50", "100", "150", "250"},
   {"1", "10", "100", "200", "250"},
   {"50", "100", "150", "200", "250"},
-  {"BACK", "0.01", "0.05", "0.1", "0.2", "0.3", "0.4", "0.5", "0.6", "0.7", "0.8", "0.9", "1.0"}
+  {"BACK", "0.01", "0.05", "0.1", "0.2", "0.3", "0.4", "0.5", "0.6", "0.7", "0.8", "0.9", "1.0"},
+  {"5kHz 8bit", "1kHz 10bit", "20kHz 8bit", "50Hz 14bit", "40kHz 10bit"}, // order matches pwmPresetFrequencies
+  {"OFF", "50ms", "200ms", "500ms", "1000ms"},                             // order matches pwmFadeTimes
+  {"LINEAR", "GAMMA 2.2", "GAMMA 2.8", "INVERT", "DEADBAND", "CLAMP 20-80", "S-CURVE"}, // order matches curveSpecs
+  {"0-255", "mV"},
+  {"BACK", "ROLL", "TRIGGER"},
+  {"BACK", "FREE RUN", "1 ms", "5 ms", "10 ms", "STATS"}, // order matches scanPeriods
+  {"BACK", "C1", "C2", "C3", "C4"},                        // labels filled in by listComparators()
+  {"ALWAYS"},                                              // filled in by findEnables()
+  {"OFF"},                                                 // filled in by findCompareAnalogs()
+  {"10", "20", "30", "40", "50", "60", "70", "80", "90", "100", "110", "120", "130", "140", "150", "160", "170", "180",
+   "190", "200", "210", "220", "230", "240", "250"},
+  {"10", "20", "30", "40", "50", "60", "70", "80", "90", "100", "110", "120", "130", "140", "150", "160", "170", "180",
+   "190", "200", "210", "220", "230", "240", "250"},
+  {"BACK", "E1", "E2"},                                    // labels filled in by listExpanders()
+  {"BACK"},                                                // filled in by listExpanderPins()
+  {"BACK", "NOT SET", "INPUT", "OUTPUT"},
+  {"BACK", "D1", "D2", "D3", "D4"},                        // labels filled in by listTimerBlocks()
+  {"OFF", "ON DELAY", "OFF DELAY", "PULSE", "RETRIGGER"},  // order matches the BLOCK_ modes
+  {"PB1"},                                                 // filled in by findTriggers()
+  {"100ms", "250ms", "500ms", "1s", "2s", "5s", "10s", "30s", "60s"}, // order matches blockPresetTimes
+  {"FIXED"},                                               // filled in by findBlockAnalogs()
+  {"SERVO", "BURST 10", "BURST 100", "BURST 1000"},        // order matches servoBurstCounts
+  {"MOMENTARY", "TOGGLE"},                                 // order matches the TOUCH_ modes
+  {"5%", "10%", "20%", "40%"},                             // order matches touchPercents
+  {"ALWAYS ON", "30s / 2m", "1m / 5m", "5m / 15m", "15m / 1h"}, // order matches backlightDimTimes
+  {"BUTTONS"},                                             // filled in by findWakeInputs()
+  {"DUTY", "HIGH us", "PERIOD us"},                        // order matches the CAPTURE_VIEW_ values
+  {"OFF", "ON"}                                            // order matches the HEADLESS_ modes
 };
 
 
@@ -148,13 +215,59 @@ String firstMenu[11][28] = {
 ********************** HELPER FUNCTIONS **********************
 **************************************************************/
 
+// Function to select the label font (smooth font, or built-in font 2 with a palette)
+void smoothFont() {
+#if SPRITE_DEPTH == 4
+  sprite.setTextFont(2);
+#else
+  sprite.loadFont(NotoSansBold15);
+#endif
+}
+
+// Function to return to the default text font
+void plainFont() {
+#if SPRITE_DEPTH == 4
+  sprite.setTextFont(1);
+#else
+  sprite.unloadFont();
+#endif
+}
+
+// Function to push the sprite to the display and time the transfer
+void pushFrame() {
+  static bool firstFrame = true;
+  unsigned long pushStart = micros();
+  sprite.pushSprite(0, 0);
+  pushMicros = micros() - pushStart;
+
+  if(firstFrame) { // boot instrumentation
+    firstFrame = false;
+    Serial.printf("Boot: outputs valid at %lu us, first frame at %lu us (%s)\n",
+                  bootOutputsMicros, micros(), bootResumed ? "warm restart resumed" : "cold start");
+  }
+}
+
+// Function to create the framebuffer sprite at the configured colour depth and placement
+void createFramebuffer(MemoryPolicy placement) {
+  sprite.setColorDepth(SPRITE_DEPTH);
+  sprite.setAttribute(PSRAM_ENABLE, memPrefersPsram(placement)); // TFT_eSPI picks PSRAM by default
+  sprite.createSprite(170, 320); // portrait mode
+  widgetsInvalidate();           // stamps follow the sprite colour depth
+
+#if SPRITE_DEPTH == 4
+  sprite.createPalette(spritePalette, 16);
+#endif
+
+  Serial.printf("Sprite: 170x320 %d bpp, %u bytes in %s\n", SPRITE_DEPTH, 170 * 320 * SPRITE_DEPTH / 8, memRegion(sprite.getPointer()));
+}
+
 // Function to read pin configurations from EEPROM
 void readEprom() {
   for(int i=0; i<24; i++) {
     pinTypes[i] = EEPROM.read(i);
 
-    if(pinTypes[i]>5) {
-      pinTypes[i] = 0; // reset invalid types
+    if(pinTypes[i]>9 || pinTypes[i]==6) {
+      pinTypes[i] = 0; // reset invalid types (6 is the T1/T2 type)
     }
   }
 
@@ -162,9 +275,114 @@ void readEprom() {
     pinSources[j] = EEPROM.read(j+24);
   }
 
+  for(int k=0; k<24; k++) {
+    pwmPresets[k] = EEPROM.read(k+52);
+    pwmFades[k] = EEPROM.read(k+76);
+    pwmCurves[k] = EEPROM.read(k+100);
+    analogViews[k] = EEPROM.read(k+124);
+    servoModes[k] = EEPROM.read(k+241);
+    touchModes[k] = EEPROM.read(k+265);
+    touchLevels[k] = EEPROM.read(k+289);
+    captureViews[k] = EEPROM.read(k+315);
+
+    if(pwmPresets[k] >= PWM_PRESETS) {
+      pwmPresets[k] = 0; // reset invalid presets (default 5kHz 8bit)
+    }
+
+    if(pwmFades[k] >= PWM_FADES) {
+      pwmFades[k] = 0; // reset invalid fades (default off)
+    }
+
+    if(pwmCurves[k] >= CURVE_COUNT) {
+      pwmCurves[k] = 0; // reset invalid curves (default linear)
+    }
+
+    if(analogViews[k] >= ANALOG_VIEWS) {
+      analogViews[k] = 0; // reset invalid views (default 0-255)
+    }
+
+    if(servoModes[k] >= SERVO_MODES) {
+      servoModes[k] = SERVO_PULSE; // reset invalid modes (default servo)
+    }
+
+    if(touchModes[k] >= TOUCH_MODES) {
+      touchModes[k] = TOUCH_MOMENTARY; // reset invalid modes (default momentary)
+    }
+
+    if(touchLevels[k] >= TOUCH_LEVELS) {
+      touchLevels[k] = 1; // reset invalid thresholds (default 10%)
+    }
+  }
+
+  scanPeriodIndex = EEPROM.read(148);
+
+  for(int c=0; c<COMPARATORS; c++) {
+    comparatorSources[c] = EEPROM.read(c+149);
+    comparatorOn[c] = EEPROM.read(c+153);
+    comparatorOff[c] = EEPROM.read(c+157);
+
+    if(comparatorSources[c] >= 24) {
+      comparatorSources[c] = COMPARATOR_OFF; // reset invalid sources (default off)
+    }
+  }
+
+  if(scanPeriodIndex >= SCAN_PERIODS) {
+    scanPeriodIndex = 0; // reset invalid periods (default free run)
+  }
+
+  for(int x=0; x<EXPANDERS * EXPANDER_PINS; x++) {
+    pinTypes[SIGNAL_EXPANDERS+x] = EEPROM.read(x+161);
+    pinSources[SIGNAL_EXPANDERS+x] = EEPROM.read(x+193);
+
+    if(pinTypes[SIGNAL_EXPANDERS+x] != 1 && pinTypes[SIGNAL_EXPANDERS+x] != 3) {
+      pinTypes[SIGNAL_EXPANDERS+x] = 0; // expander pins are INP, OUT or not set
+      pinSources[SIGNAL_EXPANDERS+x] = 100;
+    }
+  }
+
+  for(int b=0; b<TIMER_BLOCKS; b++) {
+    blockModes[b] = EEPROM.read(b+225);
+    blockTriggers[b] = EEPROM.read(b+229);
+    blockPresets[b] = EEPROM.read(b+233);
+    blockTimeSources[b] = EEPROM.read(b+237);
+
+    if(blockModes[b] >= BLOCK_MODES) {
+      blockModes[b] = BLOCK_OFF; // reset invalid modes (default off)
+    }
+
+    if(blockTriggers[b] == 100 || blockTriggers[b] >= 100 + SIGNAL_COUNT || (blockTriggers[b] >= SIGNAL_COUNT && blockTriggers[b] < 100)) {
+      blockTriggers[b] = 100; // reset invalid triggers (no trigger, block off)
+      blockModes[b] = BLOCK_OFF;
+    }
+
+    if(blockPresets[b] >= BLOCK_PRESETS) {
+      blockPresets[b] = 3; // reset invalid presets (default 1s)
+    }
+
+    if(blockTimeSources[b] >= 24) {
+      blockTimeSources[b] = BLOCK_FIXED; // reset invalid time sources (default preset only)
+    }
+  }
+
+  backlightIdle = EEPROM.read(313);
+  backlightWake = EEPROM.read(314);
+  headlessMode = EEPROM.read(339);
+
+  if(backlightIdle >= BACKLIGHT_IDLE_OPTIONS) {
+    backlightIdle = 0; // reset invalid idle options (default always on)
+  }
+
+  if(backlightWake >= SIGNAL_COUNT) {
+    backlightWake = BACKLIGHT_NO_WAKE; // reset invalid wake signals (default buttons only)
+  }
+
+  if(headlessMode >= HEADLESS_MODES) {
+    headlessMode = HEADLESS_OFF; // reset invalid modes (default display on)
+  }
+
   smoothingFactor = EEPROM.readFloat(48);
   
-  if(smoothingFactor == 0xFF) { // first time use
+  if(!(smoothingFactor >= 0.0f && smoothingFactor <= 1.0f)) { // first time use (erased flash reads as NaN)
     smoothingFactor = 0.05;     // set default
     EEPROM.writeFloat(48, smoothingFactor);
     EEPROM.commit();
@@ -172,60 +390,190 @@ void readEprom() {
 }
 
 // Function to write pin configurations to EEPROM
+// (EEPROM.write only marks changed bytes, so a single commit rewrites flash only when needed)
 void writeEprom() {
   for(int i=0; i<24; i++) {
     EEPROM.write(i, pinTypes[i]);
-    EEPROM.commit();
   }
 
   for(int j=0; j<24; j++) {
     EEPROM.write(j+24, pinSources[j]);
-    EEPROM.commit();
   }
 
+  for(int k=0; k<24; k++) {
+    EEPROM.write(k+52, pwmPresets[k]);
+    EEPROM.write(k+76, pwmFades[k]);
+    EEPROM.write(k+100, pwmCurves[k]);
+    EEPROM.write(k+124, analogViews[k]);
+    EEPROM.write(k+241, servoModes[k]);
+    EEPROM.write(k+265, touchModes[k]);
+    EEPROM.write(k+289, touchLevels[k]);
+    EEPROM.write(k+315, captureViews[k]);
+  }
+
+  EEPROM.write(148, scanPeriodIndex);
+
+  for(int x=0; x<EXPANDERS * EXPANDER_PINS; x++) {
+    EEPROM.write(x+161, pinTypes[SIGNAL_EXPANDERS+x]);
+    EEPROM.write(x+193, pinSources[SIGNAL_EXPANDERS+x]);
+  }
+
+  for(int c=0; c<COMPARATORS; c++) {
+    EEPROM.write(c+149, comparatorSources[c]);
+    EEPROM.write(c+153, comparatorOn[c]);
+    EEPROM.write(c+157, comparatorOff[c]);
+  }
+
+  for(int b=0; b<TIMER_BLOCKS; b++) {
+    EEPROM.write(b+225, blockModes[b]);
+    EEPROM.write(b+229, blockTriggers[b]);
+    EEPROM.write(b+233, blockPresets[b]);
+    EEPROM.write(b+237, blockTimeSources[b]);
+  }
+
+  EEPROM.write(313, backlightIdle);
+  EEPROM.write(314, backlightWake);
+  EEPROM.write(339, headlessMode);
   EEPROM.writeFloat(48, smoothingFactor);
   EEPROM.commit();
 }
 
-// Function to detach a pin and reset it's configuration
+// Function to reset the configuration of pins sourced from a pin (hardware is updated by setupPins)
 void detach(int pin) {
-  for(int i=0; i<24; i++) {
+  for(int i=0; i<SIGNAL_TIMER_BLOCKS; i++) {
+    if(i == SIGNAL_PB1) {
+      i = SIGNAL_EXPANDERS; // only header and expander pins have sources
+    }
+
     if(pinSources[i] == pin) {
       pinTypes[i] = 0;
       pinSources[i] = 100;
-      pinMode(pin, OUTPUT);
-      digitalWrite(pin, 0);
     }
   }
 }
 
-// Function to initialize pins based on their configured types
-void setupPins() {
-  int nextPwmChannel = 1;
+#ifdef FROZEN_CONFIG
+bool frozenActive = false; // live configuration matches the frozen one
 
+// Function to check if the live configuration is the frozen one
+bool frozenMatches() {
+  for(int i=0; i<SIGNAL_TIMER_BLOCKS; i++) {
+    bool sourced = pinTypes[i] == 3 || pinTypes[i] == 5 || pinTypes[i] == 7;
+
+    if(pinTypes[i] != frozenTypes[i] || (sourced && pinSources[i] != frozenSources[i])) {
+      return false;
+    }
+
+    if(pinTypes[i] == 7 && servoModes[i] != frozenServoModes[i]) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// Function to store the frozen image as the configuration (only changed bytes reach flash)
+void frozenInstall() {
+  static_assert(sizeof(frozenImage) >= EEPROM_SIZE, "frozen image is older than the EEPROM layout");
+
+  for(int a=0; a<EEPROM_SIZE; a++) {
+    EEPROM.write(a, frozenImage[a]);
+  }
+
+  EEPROM.commit();
+}
+#endif
+
+// Function to apply the pin configuration to the hardware
+// Only pins whose type changed since the last call are reconfigured, all other pins keep
+// their live state. Returns the number of reconfigured pins.
+int setupPins() {
+  static bool pinsApplied = false; // first call (boot) configures every pin
+  static byte appliedTypes[24];
+  bool changed[24];
+  int changedPins = 0;
+
+  // Release pins whose type changed (frees their PWM channels first)
   for(int i=0; i<24; i++) {
-    if(pinTypes[i] == 1 || pinTypes[i] == 2) { // input pullup or switch
-      pinMode(pinLabels1[i].toInt(), INPUT_PULLUP);
+    if(modbusOwnsPin(pins[i]) || expanderOwnsPin(pins[i])) { // UART pin of the Modbus slave, expander bus pin
+      pinTypes[i] = 0;
+      pinSources[i] = 100;
     }
 
-    if(pinTypes[i] == 3) { // output
-      pinMode(pinLabels1[i].toInt(), OUTPUT);
+    changed[i] = pins[i] != 100 && (!pinsApplied || pinTypes[i] != appliedTypes[i]);
+
+    if(changed[i]) {
+      pwmDetach(i);
+      servoDetach(i);
+      touchInputDetach(i);
+      captureDetach(i);
+      pinStates[i] = 0;
+      pinButtonPressed[i] = 0;
+      pinDebounce[i] = 0;
+      changedPins++;
+    }
+  }
+
+  for(int i=0; i<24; i++) {
+    if(changed[i]) {
+      if(pinTypes[i] == 0 && pinsApplied) { // not set - park as output low
+        pinMode(pins[i], OUTPUT);
+        digitalWrite(pins[i], 0);
+      }
+
+      if(pinTypes[i] == 1 || pinTypes[i] == 2) { // input pullup or switch
+        pinMode(pins[i], INPUT_PULLUP);
+      }
+
+      if(pinTypes[i] == 3) { // output
+        pinMode(pins[i], OUTPUT);
+      }
+
+      appliedTypes[i] = pinTypes[i];
+    }
+
+    // PWM - new pins, changed settings (channel kept when possible) and fallback pins retrying
+    if(pinTypes[i] == 5) {
+      pwmAttach(i, pins[i]);
+    }
+
+    // Servo/pulse train - new pins, mode changes and pins still waiting for an RMT channel
+    if(pinTypes[i] == 7) {
+      servoAttach(i, pins[i]);
+    }
+
+    // Touch - new pins and threshold changes (pins without a touch channel are not set)
+    if(pinTypes[i] == 8 && !touchInputAttach(i, pins[i])) {
+      pinTypes[i] = 0;
+      appliedTypes[i] = 0;
     }
 
-    if(pinTypes[i] == 5) { // PWM
-      ledcSetup(nextPwmChannel, 5000, 8);
-      ledcAttachPin(pinLabels1[i].toInt(), nextPwmChannel); 
-      nextPwmChannel++;
+    // Capture - new pins and pins still waiting for a capture channel
+    if(pinTypes[i] == 9) {
+      captureAttach(i, pins[i]);
     }
   }
+
+  pinsApplied = true;
+  changedPins += expanderConfigure(&pinTypes[SIGNAL_EXPANDERS]); // directions applied by the next scan
+  retainConfigure(); // retained state now belongs to this configuration
+
+#ifdef FROZEN_CONFIG
+  frozenActive = frozenMatches(); // edited away from the frozen configuration - generic scan
+#endif
+
+  if(changedPins > 0) {
+    widgetsInvalidate(); // configuration changed - redraw widget stamps
+  }
+
+  return changedPins;
 }
 
-// Function to read and process all pin states
-void readPins() {
-  static int smoothedValues[28] = {0}; // smoothed analog values
-  static unsigned long lastModeToggleTime = 0;
-  pwmChannel = 1;
+// Smoothed analog values (raw 0-4095 << 8), shared by the generic and the frozen scan
+static int smoothedValues[26] = {0};
 
+// Function to take the timer base values from their source pins and calculate the intervals
+void updateTimerIntervals() {
   // Update timer base values if sources are set
   for(int i=0; i<4; i++) {
     if(timerSources[i] != 0) {
@@ -238,31 +586,50 @@ void readPins() {
   timerIntervals[0][1] = timerBaseValues[1] * timerMultipliers[1];
   timerIntervals[1][0] = timerBaseValues[2] * timerMultipliers[2];
   timerIntervals[1][1] = timerBaseValues[3] * timerMultipliers[3];
+}
 
-  // Check for UI mode toggle (both buttons pressed)
-  if(digitalRead(0) == 0 && digitalRead(14) == 0) {
-    if(debounce == 0 && millis() - lastModeToggleTime > 200) {
-        debounce = 1; 
-        uiMode = !uiMode;
-        waitForButtonRelease = true;
-        lastModeToggleTime = millis();
+// Function to read and process all pin states
+// Inputs are snapshot first, then the logic is evaluated on that snapshot and the outputs
+// are committed last, so every output in a scan sees the same input values
+void readPins() {
+  static int rawInputs[26] = {0};      // input snapshot of this scan
+  static int gpios[26];                // GPIO of each slot (from the pin labels)
+  static bool gpiosFound = false;
+  int smoothingAlpha = smoothingFactor * 256; // fixed-point smoothing factor (0-256)
+
+  if(!gpiosFound) {
+    for(int i=0; i<26; i++) {
+      gpios[i] = pinLabels1[i].toInt();
     }
+
+    gpiosFound = true;
   }
-  else {
-    // Only reset debounce when both buttons are released
-    if(digitalRead(0) == 1 && digitalRead(14) == 1) {
-        debounce = 0;
+
+  updateTimerIntervals();
+
+  // Snapshot inputs
+  for(int i=0; i<26; i++) {
+    if(pinTypes[i] == 1 || pinTypes[i] == 2) { // input pullup or switch
+      rawInputs[i] = digitalRead(gpios[i]);
+    }
+
+    if(pinTypes[i] == 4) { // analog input
+      rawInputs[i] = analogRead(gpios[i]);
     }
   }
 
-  // Read and process each pin
+  expanderReadInputs(pinStates); // one burst read per expander (INP slots only)
+  touchInputsRead(pinStates);    // queued touch events (TOUCH slots only)
+  captureInputsRead(pinStates);  // last measured cycles (CAPTURE slots only)
+
+  // Evaluate inputs
   for(int i=0; i<26; i++) {
     if(pinTypes[i] == 1) { // if pin is input pullup
-      pinStates[i] = digitalRead(pinLabels1[i].toInt());
+      pinStates[i] = rawInputs[i];
     }
 
     if(pinTypes[i] == 2) { // if pin is switch
-      if(digitalRead(pinLabels1[i].toInt()) == 0) {
+      if(rawInputs[i] == 0) {
         if(pinDebounce[i] == 0) {
           pinDebounce[i] = 1;
           pinButtonPressed[i] =! pinButtonPressed[i];
@@ -274,6 +641,26 @@ void readPins() {
       }
     }
 
+    if(pinTypes[i] == 4) { // analog input (smoothed, integer only)
+      smoothedValues[i] += ((rawInputs[i] << 8) - smoothedValues[i]) * smoothingAlpha >> 8;
+      int smoothedRaw = smoothedValues[i] >> 8;
+      pinStates[i] = smoothedRaw >> 4; // 0-4095 -> 0-255
+      pinMillivolts[i] = analogMillivolts(gpios[i], smoothedRaw);
+    }
+  }
+
+  // Evaluate comparators on this scan's analog values
+  comparatorsEvaluate(pinStates);
+
+  // Timer blocks on this scan's inputs (only edges and expired deadlines do any work)
+  timerBlocksEvaluate(pinStates);
+
+  // Evaluate outputs
+  for(int i=0; i<SIGNAL_TIMER_BLOCKS; i++) {
+    if(i == SIGNAL_PB1) {
+      i = SIGNAL_EXPANDERS; // skip buttons, timers and comparators
+    }
+
     if(pinTypes[i] == 3 && pinSources[i] != 100) {   // output with source
       if(pinSources[i] > 100 && pinSources[i] < 200) { // inverted source
         pinStates[i] =! pinStates[pinSources[i] - 100];
@@ -286,100 +673,1344 @@ void readPins() {
       if(pinSources[i] >= 200) { // fixed value
         pinStates[i] = pinSources[i] - 200;
       }
-
-      digitalWrite(pinLabels1[i].toInt(),pinStates[i]);
     }
 
-    if(pinTypes[i] == 4) { // analog input (smoothed)
-      int rawValue = analogRead(pinLabels1[i].toInt());
-      smoothedValues[i] = smoothedValues[i] * (1.0 - smoothingFactor) + rawValue * smoothingFactor;
-      pinStates[i] = map(smoothedValues[i], 0, 4095, 0, 255);
-    }
-
-    if(pinTypes[i] == 5) { // PWM output
+    if(pinTypes[i] == 5 && pinSources[i] != 100) { // PWM output with source
       if(pinSources[i] > 100) { // fixed value
         pinStates[i] = pinSources[i] - 100;
       }
       else { // source value
         pinStates[i] = pinStates[pinSources[i]];
       }
-      ledcWrite(pwmChannel, pinStates[i]);
-      pwmChannel++;
+    }
+
+    if(pinTypes[i] == 7 && pinSources[i] != 100) { // servo (value as PWM) or burst (trigger as OUT)
+      if(pinSources[i] > 100 && (servoModes[i] == SERVO_PULSE || pinSources[i] >= 200)) { // fixed value
+        pinStates[i] = servoModes[i] == SERVO_PULSE ? pinSources[i] - 100 : pinSources[i] - 200;
+      }
+      else if(pinSources[i] > 100) { // inverted trigger
+        pinStates[i] = pinStates[pinSources[i] - 100] == 0;
+      }
+      else { // source value
+        pinStates[i] = pinStates[pinSources[i]];
+      }
     }
   }
-}
 
-// Function to reset all pin configurations
-void clearPins() {
+  // Commit outputs
   for(int i=0; i<24; i++) {
-    pinTypes[i] = 0;
-    pinSources[i] = 100;
+    if(pinTypes[i] == 3 && pinSources[i] != 100) {
+      digitalWrite(gpios[i], pinStates[i]);
+    }
+
+    if(pinTypes[i] == 5) {
+      pwmWrite(i, pinStates[i]); // only written on change
+    }
 
-    if(pins[i] != 100) {
-      pinMode(pins[i], OUTPUT);
-      digitalWrite(pins[i], 0);
+    if(pinTypes[i] == 7) {
+      servoWrite(i, pinStates[i]); // hardware-timed, only touched on change
     }
   }
+
+  expanderWriteOutputs(pinStates); // changed expander outputs in one write each
+
+  trendSample(); // add the new values to the analog history
 }
 
-// Function to find all input pins for menu system
-void findInputs() {
-  int n = 10;
+#ifdef FROZEN_CONFIG
+// Frozen scan - the configuration tables of frozen_config.h are constexpr, so every slot
+// below compiles to the operations of its type and source only (no dispatch on pinTypes[]
+// or decoding of pinSources[] at run time). Used while the live configuration matches.
 
-  for(int i=0; i<24; i++) {
-    if(pinTypes[i] == 1 || pinTypes[i] == 2) {
-      menuPins2[n] = i;
-      firstMenu[3][n] = pinLabels1[i];
-      n++;
-      menuPins2[n] = i;
-      firstMenu[3][n] = "!" + pinLabels1[i];
-      n++;
+// Function to check if a frozen slot has a given type
+constexpr bool frozenUses(byte type, int first, int last) {
+  for(int i=first; i<last; i++) {
+    if(frozenTypes[i] == type) {
+      return true;
     }
   }
 
-  menuItems[3] = n;
+  return false;
 }
 
-// Function to find all analog pins for menu system
-void findMainAnalogs() {
-  int m = 3;
-  menuItems[4] = 3;
+// GPIO of each input slot (pins[] plus the PB1/PB2 buttons)
+constexpr int frozenGpios[26] = {100, 100, 43, 44, 18, 17, 21, 16, 100, 100, 100, 100, 100, 1, 2, 3, 10, 11, 12, 13, 100, 100, 100, 100, 0, 14};
 
-  for(int i = 0; i < 24; i++) {
-    if(pinTypes[i] == 4) {
-      firstMenu[4][m] = "PIN " + pinLabels1[i];
-      menuPins3[m] = i;
-      m++;
+// Function to snapshot the input of a slot
+template<int I> inline void frozenSnapshot(int *raw) {
+  if constexpr (frozenTypes[I] == 1 || frozenTypes[I] == 2) { // input pullup or switch
+    raw[I] = digitalRead(frozenGpios[I]);
+  }
+  else if constexpr (frozenTypes[I] == 4) { // analog input
+    raw[I] = analogRead(frozenGpios[I]);
+  }
+}
+
+// Function to evaluate the input of a slot
+template<int I> inline void frozenInput(const int *raw, int smoothingAlpha) {
+  if constexpr (frozenTypes[I] == 1) {
+    pinStates[I] = raw[I];
+  }
+  else if constexpr (frozenTypes[I] == 2) {
+    if(raw[I] == 0) {
+      if(pinDebounce[I] == 0) {
+        pinDebounce[I] = 1;
+        pinButtonPressed[I] =! pinButtonPressed[I];
+        pinStates[I] = pinButtonPressed[I];
+      }
+    }
+    else {
+      pinDebounce[I] = 0;
     }
   }
-  menuItems[4] = m;
+  else if constexpr (frozenTypes[I] == 4) {
+    smoothedValues[I] += ((raw[I] << 8) - smoothedValues[I]) * smoothingAlpha >> 8;
+    int smoothedRaw = smoothedValues[I] >> 8;
+    pinStates[I] = smoothedRaw >> 4;
+    pinMillivolts[I] = analogMillivolts(frozenGpios[I], smoothedRaw);
+  }
 }
 
-// Function to find all analog pins for timer menu
-void findTimerAnalogs() {
-  int m = 5;
-  menuItems[7] = m;
+// Function to evaluate the output of a slot from its source
+template<int I> inline void frozenOutput() {
+  constexpr byte type = frozenTypes[I];
+  constexpr byte source = frozenSources[I];
 
-  for(int i = 0; i < 24; i++) {
-    if(pinTypes[i] == 4) {
-      firstMenu[7][m] = "PIN " + pinLabels1[i];
-      menuPins4[m] = i;
-      m++;
+  if constexpr (type == 3 && source != 100) {
+    if constexpr (source > 100 && source < 200) { // inverted source
+      pinStates[I] =! pinStates[source - 100];
+    }
+    else if constexpr (source < 100) { // direct source
+      pinStates[I] = pinStates[source];
+    }
+    else { // fixed value
+      pinStates[I] = source - 200;
+    }
+  }
+  else if constexpr (type == 5 && source != 100) {
+    if constexpr (source > 100) { // fixed value
+      pinStates[I] = source - 100;
+    }
+    else {
+      pinStates[I] = pinStates[source];
+    }
+  }
+  else if constexpr (type == 7 && source != 100) {
+    constexpr bool pulse = frozenServoModes[I] == SERVO_PULSE;
+
+    if constexpr (source > 100 && (pulse || source >= 200)) { // fixed value
+      pinStates[I] = pulse ? source - 100 : source - 200;
+    }
+    else if constexpr (source > 100) { // inverted trigger
+      pinStates[I] = pinStates[source - 100] == 0;
+    }
+    else {
+      pinStates[I] = pinStates[source];
     }
   }
-  menuItems[7] = m;
 }
 
-// Function to draw and handle the menu system
-void setPins() {
-  static unsigned long lastActionTime = 0;
-  menuAction = 0;
+// Function to commit the output of a header slot
+template<int I> inline void frozenCommit() {
+  if constexpr (frozenTypes[I] == 3 && frozenSources[I] != 100) {
+    digitalWrite(frozenGpios[I], pinStates[I]);
+  }
+  else if constexpr (frozenTypes[I] == 5) {
+    pwmWrite(I, pinStates[I]);
+  }
+  else if constexpr (frozenTypes[I] == 7) {
+    servoWrite(I, pinStates[I]);
+  }
+}
+
+// Functions to run a step for a range of slots (expanded in slot order at compile time)
+template<size_t... I> inline void frozenSnapshots(int *raw, std::index_sequence<I...>) {
+  (frozenSnapshot<I>(raw), ...);
+}
+
+template<size_t... I> inline void frozenInputs(const int *raw, int smoothingAlpha, std::index_sequence<I...>) {
+  (frozenInput<I>(raw, smoothingAlpha), ...);
+}
+
+template<int First, size_t... I> inline void frozenOutputs(std::index_sequence<I...>) {
+  (frozenOutput<First + I>(), ...);
+}
+
+template<size_t... I> inline void frozenCommits(std::index_sequence<I...>) {
+  (frozenCommit<I>(), ...);
+}
+
+// Function to read and process all pin states with the frozen configuration
+// Same order and results as readPins()
+void readPinsFrozen() {
+  static int rawInputs[26] = {0};
+  int smoothingAlpha = smoothingFactor * 256;
+
+  updateTimerIntervals();
+
+  frozenSnapshots(rawInputs, std::make_index_sequence<26>());
+
+  // Any expander pin needs both calls: the transfer that writes the directions and outputs
+  // runs in expanderReadInputs(), or is started by expanderWriteOutputs() with EXPANDER_ASYNC
+  constexpr bool expanders = frozenUses(1, SIGNAL_EXPANDERS, SIGNAL_TIMER_BLOCKS) || frozenUses(3, SIGNAL_EXPANDERS, SIGNAL_TIMER_BLOCKS);
+
+  if constexpr (expanders) {
+    expanderReadInputs(pinStates);
+  }
+
+  if constexpr (frozenUses(8, 0, 24)) {
+    touchInputsRead(pinStates);
+  }
+
+  if constexpr (frozenUses(9, 0, 24)) {
+    captureInputsRead(pinStates);
+  }
+
+  frozenInputs(rawInputs, smoothingAlpha, std::make_index_sequence<26>());
+  comparatorsEvaluate(pinStates);
+  timerBlocksEvaluate(pinStates);
+  frozenOutputs<0>(std::make_index_sequence<24>());
+  frozenOutputs<SIGNAL_EXPANDERS>(std::make_index_sequence<SIGNAL_TIMER_BLOCKS - SIGNAL_EXPANDERS>());
+  frozenCommits(std::make_index_sequence<24>());
+
+  if constexpr (expanders) {
+    expanderWriteOutputs(pinStates);
+  }
+
+  trendSample();
+}
+#endif
+
+// Function to check if a timer's enable signal is active
+bool timerEnabled(int timer) {
+  byte source = timerEnables[timer];
+
+  if(source < 100) { // direct signal
+    return pinStates[source] != 0;
+  }
+
+  if(source > 100 && source < 200) { // inverted signal
+    return pinStates[source - 100] == 0;
+  }
+
+  return true; // always enabled
+}
+
+// Function to handle timer 1 and timer 2
+void runTimers() {
+  // Disabled timers are held OFF and start a fresh OFF time once enabled
+  for(int t=0; t<2; t++) {
+    if(!timerEnabled(t)) {
+      pinStates[SIGNAL_T1+t] = 0;
+      currentTime[t] = millis();
+    }
+  }
+
+  // Handle timer 1 and timer 2
+  // Elapsed time is compared as a difference so the timers keep running when millis()
+  // wraps after 49.7 days, and the next phase starts where the last one was due so
+  // the scan time does not add up as drift
+  unsigned long now = millis();
+
+  for(int t=0; t<2; t++) {
+    int signal = SIGNAL_T1 + t;
+    unsigned long interval = pinStates[signal] == 0 ? timerIntervals[t][1] : timerIntervals[t][0]; // OFF / ON time
+
+    if(now - currentTime[t] >= interval) {
+      pinStates[signal] = !pinStates[signal];
+      currentTime[t] += interval;
+
+      if(now - currentTime[t] >= timerIntervals[t][pinStates[signal] == 0 ? 1 : 0]) {
+        currentTime[t] = now; // a whole phase was missed (interval changed) - restart from now
+      }
+    }
+  }
+}
+
+// Function to run one scan cycle (from loop() in free run, from the scan task otherwise)
+// The I/O is not scanned while the menu is open, as the configuration is being edited
+void scanCycle() {
+  runTimers();
+
+  if(uiMode != 1) {
+#ifdef FROZEN_CONFIG
+    frozenActive ? readPinsFrozen() : readPins();
+#else
+    readPins();
+#endif
+  }
+
+  retainSave(); // mirror switch/timer state for a warm restart
+
+#ifdef MODBUS_ENABLE
+  modbusUpdate(uiMode != 1); // refresh the register image (writes wait while the menu is open)
+#endif
+}
+
+// Function to reset all pin configurations (pins are parked as outputs low on menu exit)
+void clearPins() {
+  for(int i=0; i<24; i++) {
+    pinTypes[i] = 0;
+    pinSources[i] = 100;
+  }
+
+  for(int i=SIGNAL_EXPANDERS; i<SIGNAL_TIMER_BLOCKS; i++) {
+    pinTypes[i] = 0;
+    pinSources[i] = 100;
+  }
+}
+
+// Function to find all input pins for menu system
+void findInputs() {
+  int n = 10;
+
+  // Comparators in use
+  for(int c=0; c<COMPARATORS; c++) {
+    if(comparatorSources[c] != COMPARATOR_OFF) {
+      menuPins2[n] = SIGNAL_COMPARATORS + c;
+      firstMenu[3][n] = pinLabels2[SIGNAL_COMPARATORS + c];
+      n++;
+      menuPins2[n] = SIGNAL_COMPARATORS + c;
+      firstMenu[3][n] = "!" + pinLabels2[SIGNAL_COMPARATORS + c];
+      n++;
+    }
+  }
+
+  // Timer blocks in use
+  for(int b=0; b<TIMER_BLOCKS; b++) {
+    if(blockModes[b] != BLOCK_OFF) {
+      menuPins2[n] = SIGNAL_TIMER_BLOCKS + b;
+      firstMenu[3][n] = pinLabels2[SIGNAL_TIMER_BLOCKS + b];
+      n++;
+      menuPins2[n] = SIGNAL_TIMER_BLOCKS + b;
+      firstMenu[3][n] = "!" + pinLabels2[SIGNAL_TIMER_BLOCKS + b];
+      n++;
+    }
+  }
+
+  for(int i=0; i<24 && n<27; i++) {
+    if(pinTypes[i] == 1 || pinTypes[i] == 2 || pinTypes[i] == 8) {
+      menuPins2[n] = i;
+      firstMenu[3][n] = pinLabels1[i];
+      n++;
+      menuPins2[n] = i;
+      firstMenu[3][n] = "!" + pinLabels1[i];
+      n++;
+    }
+  }
+
+  // Expander inputs
+  for(int i=SIGNAL_EXPANDERS; i<SIGNAL_TIMER_BLOCKS && n<27; i++) {
+    if(pinTypes[i] == 1) {
+      menuPins2[n] = i;
+      firstMenu[3][n] = pinLabels1[i];
+      n++;
+      menuPins2[n] = i;
+      firstMenu[3][n] = "!" + pinLabels1[i];
+      n++;
+    }
+  }
+
+  menuItems[3] = n;
+}
+
+// Function to find all analog pins for menu system
+void findMainAnalogs() {
+  int m = 3;
+  menuItems[4] = 3;
+
+  for(int i = 0; i < 24; i++) {
+    if(pinTypes[i] == 4 || pinTypes[i] == 9) {
+      firstMenu[4][m] = "PIN " + pinLabels1[i];
+      menuPins3[m] = i;
+      m++;
+    }
+  }
+  menuItems[4] = m;
+}
+
+// Function to find all analog pins for timer menu
+void findTimerAnalogs() {
+  int m = 5;
+  menuItems[7] = m;
+
+  for(int i = 0; i < 24; i++) {
+    if(pinTypes[i] == 4 || pinTypes[i] == 9) {
+      firstMenu[7][m] = "PIN " + pinLabels1[i];
+      menuPins4[m] = i;
+      m++;
+    }
+  }
+  menuItems[7] = m;
+}
+
+// Function to find all digital signals that can enable a timer
+void findEnables() {
+  int n = 1; // item 0 is ALWAYS
+  int signals[2 + COMPARATORS + TIMER_BLOCKS] = {SIGNAL_PB1, SIGNAL_PB2};
+  int count = 2;
+
+  for(int c=0; c<COMPARATORS; c++) {
+    if(comparatorSources[c] != COMPARATOR_OFF) {
+      signals[count++] = SIGNAL_COMPARATORS + c;
+    }
+  }
+
+  for(int b=0; b<TIMER_BLOCKS; b++) {
+    if(blockModes[b] != BLOCK_OFF) {
+      signals[count++] = SIGNAL_TIMER_BLOCKS + b;
+    }
+  }
+
+  for(int j=0; j<count && n<27; j++) {
+    menuPins5[n] = signals[j];
+    firstMenu[18][n] = pinLabels2[signals[j]];
+    n++;
+    menuPins5[n] = signals[j] + 100;
+    firstMenu[18][n] = "!" + pinLabels2[signals[j]];
+    n++;
+  }
+
+  for(int i=0; i<24 && n<28; i++) {
+    if(pinTypes[i] == 1 || pinTypes[i] == 2 || pinTypes[i] == 8) {
+      menuPins5[n] = i;
+      firstMenu[18][n] = pinLabels1[i];
+      n++;
+    }
+  }
+
+  menuItems[18] = n;
+}
+
+// Function to find all analog pins for the comparator menu
+void findCompareAnalogs() {
+  int m = 1; // item 0 is OFF
+
+  for(int i = 0; i < 24; i++) {
+    if(pinTypes[i] == 4 || pinTypes[i] == 9) {
+      firstMenu[19][m] = "PIN " + pinLabels1[i];
+      menuPins5[m] = i;
+      m++;
+    }
+  }
+  menuItems[19] = m;
+}
+
+// Function to label the comparator menu with the current settings
+void listComparators() {
+  for(int c=0; c<COMPARATORS; c++) {
+    String label = pinLabels2[SIGNAL_COMPARATORS + c];
+
+    if(comparatorSources[c] == COMPARATOR_OFF) {
+      firstMenu[17][c+1] = label + " OFF";
+    }
+    else {
+      firstMenu[17][c+1] = label + " " + pinLabels1[comparatorSources[c]] + " " + String(comparatorOn[c]) + "/" + String(comparatorOff[c]);
+    }
+  }
+}
+
+// Function to label the timer block menu with the current settings
+void listTimerBlocks() {
+  static const char *modeLabels[BLOCK_MODES] = {"OFF", "TON", "TOF", "TP", "RTG"};
+
+  for(int b=0; b<TIMER_BLOCKS; b++) {
+    String label = pinLabels2[SIGNAL_TIMER_BLOCKS + b] + " " + modeLabels[blockModes[b]];
+
+    if(blockModes[b] != BLOCK_OFF) {
+      byte trigger = blockTriggers[b];
+      label += trigger > 100 ? " !" + pinLabels2[trigger - 100] : " " + pinLabels2[trigger];
+    }
+
+    firstMenu[25][b+1] = label;
+  }
+}
+
+// Function to find all digital signals that can trigger a timer block (direct and inverted)
+void findTriggers() {
+  int n = 0;
+  int signals[4 + COMPARATORS + TIMER_BLOCKS] = {SIGNAL_PB1, SIGNAL_PB2, SIGNAL_T1, SIGNAL_T2};
+  int count = 4;
+
+  for(int c=0; c<COMPARATORS; c++) {
+    if(comparatorSources[c] != COMPARATOR_OFF) {
+      signals[count++] = SIGNAL_COMPARATORS + c;
+    }
+  }
+
+  for(int b=0; b<TIMER_BLOCKS; b++) {
+    if(blockModes[b] != BLOCK_OFF && b != selectedBlock) { // blocks can be chained
+      signals[count++] = SIGNAL_TIMER_BLOCKS + b;
+    }
+  }
+
+  for(int j=0; j<count && n<27; j++) {
+    menuPins5[n] = signals[j];
+    firstMenu[27][n] = pinLabels2[signals[j]];
+    n++;
+    menuPins5[n] = signals[j] + 100;
+    firstMenu[27][n] = "!" + pinLabels2[signals[j]];
+    n++;
+  }
+
+  // Header inputs, then expander inputs
+  for(int i=0; i<SIGNAL_TIMER_BLOCKS && n<27; i++) {
+    if(i == SIGNAL_PB1) {
+      i = SIGNAL_EXPANDERS;
+    }
+
+    if(pinTypes[i] == 1 || pinTypes[i] == 2 || pinTypes[i] == 8) {
+      menuPins5[n] = i;
+      firstMenu[27][n] = pinLabels1[i];
+      n++;
+      menuPins5[n] = i + 100;
+      firstMenu[27][n] = "!" + pinLabels1[i];
+      n++;
+    }
+  }
+
+  menuItems[27] = n;
+}
+
+// Function to find all analog pins that can scale a timer block time
+void findBlockAnalogs() {
+  int m = 1; // item 0 is FIXED
+
+  for(int i = 0; i < 24; i++) {
+    if(pinTypes[i] == 4 || pinTypes[i] == 9) {
+      firstMenu[29][m] = "PIN " + pinLabels1[i];
+      menuPins5[m] = i;
+      m++;
+    }
+  }
+  menuItems[29] = m;
+}
+
+// Function to find all signals that can wake the screen (comparators, timer blocks, inputs)
+void findWakeInputs() {
+  int n = 1; // item 0 is BUTTONS (buttons only)
+
+  for(int i=SIGNAL_COMPARATORS; i<SIGNAL_COUNT && n<28; i++) {
+    if(i == SIGNAL_EXPANDERS) {
+      i = SIGNAL_TIMER_BLOCKS;
+    }
+
+    if((i < SIGNAL_EXPANDERS && comparatorSources[i-SIGNAL_COMPARATORS] != COMPARATOR_OFF) ||
+       (i >= SIGNAL_TIMER_BLOCKS && blockModes[i-SIGNAL_TIMER_BLOCKS] != BLOCK_OFF)) {
+      menuPins5[n] = i;
+      firstMenu[34][n] = pinLabels2[i];
+      n++;
+    }
+  }
+
+  // Header inputs, then expander inputs
+  for(int i=0; i<SIGNAL_TIMER_BLOCKS && n<28; i++) {
+    if(i == SIGNAL_PB1) {
+      i = SIGNAL_EXPANDERS;
+    }
+
+    if(pinTypes[i] == 1 || pinTypes[i] == 2 || pinTypes[i] == 8) {
+      menuPins5[n] = i;
+      firstMenu[34][n] = pinLabels1[i];
+      n++;
+    }
+  }
+
+  menuItems[34] = n;
+}
+
+// Function to fill the expanders menu with chip, address and bus status
+void listExpanders() {
+  for(int e=0; e<EXPANDERS; e++) {
+    String chip = expanderConfigs[e].chip == EXPANDER_MCP23017 ? "MCP " : "PCF ";
+    firstMenu[22][e+1] = chip + String(expanderConfigs[e].address, HEX) + (expanderFound[e] ? "" : " --");
+  }
+}
+
+// Function to fill the expander pin menu with the pins of the selected expander
+void listExpanderPins() {
+  for(int p=0; p<EXPANDER_PINS; p++) {
+    int slot = SIGNAL_EXPANDERS + selectedExpander * EXPANDER_PINS + p;
+    String type = pinTypes[slot] == 1 ? " INP" : pinTypes[slot] == 3 ? " OUT" : "";
+    firstMenu[23][p+1] = pinLabels1[slot] + type;
+  }
+}
+
+// Function to handle a button event in the menu
+void menuButton(const ButtonEvent &event) {
+  static unsigned long lastActionTime = 0;
+  menuAction = 0;
+
+  // Left button (navigation) - press, or auto-repeat while held
+  if(event.button == BUTTON_LEFT && (event.type == BUTTON_PRESS || event.type == BUTTON_REPEAT)) {
+    item++;
+    if(item == menuItems[menu]) {
+      item = 0;
+    }
+    if(menu==1 && item>0) {
+      selection = item;
+    }
+  }
+
+  // Right button (selection)
+  if(event.button == BUTTON_RIGHT && event.type == BUTTON_PRESS) {
+    // Main menu actions
+    if(menu==0 && item==0) { // EXIT - store and apply only what changed
+      unsigned long applyStart = micros();
+      writeEprom();
+      unsigned long eepromMicros = micros() - applyStart;
+      int changedPins = setupPins();
+      uiMode = 0; // I/O scan resumes once the pins are set up
+
+      if(!mirrorStreaming()) { // the port carries mirror frames
+        Serial.printf("Config applied: %d pins reconfigured, EEPROM %lu us, pins %lu us\n",
+                      changedPins, eepromMicros, micros() - applyStart - eepromMicros);
+      }
+    }
+
+    if(menu==0 && item==1) { // clear all pins
+      clearPins();
+    }
+
+    if(menu==0 && item==2 && menuAction==0) { // set Pin
+      menu = 1;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==0 && item==4 && menuAction==0) { // brightness
+      menu = 9;
+      item = 0;
+      menuAction = 1;
+    }
+    
+    if(menu==1 && item==0 && menuAction==0) { // BACK
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==1 && item!=0 && menuAction==0) { // pin selected
+      selectedSlot = menuPins[selection];
+      menu = 2;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==2 && item==0 && menuAction==0) { // BACK
+      menu = 1;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==2 && item==1 && menuAction==0) { // not set
+      detach(selectedSlot);
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+      pinTypes[selectedSlot] = 0;
+      pinSources[selectedSlot] = 100;
+    }
+
+    if(menu==2 && item==2 && menuAction==0) { // input pullup
+      detach(selectedSlot);
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+      pinTypes[selectedSlot] = 1;
+      pinSources[selectedSlot] = 100; 
+    }
+
+    if(menu==2 && item==3 && menuAction==0) { // switch
+      detach(selectedSlot);
+      pinStates[selectedSlot] = 0;
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+      pinTypes[selectedSlot] = 2;
+      pinSources[selectedSlot] = 100;
+    }
+
+    if(menu==2 && item==5 && menuAction==0) { // analog
+      detach(selectedSlot);
+      menu = 14;
+      item = 0;
+      menuAction = 1;
+      pinTypes[selectedSlot] = 4;
+      pinSources[selectedSlot] = 100;
+    }
+
+    if(menu==2 && item==4 && menuAction==0) { // output
+      detach(selectedSlot);
+      findInputs();
+      menu = 3;
+      item = 0;
+      menuAction = 1;
+      pinTypes[selectedSlot] = 3;
+      pinSources[selectedSlot] = 100;
+    }
+
+    // Output menu items
+    if(menu==3 && item==0 && menuAction==0) { // HIGH
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+      pinSources[selectedSlot] = 201;
+    }
+
+    if(menu==3 && item==1 && menuAction==0) { // LOW
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+      pinSources[selectedSlot] = 200;
+    }
+
+    if(menu==3 && item==2 && menuAction==0) { // T1
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+      pinSources[selectedSlot] = 26;
+    }
+
+    if(menu==3 && item==3 && menuAction==0) { // !T1
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+      pinSources[selectedSlot] = 126;
+    }
+
+    if(menu==3 && item==4 && menuAction==0) { // T2
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+      pinSources[selectedSlot] = 27;
+    }
+
+    if(menu==3 && item==5 && menuAction==0) { // !T2
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+      pinSources[selectedSlot] = 127;
+    }
+
+    if(menu==3 && item==6 && menuAction==0) { // PB1
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+      pinSources[selectedSlot] = 24;
+    }
+    
+    if(menu==3 && item==7 && menuAction==0) { // !PB1
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+      pinSources[selectedSlot] = 124;
+    }
+
+    if(menu==3 && item==8 && menuAction==0) { // PB2
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+      pinSources[selectedSlot] = 25;
+    }
+
+    if(menu==3 && item==9 && menuAction==0) { // !PB2
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+      pinSources[selectedSlot] = 125;
+    }
+
+    //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+    if(menu==3 && item>9 && menuAction==0) { // other pins
+      menu = 0;
+      menuAction = 1;
+    
+      if(firstMenu[3][item].charAt(0)=='!') {
+        pinSources[selectedSlot] = menuPins2[item] + 100;
+        item = 0;
+      }
+      else {
+        pinSources[selectedSlot] = menuPins2[item];
+        item = 0;
+      }
+    }
+    //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+    // Analog display selection menu
+    if(menu==14 && menuAction==0) {
+      analogViews[selectedSlot] = item;
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+    }
+
+    // PWM value selection menu
+    if(menu==2 && item==6 && menuAction==0) { // output
+      detach(selectedSlot);
+      findMainAnalogs();
+      menu = 4;
+      item = 0;
+      menuAction = 1;
+      pinTypes[selectedSlot] = 5;
+      pinSources[selectedSlot] = 100;
+    }
+
+    if(menu==4 && item==0 && menuAction==0) {
+      menu = pinTypes[selectedSlot] == 7 ? 0 : 11; // servos have no PWM settings
+      item = 0;
+      menuAction = 1;
+      pinSources[selectedSlot] = 150;
+    }
+
+    if(menu==4 && item==1 && menuAction==0) {
+      menu = pinTypes[selectedSlot] == 7 ? 0 : 11;
+      item = 0;
+      menuAction = 1;
+      pinSources[selectedSlot] = 200;
+    }
+
+    if(menu==4 && item==2 && menuAction==0) {
+      menu = pinTypes[selectedSlot] == 7 ? 0 : 11;
+      item = 0;
+      menuAction = 1;
+      pinSources[selectedSlot] = 250;
+    }
+
+    if(menu==4 && item>2 && menuAction==0) { // analog pins as source
+      menu = pinTypes[selectedSlot] == 7 ? 0 : 11;
+      menuAction = 1;
+      pinSources[selectedSlot] = menuPins3[item];
+      item = 0;
+    }
+
+    // Servo/pulse-train output - mode first, then the value (servo) or the trigger (burst)
+    if(menu==2 && item==7 && menuAction==0) {
+      detach(selectedSlot);
+      menu = 30;
+      item = 0;
+      menuAction = 1;
+      pinTypes[selectedSlot] = 7;
+      pinSources[selectedSlot] = 100;
+    }
+
+    if(menu==30 && menuAction==0) {
+      servoModes[selectedSlot] = item;
+
+      if(item == SERVO_PULSE) {
+        findMainAnalogs();
+        menu = 4;
+      }
+      else {
+        findInputs();
+        menu = 3;
+      }
+
+      item = 0;
+      menuAction = 1;
+    }
+
+    // Capture input - then the value shown on the display (header pins only)
+    if(menu==2 && item==9 && menuAction==0) {
+      menuAction = 1;
+
+      if(selectedSlot < 24) {
+        detach(selectedSlot);
+        menu = 35;
+        item = 0;
+        pinTypes[selectedSlot] = 9;
+        pinSources[selectedSlot] = 100;
+      }
+    }
+
+    if(menu==35 && menuAction==0) {
+      captureViews[selectedSlot] = item;
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+    }
+
+    // Touch input - mode, then threshold (header touch channels only)
+    if(menu==2 && item==8 && menuAction==0) {
+      menuAction = 1;
+
+      if(selectedSlot < 24 && touchCapable(pins[selectedSlot])) {
+        detach(selectedSlot);
+        menu = 31;
+        item = 0;
+        pinTypes[selectedSlot] = 8;
+        pinSources[selectedSlot] = 100;
+      }
+    }
+
+    if(menu==31 && menuAction==0) {
+      touchModes[selectedSlot] = item;
+      menu = 32;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==32 && menuAction==0) {
+      touchLevels[selectedSlot] = item;
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+    }
+
+    // PWM frequency/resolution menu
+    if(menu==11 && menuAction==0) {
+      pwmPresets[selectedSlot] = item;
+      menu = 12;
+      item = 0;
+      menuAction = 1;
+    }
+
+    // PWM fade menu
+    if(menu==12 && menuAction==0) {
+      pwmFades[selectedSlot] = item;
+      menu = 13;
+      item = 0;
+      menuAction = 1;
+    }
+
+    // PWM transfer curve menu
+    if(menu==13 && menuAction==0) {
+      pwmCurves[selectedSlot] = item;
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+    }
+
+    //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+    // Timer selection menu
+    if(menu==0 && item==3 && menuAction==0) {
+      menu = 5;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==5 && item==0 && menuAction==0) { // BACK
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==5 && item==1 && menuAction==0) { // set T1
+      menu = 6;
+      selectedTimerIndex=0;
+      menuTitles[6] = "Set T1";
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==5 && item==2 && menuAction==0) { // set T2
+      menu = 6;
+      selectedTimerIndex=1;
+      menuTitles[6] = "Set T2";
+      item = 0;
+      menuAction = 1;
+    }
+
+    // Timer configuration menu
+    if(menu==6 && item==0 && menuAction==0) { // BACK
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==6 && item==1 && menuAction==0) { // timer ON
+      findTimerAnalogs();
+      menu = 7;
+      menuTitles[7] = "ON TIME";
+      item = 0;
+      menuAction = 1;
+      timerStateSelection=0;
+    } 
+      
+    if(menu==6 && item==2 && menuAction==0) { // timer OFF
+      findTimerAnalogs();
+      menu = 7;
+      menuTitles[7] = "OFF TIME";
+      item = 0;
+      menuAction = 1;
+      timerStateSelection=1;
+    } 
+      
+    if(menu==6 && item==3 && menuAction==0) { // timer multiplier
+      menu = 8;
+      item = 0;
+      menuAction = 1;
+    } 
+
+    if(menu==6 && item==4 && menuAction==0) { // timer enable
+      findEnables();
+      menu = 18;
+      item = 0;
+      menuAction = 1;
+    }
+
+    // Timer enable selection menu
+    if(menu==18 && menuAction==0) {
+      timerEnables[selectedTimerIndex] = item == 0 ? 100 : menuPins5[item];
+      item = 0;
+      menuAction = 1;
+      menu = 6;
+    }
+
+    // Timer interval selection menu
+    if(menu==7 && menuAction==0 && item<5) { // fixed values
+      timerBaseValues[(selectedTimerIndex*2) + timerStateSelection] = firstMenu[7][item].toInt();
+      item = 0;
+      menuAction = 1;
+      menu = 6;
+      timerSources[(selectedTimerIndex*2) + timerStateSelection] = 0;
+    } 
+
+    if(menu==7 && menuAction==0 && item>4) { // analog pins as source
+      timerSources[(selectedTimerIndex*2) + timerStateSelection] = menuPins4[item];
+      item = 0;
+      menuAction = 1;
+      menu = 6;
+    } 
+
+    // Timer multiplier selection menu
+    if(menu==8 && menuAction==0) {
+      timerMultipliers[selectedTimerIndex*2] = firstMenu[8][item].toInt();
+      timerMultipliers[selectedTimerIndex*2+1] = firstMenu[8][item].toInt(); 
+      item = 0;
+      menuAction = 1;
+      menu = 6;
+    } 
+    //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+
+    // Brightness selection menu
+    if(menu==9 && menuAction==0) {
+      backlightSetLevel(firstMenu[9][item].toInt());
+      item = 0;
+      menu = 0;
+    }
+
+    // Non-blocking 250ms delay
+    if (millis() - lastActionTime > 250) {
+        lastActionTime = millis();
+    }
+
+    //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+    // Analog Smoothing
+    if(menu==0 && item==5 && menuAction==0) {
+      menu = 10;
+      item = 0;
+      menuAction = 1;
+    }
+
+    // Handle smoothing menu
+    if(menu==10 && item==0 && menuAction==0) { // BACK
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+    }
+
+    // Smoothing value selected
+    if(menu==10 && item>0 && menuAction==0) { 
+      smoothingFactor = firstMenu[10][item].toFloat();
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+    }
+    //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+    // Trend view
+    if(menu==0 && item==6 && menuAction==0) {
+      menu = 15;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==15 && item==0 && menuAction==0) { // BACK
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==15 && item>0 && menuAction==0) { // ROLL or TRIGGER - keeps the I/O scan running
+      trendEnter(item == 1 ? TREND_ROLL : TREND_TRIGGER);
+      uiMode = 2;
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+    }
+    //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+    // Scan cycle
+    if(menu==0 && item==7 && menuAction==0) {
+      menu = 16;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==16 && item==0 && menuAction==0) { // BACK
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==16 && item>0 && item<5 && menuAction==0) { // period selected (saved on EXIT)
+      scanPeriodIndex = item - 1;
+      scanSetPeriod(scanPeriodIndex);
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==16 && item==5 && menuAction==0) { // STATS - keeps the I/O scan running
+      uiMode = 3;
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+    }
+    //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+    // Comparators
+    if(menu==0 && item==8 && menuAction==0) {
+      listComparators();
+      menu = 17;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==17 && item==0 && menuAction==0) { // BACK
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==17 && item>0 && menuAction==0) { // comparator selected
+      selectedComparator = item - 1;
+      findCompareAnalogs();
+      menu = 19;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==19 && item==0 && menuAction==0) { // OFF
+      comparatorSources[selectedComparator] = COMPARATOR_OFF;
+      listComparators();
+      menu = 17;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==19 && item>0 && menuAction==0) { // analog pin selected
+      comparatorSources[selectedComparator] = menuPins5[item];
+      menu = 20;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==20 && menuAction==0) { // on threshold
+      comparatorOn[selectedComparator] = firstMenu[20][item].toInt();
+      menu = 21;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==21 && menuAction==0) { // off threshold
+      comparatorOff[selectedComparator] = firstMenu[21][item].toInt();
+      listComparators();
+      menu = 17;
+      item = 0;
+      menuAction = 1;
+    }
+    //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+    // Expanders
+    if(menu==0 && item==9 && menuAction==0) {
+      listExpanders();
+      menu = 22;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==22 && item==0 && menuAction==0) { // BACK
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==22 && item>0 && menuAction==0) { // expander selected
+      selectedExpander = item - 1;
+      listExpanderPins();
+      menu = 23;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==23 && item==0 && menuAction==0) { // BACK
+      menu = 22;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==23 && item>0 && menuAction==0) { // expander pin selected
+      selectedSlot = SIGNAL_EXPANDERS + selectedExpander * EXPANDER_PINS + item - 1;
+      menu = 24;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==24 && item==0 && menuAction==0) { // BACK
+      menu = 23;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==24 && (item==1 || item==2) && menuAction==0) { // not set, input pullup
+      detach(selectedSlot);
+      pinTypes[selectedSlot] = item==2 ? 1 : 0;
+      pinSources[selectedSlot] = 100;
+      listExpanderPins();
+      menu = 23;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==24 && item==3 && menuAction==0) { // output - choose the source next
+      findInputs();
+      menu = 3;
+      item = 0;
+      menuAction = 1;
+      pinTypes[selectedSlot] = 3;
+      pinSources[selectedSlot] = 100;
+    }
+    //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+    // Memory - keeps the I/O scan running
+    if(menu==0 && item==10 && menuAction==0) {
+      uiMode = 4;
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+    }
+    //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+    // Timer blocks
+    if(menu==0 && item==11 && menuAction==0) {
+      listTimerBlocks();
+      menu = 25;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==25 && item==0 && menuAction==0) { // BACK
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==25 && item>0 && menuAction==0) { // block selected
+      selectedBlock = item - 1;
+      menu = 26;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==26 && item==0 && menuAction==0) { // OFF
+      blockModes[selectedBlock] = BLOCK_OFF;
+      timerBlocksReset(pinStates);
+      listTimerBlocks();
+      menu = 25;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==26 && item>0 && menuAction==0) { // mode selected - choose the trigger next
+      blockModes[selectedBlock] = item;
+      findTriggers();
+      menu = 27;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==27 && menuAction==0) { // trigger
+      blockTriggers[selectedBlock] = menuPins5[item];
+      menu = 28;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==28 && menuAction==0) { // preset time
+      blockPresets[selectedBlock] = item;
+      findBlockAnalogs();
+      menu = 29;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==29 && menuAction==0) { // fixed, or scaled by an analog pin
+      blockTimeSources[selectedBlock] = item == 0 ? BLOCK_FIXED : menuPins5[item];
+      timerBlocksReset(pinStates); // timing starts over with the new settings
+      listTimerBlocks();
+      menu = 25;
+      item = 0;
+      menuAction = 1;
+    }
+    //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+    // Screen idle (dim and off times, then the wake input)
+    if(menu==0 && item==12 && menuAction==0) {
+      menu = 33;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==33 && menuAction==0) { // dim / off times
+      backlightIdle = item;
+      findWakeInputs();
+      menu = 34;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==34 && menuAction==0) { // wake input
+      backlightWake = item == 0 ? BACKLIGHT_NO_WAKE : menuPins5[item];
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+    }
+    //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+    // Headless (takes effect when the menu is left)
+    if(menu==0 && item==13 && menuAction==0) {
+      menu = 36;
+      item = 0;
+      menuAction = 1;
+    }
+
+    if(menu==36 && menuAction==0) {
+      headlessMode = item;
+      menu = 0;
+      item = 0;
+      menuAction = 1;
+    }
+    //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
+  }
+}
+
+// Function to draw and handle the menu system
+// The menu is only redrawn when a button event changed it, so the response time is that of
+// the event and not of a frame
+void setPins() {
+  ButtonEvent event;
+  bool redraw = menuRedraw;
+
+  while(uiMode == 1 && buttonsRead(event)) {
+    menuButton(event);
+    redraw = true;
+  }
+
+  if(!redraw || uiMode != 1) { // nothing changed, or the menu was left
+    return;
+  }
+
+  menuRedraw = false;
   sprite.fillSprite(tftBlack);
 
   // Draw menu background
-  sprite.fillSmoothRoundRect(99, 24, 62, 244, 6, offWhite, tftBlack);
-  sprite.fillSmoothRoundRect(4, 296, 40, 20, 4, darkBlue, tftBlack);
-  sprite.fillSmoothRoundRect(126, 296, 40, 20, 4, darkBlue, tftBlack);
+  fillBox(sprite, 99, 24, 62, 244, 6, offWhite, tftBlack);
+  fillBox(sprite, 4, 296, 40, 20, 4, darkBlue, tftBlack);
+  fillBox(sprite, 126, 296, 40, 20, 4, darkBlue, tftBlack);
   sprite.drawLine(4, 20, 92, 20, grey);
   sprite.fillRect(4, 24, 86, 244, purple);
   sprite.drawLine(4, 270, 92, 270, grey);
@@ -387,11 +2018,7 @@ void setPins() {
   sprite.setTextDatum(4);
 
   // Draw pin type legend
-  for(int i=0; i<5; i++) {
-    sprite.fillSmoothRoundRect(4+i*32, 278, 30, 12, 2, typeColours[i], tftBlack);
-    sprite.setTextColor(tftWhite, typeColours[i]);
-    sprite.drawString(pinTypeLabels[i], 4+i*32+30/2, 278+7);
-  }
+  drawTypeLegend(4, 278, tftBlack, 7);
 
   // Draw all pins in menu mode
   for(int i=0; i<24; i++) {
@@ -415,14 +2042,10 @@ void setPins() {
     
     // Draw pin box with appropriate colour
     if(pinTypes[i]!=0) {
-      sprite.fillSmoothRoundRect(pinBoxX, pinBoxY, width, height, 2, typeColours[pinTypes[i]-1], offWhite);
-      sprite.setTextColor(tftWhite, typeColours[pinTypes[i]-1]);
-      sprite.drawString(pinLabels1[i], pinBoxX+width/2, pinBoxY+height/2, 2);
+      drawPinBox(i, pinBoxX, pinBoxY, typeColours[pinTypes[i]-1]);
     }
     else {
-      sprite.fillSmoothRoundRect(pinBoxX, pinBoxY, width, height, 2, pinColours[i], offWhite);
-      sprite.setTextColor(tftWhite, pinColours[i]);
-      sprite.drawString(pinLabels1[i], pinBoxX+width/2, pinBoxY+height/2, 2);
+      drawPinBox(i, pinBoxX, pinBoxY, pinColours[i]);
     }
 
     // Highlight selected pin
@@ -434,12 +2057,12 @@ void setPins() {
 
   // Draw menu title and buttons
   sprite.setTextDatum(0);
-  sprite.loadFont(NotoSansBold15);
+  smoothFont();
   sprite.setTextColor(tftWhite, tftBlack);
   sprite.drawString(menuTitles[menu], 4, 4, 2);
   sprite.drawString("SEL", 12, 299, 2);
   sprite.drawString("OK", 135, 299, 2);
-  sprite.unloadFont();
+  plainFont();
   
   // Draw menu footer
   sprite.setTextDatum(4);
@@ -476,427 +2099,142 @@ void setPins() {
 
   sprite.fillCircle(selectorX, selectorY+(item*15), 3, orange);
   
-  // Handle left button (navigation) - only if not waiting for release
-  if(digitalRead(0)==0) {
-    if(!leftButtonPressed && !waitForButtonRelease && millis() - lastLeftButtonTime > debounceInterval) {
-      leftButtonPressed = true;
-      lastLeftButtonTime = millis();
-      
-      item++;
-      if(item == menuItems[menu]) {
-        item = 0;
-      }
-      if(menu==1 && item>0) {
-        selection = item;
-      }
-    }
+  pushFrame();
+}
+
+// Function to handle a trend view button press
+void trendButton(byte button) {
+  if(button == BUTTON_LEFT) { // next analog pin
+    trendNextPin();
   }
-  else {
-    leftButtonPressed = false;
-    // Clear wait flag if both buttons are released
-    if(waitForButtonRelease && digitalRead(14)==1) {
-      waitForButtonRelease = false;
-    }
+  else if(trendMode() == TREND_ROLL) { // next timebase
+    trendNextTimebase();
   }
+  else { // re-arm the trigger
+    trendArm();
+  }
+}
 
-  // Handle right button (selection) - only if not waiting for release
-  if(digitalRead(14)==0) {
-    if(!rightButtonPressed && !waitForButtonRelease && millis() - lastRightButtonTime > debounceInterval) {
-      rightButtonPressed = true;
-      lastRightButtonTime = millis();
-      
-      // Main menu actions
-      if(menu==0 && item==0) { // EXIT 
-        uiMode = 0;
-        writeEprom();
-        setupPins();
-      }
-
-      if(menu==0 && item==1) { // clear all pins
-        clearPins();
-      }
-
-      if(menu==0 && item==2 && menuAction==0) { // set Pin
-        menu = 1;
-        item = 0;
-        menuAction = 1;
-      }
-
-      if(menu==0 && item==4 && menuAction==0) { // brightness
-        menu = 9;
-        item = 0;
-        menuAction = 1;
-      }
-      
-      if(menu==1 && item==0 && menuAction==0) { // BACK
-        menu = 0;
-        item = 0;
-        menuAction = 1;
-      }
-
-      if(menu==1 && item!=0 && menuAction==0) { // pin selected
-        menu = 2;
-        item = 0;
-        menuAction = 1;
-      }
-
-      if(menu==2 && item==0 && menuAction==0) { // BACK
-        menu = 1;
-        item = 0;
-        menuAction = 1;
-      }
-
-      if(menu==2 && item==1 && menuAction==0) { // not set
-        detach(menuPins[selection]);
-        menu = 0;
-        item = 0;
-        menuAction = 1;
-        pinTypes[menuPins[selection]] = 0;
-        pinSources[menuPins[selection]] = 100;
-      }
-
-      if(menu==2 && item==2 && menuAction==0) { // input pullup
-        detach(menuPins[selection]);
-        menu = 0;
-        item = 0;
-        menuAction = 1;
-        pinTypes[menuPins[selection]] = 1;
-        pinSources[menuPins[selection]] = 100; 
-        pinMode(firstMenu[1][selection].toInt(), INPUT_PULLUP);
-      }
-
-      if(menu==2 && item==3 && menuAction==0) { // switch
-        detach(menuPins[selection]);
-        pinStates[menuPins[selection]] = 0;
-        menu = 0;
-        item = 0;
-        menuAction = 1;
-        pinTypes[menuPins[selection]] = 2;
-        pinSources[menuPins[selection]] = 100;
-        pinMode(firstMenu[1][selection].toInt(), INPUT_PULLUP);
-      }
-
-      if(menu==2 && item==5 && menuAction==0) { // analog
-        detach(menuPins[selection]);
-        menu = 0;
-        item = 0;
-        menuAction = 1;
-        pinTypes[menuPins[selection]] = 4;
-        pinSources[menuPins[selection]] = 100;
-      }
-
-      if(menu==2 && item==4 && menuAction==0) { // output
-        detach(menuPins[selection]);
-        findInputs();
-        menu = 3;
-        item = 0;
-        menuAction = 1;
-        pinTypes[menuPins[selection]] = 3;
-        pinSources[menuPins[selection]] = 100;
-        pinMode(firstMenu[1][selection].toInt(), OUTPUT);
-      }
-
-      // Output menu items
-      if(menu==3 && item==0 && menuAction==0) { // HIGH
-        menu = 0;
-        item = 0;
-        menuAction = 1;
-        pinSources[menuPins[selection]] = 201;
-      }
-
-      if(menu==3 && item==1 && menuAction==0) { // LOW
-        menu = 0;
-        item = 0;
-        menuAction = 1;
-        pinSources[menuPins[selection]] = 200;
-      }
-
-      if(menu==3 && item==2 && menuAction==0) { // T1
-        menu = 0;
-        item = 0;
-        menuAction = 1;
-        pinSources[menuPins[selection]] = 26;
-      }
-
-      if(menu==3 && item==3 && menuAction==0) { // !T1
-        menu = 0;
-        item = 0;
-        menuAction = 1;
-        pinSources[menuPins[selection]] = 126;
-      }
-
-      if(menu==3 && item==4 && menuAction==0) { // T2
-        menu = 0;
-        item = 0;
-        menuAction = 1;
-        pinSources[menuPins[selection]] = 27;
-      }
-
-      if(menu==3 && item==5 && menuAction==0) { // !T2
-        menu = 0;
-        item = 0;
-        menuAction = 1;
-        pinSources[menuPins[selection]] = 127;
-      }
-
-      if(menu==3 && item==6 && menuAction==0) { // PB1
-        menu = 0;
-        item = 0;
-        menuAction = 1;
-        pinSources[menuPins[selection]] = 24;
-      }
-      
-      if(menu==3 && item==7 && menuAction==0) { // !PB1
-        menu = 0;
-        item = 0;
-        menuAction = 1;
-        pinSources[menuPins[selection]] = 124;
-      }
-
-      if(menu==3 && item==8 && menuAction==0) { // PB2
-        menu = 0;
-        item = 0;
-        menuAction = 1;
-        pinSources[menuPins[selection]] = 25;
-      }
-
-      if(menu==3 && item==9 && menuAction==0) { // !PB2
-        menu = 0;
-        item = 0;
-        menuAction = 1;
-        pinSources[menuPins[selection]] = 125;
-      }
-
-      //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
-      if(menu==3 && item>9 && menuAction==0) { // other pins
-        menu = 0;
-        menuAction = 1;
-      
-        if(firstMenu[3][item].charAt(0)=='!') {
-          pinSources[menuPins[selection]] = menuPins2[item] + 100;
-          item = 0;
-        }
-        else {
-          pinSources[menuPins[selection]] = menuPins2[item];
-          item = 0;
-        }
-      }
-      //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
-
-      // PWM value selection menu
-      if(menu==2 && item==6 && menuAction==0) { // output
-        detach(menuPins[selection]);
-        findMainAnalogs();
-        menu = 4;
-        item = 0;
-        menuAction = 1;
-        pinTypes[menuPins[selection]] = 5;
-        pinSources[menuPins[selection]] = 100;
-      }
-
-      if(menu==4 && item==0 && menuAction==0) {
-        menu = 0;
-        item = 0;
-        menuAction = 1;
-        pinSources[menuPins[selection]] = 150;
-      }
-
-      if(menu==4 && item==1 && menuAction==0) {
-        menu = 0;
-        item = 0;
-        menuAction = 1;
-        pinSources[menuPins[selection]] = 200;
-      }
-
-      if(menu==4 && item==2 && menuAction==0) {
-        menu = 0;
-        item = 0;
-        menuAction = 1;
-        pinSources[menuPins[selection]] = 250;
-      }
-
-      if(menu==4 && item>2 && menuAction==0) { // analog pins as source
-        menu = 0;
-        menuAction = 1;
-        pinSources[menuPins[selection]] = menuPins3[item];
-        item = 0;
-      }
-
-      //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
-      // Timer selection menu
-      if(menu==0 && item==3 && menuAction==0) {
-        menu = 5;
-        item = 0;
-        menuAction = 1;
-      }
-
-      if(menu==5 && item==0 && menuAction==0) { // BACK
-        menu = 0;
-        item = 0;
-        menuAction = 1;
-      }
-
-      if(menu==5 && item==1 && menuAction==0) { // set T1
-        menu = 6;
-        selectedTimerIndex=0;
-        menuTitles[6] = "Set T1";
-        item = 0;
-        menuAction = 1;
-      }
-
-      if(menu==5 && item==2 && menuAction==0) { // set T2
-        menu = 6;
-        selectedTimerIndex=1;
-        menuTitles[6] = "Set T2";
-        item = 0;
-        menuAction = 1;
-      }
-
-      // Timer configuration menu
-      if(menu==6 && item==0 && menuAction==0) { // BACK
-        menu = 0;
-        item = 0;
-        menuAction = 1;
-      }
+// Function to handle a scan statistics button press
+void scanButton(byte button) {
+  if(button == BUTTON_LEFT) { // print the histograms (not into a mirror stream)
+    if(!mirrorStreaming()) {
+      scanReport(Serial, true);
+    }
+  }
+  else { // reset the statistics
+    scanReset();
+  }
+}
 
-      if(menu==6 && item==1 && menuAction==0) { // timer ON
-        findTimerAnalogs();
-        menu = 7;
-        menuTitles[7] = "ON TIME";
-        item = 0;
-        menuAction = 1;
-        timerStateSelection=0;
-      } 
-        
-      if(menu==6 && item==2 && menuAction==0) { // timer OFF
-        findTimerAnalogs();
-        menu = 7;
-        menuTitles[7] = "OFF TIME";
-        item = 0;
-        menuAction = 1;
-        timerStateSelection=1;
-      } 
-        
-      if(menu==6 && item==3 && menuAction==0) { // timer multiplier
-        menu = 8;
-        item = 0;
-        menuAction = 1;
-      } 
+// Function to handle a memory page button press
+void memoryButton(byte button) {
+  if(button == BUTTON_LEFT) { // print the latest sample (not into a mirror stream)
+    if(!mirrorStreaming()) {
+      memStatsReport(Serial);
+    }
+  }
+  else { // reset the worst-case values
+    memStatsReset();
+  }
+}
 
-      // Timer interval selection menu
-      if(menu==7 && menuAction==0 && item<5) { // fixed values
-        timerBaseValues[(selectedTimerIndex*2) + timerStateSelection] = firstMenu[7][item].toInt();
-        item = 0;
-        menuAction = 1;
-        menu = 6;
-        timerSources[(selectedTimerIndex*2) + timerStateSelection] = 0;
-      } 
+// Function to handle button events outside the menu (run mode, trend view, scan statistics, memory)
+void pageButtons() {
+  ButtonEvent event;
 
-      if(menu==7 && menuAction==0 && item>4) { // analog pins as source
-        timerSources[(selectedTimerIndex*2) + timerStateSelection] = menuPins4[item];
-        item = 0;
-        menuAction = 1;
-        menu = 6;
-      } 
-
-      // Timer multiplier selection menu
-      if(menu==8 && menuAction==0) {
-        timerMultipliers[selectedTimerIndex*2] = firstMenu[8][item].toInt();
-        timerMultipliers[selectedTimerIndex*2+1] = firstMenu[8][item].toInt(); 
-        item = 0;
-        menuAction = 1;
-        menu = 6;
-      } 
-      //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
-
-      // Brightness selection menu
-      if(menu==9 && menuAction==0) {
-        ledcWrite(0, firstMenu[9][item].toInt());
-        item = 0;
-        menu = 0;
-      }
+  while(uiMode != 1 && buttonsRead(event)) {
+    if(event.type == BUTTON_CHORD) { // both buttons - menu, or back to run mode
+      uiMode = uiMode == 0 ? 1 : 0;
+      menuRedraw = true;
+    }
+    else if(event.type == BUTTON_PRESS && headlessMode != HEADLESS_OFF) {
+      headlessRequestFrame(); // headless - one frame of the page
+    }
+    else if(event.type == BUTTON_PRESS && uiMode == 2) {
+      trendButton(event.button);
+    }
+    else if(event.type == BUTTON_PRESS && uiMode == 3) {
+      scanButton(event.button);
+    }
+    else if(event.type == BUTTON_PRESS && uiMode == 4) {
+      memoryButton(event.button);
+    }
+  }
+}
 
-      // Non-blocking 250ms delay
-      if (millis() - lastActionTime > 250) {
-          lastActionTime = millis();
-      }
+// Function to draw the scan statistics page
+void scanPage() {
+  static unsigned long lastDrawTime = 0;
 
-      //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
-      // Analog Smoothing
-      if(menu==0 && item==5 && menuAction==0) {
-        menu = 10;
-        item = 0;
-        menuAction = 1;
-      }
+  // Redraw 5 times per second - the page is for reading, not for speed
+  if(millis() - lastDrawTime >= 200) {
+    lastDrawTime = millis();
+    drawScanStats();
+  }
+}
 
-      // Handle smoothing menu
-      if(menu==10 && item==0 && menuAction==0) { // BACK
-        menu = 0;
-        item = 0;
-        menuAction = 1;
-      }
+// Function to draw the memory page
+void memoryPage() {
+  static unsigned long lastDrawTime = 0;
 
-      // Smoothing value selected
-      if(menu==10 && item>0 && menuAction==0) { 
-        smoothingFactor = firstMenu[10][item].toFloat();
-        menu = 0;
-        item = 0;
-        menuAction = 1;
-      }
-      //::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::::
-    }
-  }
-  else {
-    rightButtonPressed = false;
-    
-    // Clear wait flag if both buttons are released
-    if(waitForButtonRelease && digitalRead(0)==1) {
-      waitForButtonRelease = false;
-    }
+  // The sample only changes once per second
+  if(millis() - lastDrawTime >= 500) {
+    lastDrawTime = millis();
+    drawMemoryStats();
   }
-  sprite.pushSprite(0, 0);
 }
 
 // Function to read supply voltage
 void readSupplyVoltage() {
   uint32_t rawValue = analogRead(4); // GPIO4
   
-  // Calculate with floating point precision first
-  float calculated_mV = (rawValue * 2 * 3.3 * 1000) / 4096.0;
-  
-  // Store raw millivolts as integer
-  millivolts = static_cast<int>(calculated_mV);
+  // Calibrated millivolts (x2 for the on-board voltage divider)
+  millivolts = analogMillivolts(4, rawValue) * 2;
   
   // Calculate supply voltage
-  supplyVoltage = calculated_mV / 1000.0f;
+  supplyVoltage = millivolts / 1000.0f;
 }
 
 // Function to calculate device uptime
+// Uses the 64-bit esp_timer clock, as millis() wraps after 49.7 days
 void calculateUptime() {
-  unsigned long currentMillis = millis();
-  unsigned long seconds = currentMillis / 1000;
+  unsigned long seconds = esp_timer_get_time() / 1000000;
   
-  byte hours = seconds / 3600;
+  unsigned int hours = seconds / 3600;
   byte minutes = (seconds % 3600) / 60;
   byte secs = seconds % 60;
   
-  sprintf(uptimeString, "%1d:%02d:%02d", hours, minutes, secs); // remove leading zeros
+  snprintf(uptimeString, sizeof(uptimeString), "%1u:%02d:%02d", hours, minutes, secs); // remove leading zeros
 }
 
-// Function to calculate the FPS
+// Function to calculate the FPS from the frames drawn since the last call (1 Hz job)
 void calculateFPS() {
-  static unsigned long lastCalcTime = 0;
-  static int frameCount = 0;
+  static int64_t lastCalcTime = 0;
+  static unsigned long lastFrameCount = 0;
   
-  unsigned long currentTime = millis();
-  frameCount++;
+  int64_t currentTime = esp_timer_get_time();
   
-  // Calculate FPS every second
-  if (currentTime - lastCalcTime >= 1000) {
-    fps = frameCount * 1000.0 / (currentTime - lastCalcTime);
-    frameCount = 0;
-    lastCalcTime = currentTime;
+  if(currentTime > lastCalcTime) {
+    fps = (frameCount - lastFrameCount) * 1000000.0f / (currentTime - lastCalcTime);
+  }
+
+  lastFrameCount = frameCount;
+  lastCalcTime = currentTime;
+}
+
+// Function to print the status lines on the serial port (every 5 s job)
+void printStatus() {
+  if(mirrorStreaming()) {
+    return; // the port carries mirror frames
   }
+
+  Serial.printf("Push: %lu us\n", pushMicros);
+  captureReport(Serial);
+  memStatsReport(Serial);
+  scanReport(Serial, false);
+  expanderReport(Serial, false);
+  jobsReport(Serial);
 }
 
 // Function to draw the display
@@ -904,11 +2242,11 @@ void drawDisplay() {
   sprite.fillSprite(offWhite);
 
   // Draw timer 1 UI elements
-  sprite.fillSmoothRoundRect(4, 20, 78, 28, 4, seaGreen, offWhite);
-  sprite.fillSmoothRoundRect(4, 30, 50, 38, 4, seaGreen, offWhite);
-  sprite.fillSmoothRoundRect(5, 21, 76, 26, 4, tftWhite, seaGreen);
-  sprite.fillSmoothRoundRect(5, 30, 48, 37, 4, tftWhite, seaGreen);
-  sprite.fillSmoothCircle(40, 55, 9, seaGreen);
+  fillBox(sprite, 4, 20, 78, 28, 4, seaGreen, offWhite);
+  fillBox(sprite, 4, 30, 50, 38, 4, seaGreen, offWhite);
+  fillBox(sprite, 5, 21, 76, 26, 4, tftWhite, seaGreen);
+  fillBox(sprite, 5, 30, 48, 37, 4, tftWhite, seaGreen);
+  fillDot(sprite, 40, 55, 9, seaGreen);
   sprite.setTextDatum(4);
   
   // Draw timer 1 labels
@@ -918,11 +2256,11 @@ void drawDisplay() {
   sprite.drawString("OFF - " + String(timerIntervals[0][1]), 12, 35);
 
   // Draw timer 2 UI elements
-  sprite.fillSmoothRoundRect(90, 20, 76, 28, 4, seaGreen, offWhite);
-  sprite.fillSmoothRoundRect(118, 30, 48, 38, 4, seaGreen, offWhite);
-  sprite.fillSmoothRoundRect(91, 21, 74, 26, 4, tftWhite, seaGreen);
-  sprite.fillSmoothRoundRect(119, 30, 46, 37, 4, tftWhite, seaGreen);
-  sprite.fillSmoothCircle(132, 55, 10, seaGreen);
+  fillBox(sprite, 90, 20, 76, 28, 4, seaGreen, offWhite);
+  fillBox(sprite, 118, 30, 48, 38, 4, seaGreen, offWhite);
+  fillBox(sprite, 91, 21, 74, 26, 4, tftWhite, seaGreen);
+  fillBox(sprite, 119, 30, 46, 37, 4, tftWhite, seaGreen);
+  fillDot(sprite, 132, 55, 10, seaGreen);
   sprite.setTextDatum(4);
 
   // Draw timer 2 labels
@@ -934,11 +2272,7 @@ void drawDisplay() {
   sprite.setTextDatum(4);
   
   // Draw pin type legend (top colour-coded labels)
-  for(int i=0; i<5; i++) {
-    sprite.fillSmoothRoundRect(6+i*32, 4, 30, 12, 2, typeColours[i], offWhite);
-    sprite.setTextColor(tftWhite, typeColours[i]);
-    sprite.drawString(pinTypeLabels[i], 6+i*32+30/2, 4+6); 
-  }
+  drawTypeLegend(6, 4, offWhite, 6);
 
   // Draw all 24 pins in a grid layout
   for(int i=0; i<24; i++) {
@@ -962,60 +2296,84 @@ void drawDisplay() {
     }
     
     // Draw pin box (background + label)
-    sprite.fillSmoothRoundRect(pinBoxX, pinBoxY, width, height, 2, pinColours[i], offWhite);
-    sprite.setTextColor(tftWhite, pinColours[i]);
-    sprite.drawString(pinLabels1[i], pinBoxX+width/2, pinBoxY+height/2, 2);
+    drawPinBox(i, pinBoxX, pinBoxY, pinColours[i]);
 
     // Draw additional elements for configured pins
     if(pinTypes[i] != 0) {
+      unsigned short lineColour = stateColours[pinStates[i] != 0]; // analog/PWM values are 0-255
+
       // Connection line to state indicator
-      sprite.drawLine(lineStartX, pinBoxY+height/2, lineEndX, pinBoxY+height/2, stateColours[pinStates[i]]);
-      sprite.drawLine(lineStartX, pinBoxY+height/2+1, lineEndX, pinBoxY+height/2+1, stateColours[pinStates[i]]);
+      sprite.drawLine(lineStartX, pinBoxY+height/2, lineEndX, pinBoxY+height/2, lineColour);
+      sprite.drawLine(lineStartX, pinBoxY+height/2+1, lineEndX, pinBoxY+height/2+1, lineColour);
 
       // Pin type indicator (small coloured box)
-      sprite.fillSmoothRoundRect(lineStartX, pinBoxY+2, width-12, height-4, 2, typeColours[pinTypes[i] - 1]);
-      sprite.setTextColor(tftWhite, typeColours[pinTypes[i] - 1]);
-      sprite.drawString(pinTypeLabels[pinTypes[i] - 1].substring(0, 1), lineStartX+6, pinBoxY+3+((height-4) / 2));
+      drawTypeBadge(pinTypes[i] - 1, lineStartX, pinBoxY+2);
 
       /// Special handling for different pin types:
-      if(pinTypes[i] == 4) { // analog pin value display
-        sprite.fillSmoothRoundRect(valueDisplayX, pinBoxY+2, width+3, height-4, 4, typeColours[pinTypes[i] - 1]);
+      if(pinTypes[i] == 4) { // analog pin value display (0-255 or calibrated mV)
+        drawValuePill(valueDisplayX, pinBoxY+2, typeColours[pinTypes[i] - 1], lineColour);
         sprite.setTextColor(tftWhite, typeColours[pinTypes[i] - 1]);
-        sprite.drawString(String(pinStates[i]), valueDisplayX+14, 1+pinBoxY+height/2);
+        sprite.drawString(String(analogViews[i] ? pinMillivolts[i] : pinStates[i]), valueDisplayX+14, 1+pinBoxY+height/2);
       }
 
       // PWM pin value display
-      if(pinTypes[i] == 5) { // PWM pin value display - duty cycle (0-255)
-        sprite.fillSmoothRoundRect(valueDisplayX, pinBoxY+2, width+3, height-4, 4, typeColours[pinTypes[i] - 1]);
-        sprite.setTextColor(tftWhite, typeColours[pinTypes[i] - 1]);
+      if(pinTypes[i] == 5) { // PWM pin value display - duty cycle (0-255), red when out of channels
+        unsigned short pwmColour = pwmChannels[i] == PWM_NO_CHANNEL ? tftRed : typeColours[pinTypes[i] - 1];
+        drawValuePill(valueDisplayX, pinBoxY+2, pwmColour, lineColour);
+        sprite.setTextColor(tftWhite, pwmColour);
         sprite.drawString(String(pinStates[i]), valueDisplayX+14, 1+pinBoxY+height/2);
       }
 
+      if(pinTypes[i] == 7) { // servo value (0-255) or burst trigger, red without an RMT channel
+        unsigned short servoColour = servoChannels[i] == SERVO_NO_CHANNEL ? tftRed : typeColours[pinTypes[i] - 1];
+        drawValuePill(valueDisplayX, pinBoxY+2, servoColour, lineColour);
+        sprite.setTextColor(tftWhite, servoColour);
+        sprite.drawString(String(pinStates[i]), valueDisplayX+14, 1+pinBoxY+height/2);
+      }
+
+      if(pinTypes[i] == 8) { // touch raw reading (k above 10000), red while touched
+        unsigned short touchColour = touchInputActive(i) ? tftRed : typeColours[pinTypes[i] - 1];
+        uint32_t raw = touchValues[i];
+        drawValuePill(valueDisplayX, pinBoxY+2, touchColour, lineColour);
+        sprite.setTextColor(tftWhite, touchColour);
+        sprite.drawString(raw < 10000 ? String(raw) : String(raw / 1000) + "k", valueDisplayX+14, 1+pinBoxY+height/2);
+      }
+
+      if(pinTypes[i] == 9) { // capture duty (0-255), high time or period (m above 10000 us), red without a channel
+        unsigned short captureColour = captureChannels[i] == CAPTURE_NO_CHANNEL ? tftRed : typeColours[pinTypes[i] - 1];
+        uint32_t captureMicros = captureViews[i] == CAPTURE_VIEW_HIGH ? captureHighMicros[i] : capturePeriodMicros[i];
+        String value = captureMicros < 10000 ? String(captureMicros) : String(captureMicros / 1000) + "m";
+        drawValuePill(valueDisplayX, pinBoxY+2, captureColour, lineColour);
+        sprite.setTextColor(tftWhite, captureColour);
+        sprite.drawString(captureViews[i] == CAPTURE_VIEW_DUTY ? String(pinStates[i]) : value, valueDisplayX+14, 1+pinBoxY+height/2);
+      }
+
       // Output pin source label
       if(pinTypes[i] == 3) { // shows what source is driving the output
         sprite.setTextColor(grey, offWhite);
-        if(pinSources[i] > 100) {
+        if(pinSources[i] >= 200) { // fixed value
+          sprite.drawString(pinSources[i] == 200 ? "LOW" : "HIGH", sourceLabelX, pinBoxY+4);
+        }
+        else if(pinSources[i] > 100) {
           sprite.drawString("!" + String(pinLabels2[pinSources[i] - 100]), sourceLabelX, pinBoxY+4);
         }
-        else {
+        else if(pinSources[i] < 100) {
           sprite.drawString(String(pinLabels2[pinSources[i]]), sourceLabelX, pinBoxY+4);
         }
       }
       
       // State indicator for digital pins
       if(pinTypes[i]<4) { // shows HIGH/LOW state as coloured circle with 1/0
-        sprite.fillSmoothCircle(stateCircleX, pinBoxY+height/2, 5, stateColours[pinStates[i]], tftWhite);
-        sprite.setTextColor(tftWhite, stateColours[pinStates[i]]);
-        sprite.drawString(String(pinStates[i]), stateCircleX+1, 1+pinBoxY+height/2);
+        drawStateDot(pinStates[i], stateCircleX, pinBoxY+height/2);
       }
     }
   }
 
   // Draw pushbutton indicators
-  sprite.fillSmoothRoundRect(4, 294, 46, 22, 4, typeColours[pinTypes[24] - 1]);
-  sprite.fillSmoothRoundRect(6,296,24,18,2,grey);
-  sprite.fillSmoothRoundRect(120, 294, 46, 22, 4, typeColours[pinTypes[25] - 1]);
-  sprite.fillSmoothRoundRect(122, 296, 24, 18, 2, grey);
+  fillBox(sprite, 4, 294, 46, 22, 4, typeColours[pinTypes[24] - 1]);
+  fillBox(sprite, 6,296,24,18,2,grey);
+  fillBox(sprite, 120, 294, 46, 22, 4, typeColours[pinTypes[25] - 1]);
+  fillBox(sprite, 122, 296, 24, 18, 2, grey);
 
   // Draw UI instructions
   sprite.setTextColor(tftWhite, grey);
@@ -1024,7 +2382,7 @@ void drawDisplay() {
   sprite.drawString("for MENU", 85, 310);
 
   // Draw labels with custom font
-  sprite.loadFont(NotoSansBold15);
+  smoothFont();
   sprite.setTextColor(tftBlack, offWhite);
   sprite.drawString("PB1", 18, 288);
   sprite.drawString("PB2", 152, 288);
@@ -1046,23 +2404,23 @@ void drawDisplay() {
   sprite.drawString(String(pinStates[25]), 155, 306);
 
   // Left info panel (TIOS branding)
-  sprite.fillSmoothRoundRect(4, 212, 50, 58, 4, purple, offWhite);
+  fillBox(sprite, 4, 212, 50, 58, 4, purple, offWhite);
   sprite.setTextDatum(0);
   sprite.setTextColor(tftWhite, purple);
   sprite.drawString("TIOS", 11, 214);
-  sprite.unloadFont();
+  plainFont();
   sprite.drawString("T-Disp", 8, 229);
   sprite.drawString("Input", 8, 239);
   sprite.drawString("Output", 8, 249);
   sprite.drawString("System", 8, 259);
 
   // Right info panel (system info)
-  sprite.fillSmoothRoundRect(117, 212, 50, 58, 4, purple, offWhite);
-  sprite.loadFont(NotoSansBold15);
+  fillBox(sprite, 117, 212, 50, 58, 4, purple, offWhite);
+  smoothFont();
   sprite.setTextDatum(0);
   sprite.setTextColor(tftWhite, purple);
   sprite.drawString("INFO", 123, 214);
-  sprite.unloadFont();
+  plainFont();
   sprite.drawString("Uptime:", 121, 229);
   sprite.drawString(uptimeString, 121, 239); // uptime value
   sprite.drawString("FPS:" + String(int(fps)), 121, 249); // FPS value
@@ -1074,15 +2432,103 @@ void drawDisplay() {
   sprite.drawString("PWR:" + String(supplyVoltage, 1) + "V", 6, 82); // supply voltage
 
   // Draw screen brightness level (under left info panel)
-  sprite.drawString("SB:" + String(ledcRead(0)), 11, 272);
+  sprite.drawString("SB:" + String(backlightLevel()), 11, 272);
 
   // Draw analog smoothing level (under right info panel)
   sprite.drawString("AS:" + String(smoothingFactor), 121, 272);
 
   // Push the complete sprite to the display
-  sprite.unloadFont();
-  sprite.pushSprite(0, 0);
+  plainFont();
+  pushFrame();
+}
+
+
+#ifdef PLACEMENT_BENCHMARK
+// Function to measure the sprite RAM and push time at 16 bpp (RGB565, the original sprite)
+// and 4 bpp (palette) with the configured placement - the push does not depend on the
+// picture, so each depth pushes its sprite as created
+void benchmarkDepth() {
+  const int depths[2] = {16, 4};
+  const int frames = 50;
+
+  for(int d=0; d<2; d++) {
+    TFT_eSprite bench = TFT_eSprite(&lcd);
+    bench.setColorDepth(depths[d]);
+    bench.setAttribute(PSRAM_ENABLE, memPrefersPsram(SPRITE_PLACEMENT));
+
+    if(bench.createSprite(170, 320) == nullptr) {
+      Serial.printf("Benchmark %d bpp: %u bytes not available\n", depths[d], 170 * 320 * depths[d] / 8);
+      continue;
+    }
+
+    if(depths[d] == 4) {
+      bench.createPalette(spritePalette, 16);
+    }
+
+    unsigned long pushStart = micros();
+
+    for(int f=0; f<frames; f++) {
+      bench.pushSprite(0, 0);
+    }
+
+    Serial.printf("Benchmark %d bpp: %u bytes in %s, push %lu us per frame (%d frames)\n",
+                  depths[d], 170 * 320 * depths[d] / 8, memRegion(bench.getPointer()), (micros() - pushStart) / frames, frames);
+    bench.deleteSprite();
+  }
+}
+
+// Function to measure render and push throughput with the sprite in each memory region
+void benchmarkPlacement() {
+  const MemoryPolicy placements[2] = {MEM_FAST, MEM_BULK};
+  const int frames = 50;
+
+  for(int p=0; p<2; p++) {
+    sprite.deleteSprite();
+    createFramebuffer(placements[p]);
+
+    unsigned long totalMicros = 0;
+    unsigned long totalPushMicros = 0;
+
+    for(int f=0; f<frames; f++) {
+      unsigned long frameStart = micros();
+      drawDisplay();
+      totalMicros += micros() - frameStart;
+      totalPushMicros += pushMicros;
+    }
+
+    Serial.printf("Benchmark %s: render %lu us, push %lu us per frame (%d frames)\n",
+                  memRegion(sprite.getPointer()), (totalMicros - totalPushMicros) / frames, totalPushMicros / frames, frames);
+  }
+
+  sprite.deleteSprite();
+  benchmarkDepth(); // with the framebuffer freed, so the 16-bpp sprite fits
+  createFramebuffer(SPRITE_PLACEMENT);
+}
+#endif
+
+
+#ifdef FROZEN_BENCHMARK
+#ifndef FROZEN_CONFIG
+#error "FROZEN_BENCHMARK needs a frozen configuration (FROZEN_CONFIG)"
+#endif
+
+// Function to compare the cycles per scan of the frozen and the generic scan
+void benchmarkFrozen() {
+  const char *names[2] = {"generic", "frozen"};
+  const int scans = 1000;
+
+  for(int p=0; p<2; p++) {
+    uint32_t start = ESP.getCycleCount();
+
+    for(int n=0; n<scans; n++) {
+      p == 0 ? readPins() : readPinsFrozen();
+    }
+
+    uint32_t cycles = ESP.getCycleCount() - start;
+    Serial.printf("Benchmark %s scan: %lu cycles per scan (%d scans)\n", names[p], (unsigned long)(cycles / scans), scans);
+  }
 }
+#endif
 
 
 /*************************************************************
@@ -1090,86 +2536,175 @@ void drawDisplay() {
 **************************************************************/
 
 // SETUP
+// Outputs are driven from the stored configuration (and retained state) before anything
+// slow such as the display is initialized
 void setup() {
-  // Initialize buttons
-  pinMode(0, INPUT_PULLUP);  // BOOT button GPIO0
-  pinMode(14, INPUT_PULLUP); // KEY button GPIO14
-
-  /* For battery power - GPIO15 must be set to HIGH,
-   * otherwise nothing will be displayed when USB is not connected. */ 
-  pinMode(15, OUTPUT);
-  digitalWrite(15, HIGH);
+  // Initialize buttons (BOOT GPIO0, KEY GPIO14)
+  buttonsBegin();
 
   // Initialize EEPROM
   EEPROM.begin(EEPROM_SIZE);
 
-  // Load settings and setup pins
+  // Initialize PWM channel manager (channel 0 is kept for the backlight)
+  pwmBegin();
+  servoBegin();
+  touchInputBegin();
+  captureBegin();
+  pwmReserve(PWM_BACKLIGHT_CHANNEL, BACKLIGHT_FREQUENCY, BACKLIGHT_RESOLUTION);
+
+  // Read ADC calibration from eFuse and build the conversion tables
+  analogBegin();
+
+#ifdef EXPANDER_ENABLE
+  // I2C GPIO expanders (their pins are set up with the header pins)
+  expanderBus.begin(EXPANDER_SDA, EXPANDER_SCL, EXPANDER_FREQUENCY);
+  expanderBegin(expanderBus);
+#endif
+
+  // Load settings, setup pins, resume switch/timer state after a warm reset and drive outputs
+#ifdef FROZEN_CONFIG
+  frozenInstall(); // the frozen image is the stored configuration
+#endif
   readEprom();
+  headlessBegin(); // -DHEADLESS boots headless
   setupPins();
+  bootResumed = retainRestore();
+  readPins();
+  bootOutputsMicros = micros();
+
+  // Serial port for status reports
+  Serial.begin(115200);
+
+#ifdef MODBUS_ENABLE
+  modbusBegin(); // Modbus RTU slave on UART1
+#endif
+
+  /* For battery power - GPIO15 must be set to HIGH,
+   * otherwise nothing will be displayed when USB is not connected. */ 
+  pinMode(15, OUTPUT);
+  digitalWrite(15, HIGH);
 
-  // Initialize uptime & FPS counters
-  startTime = millis();
-  lastFrameTime = millis();
+  // Allocate the analog trend history
+  trendBegin();
 
   // Take initial supply voltage reading
   readSupplyVoltage();
 
+  // Housekeeping jobs, each at the rate it needs
+  jobAdd("supply", JOB_1HZ, readSupplyVoltage);
+  jobAdd("uptime", JOB_1HZ, calculateUptime);
+  jobAdd("fps", JOB_1HZ, calculateFPS);
+  jobAdd("memory", JOB_1HZ, memStatsSample);
+  jobAdd("touch", JOB_10HZ, touchInputsSample); // raw readings for the display
+  jobAdd("mirror", JOB_100HZ, mirrorPump);      // serial commands, mirror frames in pieces
+  jobAdd("status", JOB_1HZ, printStatus, 5);
+
   // Initialize display
   lcd.init();
-  sprite.createSprite(170, 320); // portrait mode
+  createFramebuffer(SPRITE_PLACEMENT);
+
+  // Initialize backlight PWM (GPIO38), initial brightness (0-255)
+  backlightBegin(150);
+
+#ifdef PLACEMENT_BENCHMARK
+  benchmarkPlacement();
+#endif
+
+  // Report where the large buffers ended up
+  memRegister("sprite", sprite.getPointer(), 170 * 320 * SPRITE_DEPTH / 8);
+  memRegister("font", NotoSansBold15, sizeof(NotoSansBold15));
+  memRegister("curve tables", curveTables, sizeof(curveTables));
+  memRegister("menu tables", firstMenu, sizeof(firstMenu));
+  memReport(Serial);
+  expanderReport(Serial, true);
+
+#ifdef FROZEN_CONFIG
+  Serial.printf("Frozen scan: %s\n", frozenActive ? "active" : "inactive (configuration differs, generic scan)");
+#endif
+
+#ifdef FROZEN_BENCHMARK
+  benchmarkFrozen();
+#endif
+
+  // Start the scan cycle with the stored period
+  scanBegin(scanCycle);
+  scanSetPeriod(scanPeriodIndex);
+}
+
+// Function to run the page of the current UI mode (one frame)
+void drawPage() {
+  // Operation mode (supply voltage, uptime and FPS are updated by their jobs)
+  if(uiMode == 0) {
+    drawDisplay(); // draw display
+    frameCount++;
+  }
+  
+  // Menu mode (sleeps until a button event or the next free-running scan)
+  else if(uiMode == 1) {
+    buttonsWait(20);
+    setPins(); // call menu system
+  }
+
+  // Trend view (I/O keeps running)
+  else if(uiMode == 2) {
+    drawTrend(); // draw trend view
+  }
 
-  // Initialize backlight PWM
-  ledcSetup(0, 10000, 8); // PWN channel, frequency, resolution
-  ledcAttachPin(38, 0);   // LCD backlight GPIO38, channel 0
-  ledcWrite(0, 150);      // channel 0, initial brightness (0-255)
+  // Scan statistics (I/O keeps running)
+  else if(uiMode == 3) {
+    scanPage(); // draw scan statistics
+  }
+
+  // Memory telemetry (I/O keeps running)
+  else {
+    memoryPage(); // draw heap and stack statistics
+  }
 }
 
 // MAIN LOOP
 void loop() {
-  // Handle timer 1
-  if(pinStates[26] == 0) {
-    if(millis() > currentTime[0] + timerIntervals[0][1]) {
-      pinStates[26] = 1;
-      currentTime[0] = millis();
-    }
+  // Scan cycle (runs in its own task when a fixed period is set)
+  if(!scanFixed()) {
+    scanFreeRun();
   }
-  else {
-    if(millis() > currentTime[0] + timerIntervals[0][0]) {
-      pinStates[26] = 0;
-      currentTime[0] = millis();
-    }
+
+  // Screen power - a button event that wakes an off screen is used up here
+  if(backlightService(pinStates)) {
+    menuRedraw = true; // the menu only draws on events
   }
 
-  // Handle timer 2
-  if(pinStates[27] == 0) {
-    if(millis() > currentTime[1] + timerIntervals[1][1]) {
-      pinStates[27] = 1;
-      currentTime[1] = millis();
+  // Headless - nothing is drawn but the menu and frames on request
+  if(headlessService(uiMode == 1)) {
+    pageButtons(); // both buttons - menu, one button - a frame
+
+    jobsRun();
+
+    if(headlessFrameDue()) {
+      drawPage();
+      memStatsFrame();
+      mirrorFrame();
     }
-  }
-  else {
-    if(millis() > currentTime[1] + timerIntervals[1][0]) {
-      pinStates[27] = 0;
-      currentTime[1] = millis();
+    else if(scanFixed()) {
+      buttonsWait(10); // scan in its own task - until a button event or the next 100 Hz job
     }
+
+    return;
   }
 
-  // Operation mode
-  if(uiMode == 0) {
-    // Read supply voltage level periodically
-    if (millis() - lastPowerRead >= powerReadInterval) {
-      readSupplyVoltage(); // call supply voltage calculator
-      lastPowerRead = millis();
+  // Screen off - nothing is drawn, the time goes to the scan (free run) or to sleep
+  if(!backlightScreenOn()) {
+    jobsRun();
+
+    if(scanFixed() || uiMode == 1) { // scan in its own task, or paused by the menu
+      buttonsWait(10); // until a button event or the next 100 Hz job
     }
 
-    calculateUptime(); // call uptime calculator
-    calculateFPS();    // call FPS calculator
-    readPins();        // read pin states
-    drawDisplay();     // draw display
-  }
-  
-  // Menu mode
-  else {
-    setPins(); // call menu system
+    return;
   }
+
+  pageButtons(); // both buttons - menu / back to run mode, page buttons
+  jobsRun();     // housekeeping jobs that are due
+  drawPage();    // operation, menu, trend, scan statistics or memory page
+  memStatsFrame(); // allocations per frame
+  mirrorFrame();   // screen mirror (when streaming)
 }
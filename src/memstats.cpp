@@ -0,0 +1,196 @@
+/*************************************************************
+********************** MEMORY TELEMETRY **********************
+**************************************************************/
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include <esp_timer.h>     // for the sample time stamps
+#include <esp_heap_caps.h> // for the heap statistics
+#include "memstats.h"
+#include "colours.h" // UI colours and sprite colour depth
+
+// Display objects (main.cpp)
+extern TFT_eSprite sprite;
+
+// Watched tasks - names as given to xTaskCreatePinnedToCore (loopTask is the Arduino loop)
+static const char *taskNames[MEMSTATS_TASKS] = {"loopTask", "scan", "buttons", "expanders", "modbus"};
+static const char *taskLabels[MEMSTATS_TASKS] = {"loop", "scan", "buttons", "expanders", "modbus"};
+
+// Allocation counters (written from every task and core)
+static volatile uint32_t allocCount = 0;
+static volatile uint32_t freeCount = 0;
+
+// Latest sample
+static unsigned long sampleSeconds = 0;
+static unsigned int freeHeap = 0;
+static unsigned int largestBlock = 0;
+static unsigned int minimumFree = 0;
+static unsigned int smallestLargest = 0xFFFFFFFF; // worst largest block seen
+static byte fragmentation = 0;                   // % of the free heap not in the largest block
+static int stackFree[MEMSTATS_TASKS];            // bytes never used (-1 = task not running)
+static float allocsPerFrame = 0;
+static float freesPerFrame = 0;
+
+// Per-frame counting
+static unsigned long frames = 0;
+static uint32_t frameAllocs = 0;  // counter value at the start of the frame
+static uint32_t peakAllocs = 0;   // most allocations in one frame
+static unsigned long lastFrames = 0;
+static uint32_t lastAllocs = 0;
+static uint32_t lastFrees = 0;
+
+
+#ifdef MEMORY_TRACKING
+/*
+Linker wrappers (-Wl,--wrap=malloc,--wrap=free,--wrap=calloc,--wrap=realloc):
+every call to the allocator, from the sketch, the Arduino core and the libraries,
+lands here first and is counted before being passed on.
+*/
+extern "C" {
+  void* __real_malloc(size_t size);
+  void __real_free(void *pointer);
+  void* __real_calloc(size_t count, size_t size);
+  void* __real_realloc(void *pointer, size_t size);
+
+  void* __wrap_malloc(size_t size) {
+    __atomic_fetch_add(&allocCount, 1, __ATOMIC_RELAXED);
+    return __real_malloc(size);
+  }
+
+  void __wrap_free(void *pointer) {
+    if(pointer != nullptr) {
+      __atomic_fetch_add(&freeCount, 1, __ATOMIC_RELAXED);
+    }
+
+    __real_free(pointer);
+  }
+
+  void* __wrap_calloc(size_t count, size_t size) {
+    __atomic_fetch_add(&allocCount, 1, __ATOMIC_RELAXED);
+    return __real_calloc(count, size);
+  }
+
+  void* __wrap_realloc(void *pointer, size_t size) {
+    if(size > 0) {
+      __atomic_fetch_add(&allocCount, 1, __ATOMIC_RELAXED);
+    }
+
+    if(pointer != nullptr) {
+      __atomic_fetch_add(&freeCount, 1, __ATOMIC_RELAXED);
+    }
+
+    return __real_realloc(pointer, size);
+  }
+}
+#endif
+
+
+// Function to count a frame (call once per loop() pass)
+void memStatsFrame() {
+  uint32_t allocs = allocCount;
+  peakAllocs = max(peakAllocs, allocs - frameAllocs);
+  frameAllocs = allocs;
+  frames++;
+}
+
+// Function to sample the heap and the task stacks (1 Hz job)
+void memStatsSample() {
+  sampleSeconds = esp_timer_get_time() / 1000000;
+  freeHeap = heap_caps_get_free_size(MALLOC_CAP_INTERNAL);
+  largestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL);
+  minimumFree = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
+  smallestLargest = min(smallestLargest, largestBlock);
+  fragmentation = freeHeap > 0 ? 100 - (unsigned long)largestBlock * 100 / freeHeap : 0;
+
+  for(int t=0; t<MEMSTATS_TASKS; t++) {
+    TaskHandle_t task = xTaskGetHandle(taskNames[t]);
+    stackFree[t] = task != nullptr ? (int)uxTaskGetStackHighWaterMark(task) : -1; // bytes on the ESP32
+  }
+
+  // Rates over the frames since the last sample
+  uint32_t allocs = allocCount;
+  uint32_t frees = freeCount;
+  unsigned long frameDelta = frames - lastFrames;
+
+  if(frameDelta > 0) {
+    allocsPerFrame = (float)(allocs - lastAllocs) / frameDelta;
+    freesPerFrame = (float)(frees - lastFrees) / frameDelta;
+  }
+
+  lastFrames = frames;
+  lastAllocs = allocs;
+  lastFrees = frees;
+}
+
+// Function to reset the worst-case values
+void memStatsReset() {
+  smallestLargest = largestBlock;
+  peakAllocs = 0;
+}
+
+// Function to print the latest sample as one line
+void memStatsReport(Print &out) {
+  out.printf("Memory %lu s: free %u, largest %u (worst %u), min free %u, frag %u%%",
+             sampleSeconds, freeHeap, largestBlock, smallestLargest, minimumFree, fragmentation);
+
+#ifdef MEMORY_TRACKING
+  out.printf(", allocs %.1f/frame (peak %u), frees %.1f/frame, total %u/%u",
+             allocsPerFrame, (unsigned)peakAllocs, freesPerFrame, (unsigned)allocCount, (unsigned)freeCount);
+#endif
+
+  for(int t=0, listed=0; t<MEMSTATS_TASKS; t++) {
+    if(stackFree[t] >= 0) {
+      out.printf(listed++ == 0 ? ", stack free %s:%d" : " %s:%d", taskLabels[t], stackFree[t]);
+    }
+  }
+
+  out.println();
+}
+
+// Function to draw the memory page
+void drawMemoryStats() {
+  sprite.fillSprite(tftBlack);
+  sprite.setTextDatum(0);
+  sprite.setTextColor(tftWhite, tftBlack);
+  sprite.drawString("MEMORY", 4, 4, 2);
+
+  sprite.setTextColor(offWhite, tftBlack);
+  sprite.drawString("Uptime    " + String(sampleSeconds) + " s", 4, 26);
+  sprite.drawString("Free      " + String(freeHeap), 4, 40);
+  sprite.drawString("Largest   " + String(largestBlock), 4, 50);
+  sprite.drawString("Worst     " + String(smallestLargest), 4, 60);
+  sprite.drawString("Min free  " + String(minimumFree), 4, 70);
+  sprite.drawString("Frag      " + String(fragmentation) + "%", 4, 80);
+
+  // Fragmentation bar (orange once half of the free heap is split off)
+  sprite.drawRect(4, 92, 162, 9, offWhite);
+  sprite.fillRect(5, 93, fragmentation * 160 / 100, 7, fragmentation < 50 ? seaGreen : orange);
+
+  sprite.setTextColor(tftWhite, tftBlack);
+  sprite.drawString("PER FRAME", 4, 112);
+  sprite.setTextColor(offWhite, tftBlack);
+#ifdef MEMORY_TRACKING
+  sprite.drawString("Allocs    " + String(allocsPerFrame, 1), 4, 124);
+  sprite.drawString("Frees     " + String(freesPerFrame, 1), 4, 134);
+  sprite.drawString("Peak      " + String((unsigned long)peakAllocs), 4, 144);
+#else
+  sprite.drawString("Build with MEMORY_TRACKING", 4, 124);
+#endif
+
+  sprite.setTextColor(tftWhite, tftBlack);
+  sprite.drawString("STACK FREE (bytes)", 4, 164);
+  sprite.setTextColor(offWhite, tftBlack);
+
+  for(int t=0, row=0; t<MEMSTATS_TASKS; t++) {
+    if(stackFree[t] >= 0) {
+      sprite.drawString(String(taskLabels[t]), 4, 176 + row * 10);
+      sprite.drawString(String(stackFree[t]), 70, 176 + row * 10);
+      row++;
+    }
+  }
+
+  sprite.drawString("SEL: print to serial", 4, 280);
+  sprite.drawString("OK: reset worst/peak", 4, 292);
+  sprite.drawString("BOTH: exit", 4, 304);
+  sprite.pushSprite(0, 0);
+}
@@ -0,0 +1,167 @@
+/*************************************************************
+********************** SCREEN MIRRORING **********************
+**************************************************************/
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include "fbcodec.h"
+#include "headless.h" // frames on request
+#include "mirror.h"
+#include "placement.h"
+
+// Display state (main.cpp)
+extern TFT_eSprite sprite;
+extern const uint16_t spritePalette[16];
+
+// Stream buffers and state
+static uint8_t *previousFrame = nullptr; // frame the receiver has (delta reference)
+static uint8_t *encoded = nullptr;       // frame being sent
+static size_t encodedBytes = 0;
+static size_t sentBytes = 0;
+static bool streaming = false;
+static bool keyRequested = false;
+static uint16_t frameNumber = 0;
+static unsigned long lastFrameTime = 0;
+
+// Statistics of the current stream
+static unsigned long framesSent = 0;
+static unsigned long keyFrames = 0;
+static unsigned long bytesSent = 0;
+static unsigned long maxEncodeMicros = 0;
+
+// Serial command line
+static char command[24];
+static byte commandLength = 0;
+
+
+// Function to get the format of the sprite
+static FbFormat spriteFormat() {
+  FbFormat format = {(uint16_t)sprite.width(), (uint16_t)sprite.height(), (uint8_t)sprite.getColorDepth()};
+  return format;
+}
+
+// Function to start streaming (allocates the buffers on the first start)
+void mirrorStart() {
+  if(mirrorStreaming()) {
+    return; // already on - a reset here would cut off the frame being sent
+  }
+
+  FbFormat format = spriteFormat();
+
+  if(previousFrame == nullptr) {
+    previousFrame = (uint8_t*)memAlloc("mirror frame", fbBytes(format), MEM_BULK);
+    encoded = (uint8_t*)memAlloc("mirror stream", fbEncodeBound(format), MEM_BULK);
+  }
+
+  if(previousFrame == nullptr || encoded == nullptr) {
+    Serial.println("Mirror: out of memory");
+    return;
+  }
+
+  streaming = true;
+  keyRequested = true;
+  encodedBytes = sentBytes = 0;
+  framesSent = keyFrames = bytesSent = maxEncodeMicros = 0;
+}
+
+// Function to stop streaming (a frame still being sent is cut off)
+void mirrorStop() {
+  if(streaming) {
+    streaming = false;
+    encodedBytes = sentBytes = 0;
+    mirrorReport(Serial);
+  }
+}
+
+// Function to check if the stream is on
+bool mirrorStreaming() {
+  return streaming;
+}
+
+// Function to encode the frame just drawn, when one is due (call after each drawn frame)
+void mirrorFrame() {
+  if(!streaming || sentBytes < encodedBytes || millis() - lastFrameTime < MIRROR_INTERVAL) {
+    return;
+  }
+
+  const uint8_t *frame = (const uint8_t*)sprite.getPointer();
+  FbFormat format = spriteFormat();
+  unsigned long encodeStart = micros();
+
+  if(frame == nullptr) {
+    return;
+  }
+
+  if(keyRequested || frameNumber % MIRROR_KEY_EVERY == 0) {
+    encodedBytes = fbEncodeKey(frame, format, spritePalette, frameNumber, encoded);
+    memcpy(previousFrame, frame, fbBytes(format));
+    keyRequested = false;
+    keyFrames++;
+  }
+  else {
+    encodedBytes = fbEncodeDelta(frame, previousFrame, format, frameNumber, encoded);
+  }
+
+  maxEncodeMicros = max(maxEncodeMicros, micros() - encodeStart);
+  lastFrameTime = millis();
+  sentBytes = 0;
+
+  if(encodedBytes > 0) { // unchanged frames are not sent
+    frameNumber++;
+    mirrorPump();
+  }
+}
+
+// Function to handle a serial command line
+static void runCommand() {
+  if(strcmp(command, "mirror on") == 0) {
+    mirrorStart();
+  }
+  else if(strcmp(command, "mirror off") == 0) {
+    mirrorStop();
+  }
+  else if(strcmp(command, "mirror key") == 0) {
+    keyRequested = true;
+  }
+  else if(strcmp(command, "frame") == 0) {
+    headlessRequestFrame(); // headless - draw one frame (mirrored when streaming)
+  }
+}
+
+// Function to read serial commands and send the next piece of the frame (job)
+void mirrorPump() {
+  while(Serial.available() > 0) {
+    char c = Serial.read();
+
+    if(c == '\n' || c == '\r') {
+      command[commandLength] = 0;
+      runCommand();
+      commandLength = 0;
+    }
+    else if(commandLength < sizeof(command) - 1) {
+      command[commandLength++] = c;
+    }
+  }
+
+  if(!streaming || sentBytes >= encodedBytes) {
+    return;
+  }
+
+  int space = Serial.availableForWrite();
+  size_t chunk = min(encodedBytes - sentBytes, (size_t)min(max(space, 0), MIRROR_CHUNK));
+
+  if(chunk > 0) {
+    Serial.write(encoded + sentBytes, chunk);
+    sentBytes += chunk;
+    bytesSent += chunk;
+
+    if(sentBytes == encodedBytes) {
+      framesSent++;
+    }
+  }
+}
+
+// Function to print the statistics of the stream
+void mirrorReport(Print &out) {
+  out.printf("Mirror: %lu frames (%lu key), %lu bytes, encode max %lu us\n", framesSent, keyFrames, bytesSent, maxEncodeMicros);
+}
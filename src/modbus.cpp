@@ -0,0 +1,206 @@
+/*************************************************************
+******************** MODBUS RTU SLAVE CORE *******************
+**************************************************************/
+
+#include <string.h>
+#include "modbus.h"
+
+// Function to calculate the Modbus CRC16 of a buffer
+uint16_t modbusCrc(const uint8_t *data, int length) {
+  uint16_t crc = 0xFFFF;
+
+  for(int i=0; i<length; i++) {
+    crc ^= data[i];
+
+    for(int b=0; b<8; b++) {
+      crc = (crc & 1) ? (crc >> 1) ^ 0xA001 : crc >> 1;
+    }
+  }
+
+  return crc;
+}
+
+// Function to read a big-endian 16-bit field
+static uint16_t field(const uint8_t *data) {
+  return (uint16_t)(data[0] << 8 | data[1]);
+}
+
+// Function to finish a response with its CRC (returns the frame length)
+static int finish(uint8_t *response, int length) {
+  uint16_t crc = modbusCrc(response, length);
+  response[length] = crc & 0xFF;
+  response[length+1] = crc >> 8;
+  return length + 2;
+}
+
+// Function to build an exception response
+static int exception(uint8_t *response, uint8_t function, uint8_t code) {
+  response[1] = function | 0x80;
+  response[2] = code;
+  return finish(response, 3);
+}
+
+// Function to pack bits into a read response
+static int readBits(uint8_t *response, const uint8_t *bits, uint16_t start, uint16_t count) {
+  int bytes = (count + 7) / 8;
+  response[2] = bytes;
+  memset(&response[3], 0, bytes);
+
+  for(int i=0; i<count; i++) {
+    if(bits[start + i]) {
+      response[3 + i/8] |= 1 << (i % 8);
+    }
+  }
+
+  return finish(response, 3 + bytes);
+}
+
+// Function to pack registers into a read response
+static int readRegisters(uint8_t *response, const uint16_t *registers, uint16_t start, uint16_t count) {
+  response[2] = count * 2;
+
+  for(int i=0; i<count; i++) {
+    response[3 + i*2] = registers[start + i] >> 8;
+    response[4 + i*2] = registers[start + i] & 0xFF;
+  }
+
+  return finish(response, 3 + count * 2);
+}
+
+// Function to validate and then commit a list of writes (returns an exception code or 0)
+static uint8_t applyWrites(ModbusWriteHandler onWrite, ModbusTable table, uint16_t start, const uint16_t *values, int count) {
+  for(int pass=0; pass<2; pass++) {
+    for(int i=0; i<count; i++) {
+      uint8_t result = onWrite(table, start + i, values[i], pass == 1);
+
+      if(result != 0) {
+        return result;
+      }
+    }
+  }
+
+  return 0;
+}
+
+// Function to process one request frame (returns the response length, 0 = no response)
+int modbusProcess(uint8_t slaveId, const uint8_t *request, int length, const ModbusImage &image,
+                  ModbusWriteHandler onWrite, uint8_t *response) {
+  if(length < 4 || modbusCrc(request, length - 2) != (uint16_t)(request[length-2] | request[length-1] << 8)) {
+    return 0; // too short or corrupted - silently ignored as the spec requires
+  }
+
+  bool broadcast = request[0] == 0;
+
+  if(!broadcast && request[0] != slaveId) {
+    return 0;
+  }
+
+  uint8_t function = request[1];
+  response[0] = slaveId;
+  response[1] = function;
+
+  if(length < 8) {
+    return broadcast ? 0 : exception(response, function, MODBUS_ILLEGAL_VALUE);
+  }
+
+  uint16_t start = field(&request[2]);
+  uint16_t count = field(&request[4]);
+  int result = 0;
+  uint16_t values[MODBUS_HOLDING_REGS];
+
+  switch(function) {
+    case 0x01: // read coils
+    case 0x02: // read discrete inputs
+    {
+      int size = function == 0x01 ? MODBUS_COILS : MODBUS_DISCRETES;
+
+      if(count < 1 || count > 2000) {
+        return broadcast ? 0 : exception(response, function, MODBUS_ILLEGAL_VALUE);
+      }
+
+      if(start + count > size) {
+        return broadcast ? 0 : exception(response, function, MODBUS_ILLEGAL_ADDRESS);
+      }
+
+      result = readBits(response, function == 0x01 ? image.coils : image.discretes, start, count);
+      break;
+    }
+
+    case 0x03: // read holding registers
+    case 0x04: // read input registers
+    {
+      int size = function == 0x03 ? MODBUS_HOLDING_REGS : MODBUS_INPUT_REGS;
+
+      if(count < 1 || count > 125) {
+        return broadcast ? 0 : exception(response, function, MODBUS_ILLEGAL_VALUE);
+      }
+
+      if(start + count > size) {
+        return broadcast ? 0 : exception(response, function, MODBUS_ILLEGAL_ADDRESS);
+      }
+
+      result = readRegisters(response, function == 0x03 ? image.holdingRegs : image.inputRegs, start, count);
+      break;
+    }
+
+    case 0x05: // write single coil (count field holds 0xFF00 or 0x0000)
+    case 0x06: // write single register (count field holds the value)
+    {
+      ModbusTable table = function == 0x05 ? MODBUS_COIL : MODBUS_HOLDING;
+
+      if(start >= (function == 0x05 ? MODBUS_COILS : MODBUS_HOLDING_REGS)) {
+        return broadcast ? 0 : exception(response, function, MODBUS_ILLEGAL_ADDRESS);
+      }
+
+      if(function == 0x05 && count != 0xFF00 && count != 0x0000) {
+        return broadcast ? 0 : exception(response, function, MODBUS_ILLEGAL_VALUE);
+      }
+
+      values[0] = function == 0x05 ? (count == 0xFF00) : count;
+      uint8_t code = applyWrites(onWrite, table, start, values, 1);
+
+      if(code != 0) {
+        return broadcast ? 0 : exception(response, function, code);
+      }
+
+      memcpy(response, request, 6); // echo of the request
+      result = finish(response, 6);
+      break;
+    }
+
+    case 0x0F: // write multiple coils
+    case 0x10: // write multiple registers
+    {
+      bool coils = function == 0x0F;
+      int size = coils ? MODBUS_COILS : MODBUS_HOLDING_REGS;
+      int bytes = coils ? (count + 7) / 8 : count * 2;
+
+      if(count < 1 || count > (coils ? 1968 : 123) || length < 9 + bytes || request[6] != bytes) {
+        return broadcast ? 0 : exception(response, function, MODBUS_ILLEGAL_VALUE);
+      }
+
+      if(start + count > size) {
+        return broadcast ? 0 : exception(response, function, MODBUS_ILLEGAL_ADDRESS);
+      }
+
+      for(int i=0; i<count; i++) {
+        values[i] = coils ? (request[7 + i/8] >> (i % 8)) & 1 : field(&request[7 + i*2]);
+      }
+
+      uint8_t code = applyWrites(onWrite, coils ? MODBUS_COIL : MODBUS_HOLDING, start, values, count);
+
+      if(code != 0) {
+        return broadcast ? 0 : exception(response, function, code);
+      }
+
+      memcpy(response, request, 6); // address and quantity
+      result = finish(response, 6);
+      break;
+    }
+
+    default:
+      return broadcast ? 0 : exception(response, function, MODBUS_ILLEGAL_FUNCTION);
+  }
+
+  return broadcast ? 0 : result;
+}
@@ -0,0 +1,296 @@
+/*************************************************************
+******************** MODBUS RTU UART SLAVE *******************
+**************************************************************/
+
+#include <Arduino.h>
+#include <driver/uart.h> // for the receive FIFO threshold
+#include <esp_timer.h>   // for the 64-bit uptime clock
+#include "modbus.h"
+#include "modbus_slave.h"
+#include "signals.h" // signal table layout
+#include "touch_input.h" // touch-capable pins
+#include "capture.h"     // capture high times
+#include "servo.h"       // servo modes
+
+#define WRITE_QUEUE_SIZE 128 // larger than any single write request
+#define MODBUS_UART UART_NUM_1
+
+// Runtime state and configuration (main.cpp)
+extern byte pinTypes[SIGNAL_COUNT];
+extern byte pinSources[SIGNAL_COUNT];
+extern int pinStates[SIGNAL_COUNT];
+extern int pinMillivolts[24];
+extern int millivolts;
+extern float fps;
+extern float smoothingFactor;
+extern byte timerBaseValues[4];
+extern byte timerMultipliers[4];
+extern byte timerSources[4];
+extern int pins[24];
+int setupPins();
+void writeEprom();
+
+// Queued write (applied by the scan)
+struct ModbusWrite {
+  byte table;
+  uint16_t address;
+  uint16_t value;
+};
+
+// Double-buffered register image - the task only reads images[frontImage]
+static ModbusImage images[2];
+static volatile int frontImage = 0;
+static SemaphoreHandle_t imageLock;
+static QueueHandle_t writeQueue;
+static unsigned long frameGap; // t3.5 silence (us)
+
+
+// Function to check if a signal is digital (0/1), so it can drive an output or a burst
+static bool digitalSignal(int signal) {
+  if(signal < 24 || (signal >= SIGNAL_EXPANDERS && signal < SIGNAL_TIMER_BLOCKS)) { // INP, SW, OUT or TCH pin
+    return pinTypes[signal] == 1 || pinTypes[signal] == 2 || pinTypes[signal] == 3 || pinTypes[signal] == 8;
+  }
+
+  return signal < SIGNAL_COUNT; // buttons, timers, comparators and timer blocks
+}
+
+// Function to check a pin source against the type of the pin, as the menu offers them
+static bool validSource(int pin, uint16_t value) {
+  bool digital = value == 100 || value == 200 || value == 201 || // none, fixed LOW/HIGH
+                 (value < 100 && digitalSignal(value)) || (value > 100 && value < 200 && digitalSignal(value - 100));
+  bool analog = (value >= 100 && value <= 255) || (value < 24 && (pinTypes[value] == 4 || pinTypes[value] == 9)); // none, fixed value or ANA/CAP pin
+
+  switch(pinTypes[pin]) {
+    case 3: return digital;                                               // OUT
+    case 5: return analog;                                                // PWM
+    case 7: return servoModes[pin] == SERVO_PULSE ? analog : digital;     // servo value or burst trigger
+    default: return value == 100;                                         // no source
+  }
+}
+
+// Function to check a write against the register map (runs in the Modbus task)
+static uint8_t validateWrite(ModbusTable table, uint16_t address, uint16_t value) {
+  if(table == MODBUS_COIL) {
+    return pinTypes[address] == 3 ? 0 : MODBUS_ILLEGAL_ADDRESS; // outputs only
+  }
+
+  if(address <= 3) { // timer base values
+    return value <= 255 ? 0 : MODBUS_ILLEGAL_VALUE;
+  }
+
+  if(address >= 4 && address <= 7) { // timer multipliers
+    return value >= 1 && value <= 255 ? 0 : MODBUS_ILLEGAL_VALUE;
+  }
+
+  if(address >= 8 && address <= 11) { // timer sources (0 = fixed)
+    return value < SIGNAL_COUNT ? 0 : MODBUS_ILLEGAL_VALUE;
+  }
+
+  if(address >= 16 && address <= 39) { // pin types
+    return (value <= 5 || value == 7 || value == 9 || (value == 8 && touchCapable(pins[address-16]))) && pins[address-16] != 100 && !modbusOwnsPin(pins[address-16]) ? 0 : MODBUS_ILLEGAL_VALUE;
+  }
+
+  if(address >= 48 && address <= 71) { // pin sources (per pin type)
+    return validSource(address-48, value) ? 0 : MODBUS_ILLEGAL_VALUE;
+  }
+
+  if(address == 96) { // smoothing x1000
+    return value <= 1000 ? 0 : MODBUS_ILLEGAL_VALUE;
+  }
+
+  if(address == 100) { // command
+    return value == 1 || value == 2 ? 0 : MODBUS_ILLEGAL_VALUE;
+  }
+
+  return MODBUS_ILLEGAL_ADDRESS;
+}
+
+// Function to validate or queue a write for the next scan (runs in the Modbus task)
+static uint8_t queueWrite(ModbusTable table, uint16_t address, uint16_t value, bool commit) {
+  if(!commit) {
+    return validateWrite(table, address, value);
+  }
+
+  ModbusWrite write = {(byte)table, address, value};
+  return xQueueSend(writeQueue, &write, 0) == pdTRUE ? 0 : MODBUS_DEVICE_BUSY;
+}
+
+// Frame being received (Modbus task)
+static uint8_t request[MODBUS_MAX_FRAME];
+static uint8_t response[MODBUS_MAX_FRAME];
+static int requestLength = 0;
+static bool overflow = false;
+static unsigned long lastByteTime = 0;
+
+
+// Function to receive bytes and answer a frame once it is complete (Modbus task, core 0)
+void modbusPoll() {
+  while(Serial1.available()) {
+    int value = Serial1.read();
+
+    if(requestLength < MODBUS_MAX_FRAME) {
+      request[requestLength++] = value;
+    }
+    else {
+      overflow = true; // oversized frame - dropped
+    }
+
+    lastByteTime = micros();
+  }
+
+  // A silence of t3.5 ends the frame
+  if(requestLength > 0 && micros() - lastByteTime >= frameGap) {
+    if(!overflow) {
+      xSemaphoreTake(imageLock, portMAX_DELAY);
+      int responseLength = modbusProcess(MODBUS_ID, request, requestLength, images[frontImage], queueWrite, response);
+      xSemaphoreGive(imageLock);
+
+      if(responseLength > 0) {
+        Serial1.write(response, responseLength);
+      }
+    }
+
+    requestLength = 0;
+    overflow = false;
+  }
+}
+
+// Function to run the slave (Modbus task, core 0)
+static void modbusTask(void *parameter) {
+  for(;;) {
+    modbusPoll();
+    vTaskDelay(1);
+  }
+}
+
+// Function to start the slave (UART, image and task)
+void modbusBegin() {
+  unsigned long charMicros = 11000000UL / MODBUS_BAUD; // 11 bits per RTU character
+  frameGap = MODBUS_BAUD > 19200 ? 1750 : charMicros * 7 / 2;
+
+  imageLock = xSemaphoreCreateMutex();
+  writeQueue = xQueueCreate(WRITE_QUEUE_SIZE, sizeof(ModbusWrite));
+  modbusUpdate(false);
+
+  Serial1.setRxBufferSize(MODBUS_MAX_FRAME * 2);
+  Serial1.begin(MODBUS_BAUD, SERIAL_8N1, MODBUS_RX_PIN, MODBUS_TX_PIN);
+
+  // Hand received bytes to the task well within t3.5, so a long frame is never split
+  int threshold = constrain((int)(frameGap / charMicros / 2), 1, 120);
+  uart_set_rx_full_threshold(MODBUS_UART, threshold);
+  uart_set_rx_timeout(MODBUS_UART, 1);
+
+  xTaskCreatePinnedToCore(modbusTask, "modbus", 4096, nullptr, 2, nullptr, 0);
+}
+
+// Function to apply one queued write (returns true if the pin configuration changed)
+static bool applyWrite(const ModbusWrite &write, bool &save) {
+  uint16_t address = write.address;
+
+  if(write.table == MODBUS_COIL) {
+    pinSources[address] = write.value ? 201 : 200; // fixed HIGH/LOW
+    return false;
+  }
+
+  if(address <= 3) {
+    timerBaseValues[address] = write.value;
+  }
+  else if(address <= 7) {
+    timerMultipliers[address-4] = write.value;
+  }
+  else if(address <= 11) {
+    timerSources[address-8] = write.value;
+  }
+  else if(address >= 16 && address <= 39) {
+    if(pinTypes[address-16] != write.value) {
+      pinTypes[address-16] = write.value;
+      pinSources[address-16] = 100; // a new type starts without a source, as in the menu
+    }
+
+    return true;
+  }
+  else if(address >= 48 && address <= 71) {
+    pinSources[address-48] = write.value;
+  }
+  else if(address == 96) {
+    smoothingFactor = write.value / 1000.0f;
+  }
+  else if(address == 100) {
+    save = write.value == 2;
+    return true;
+  }
+
+  return false;
+}
+
+// Function to rebuild the register image and apply queued writes (called once per scan)
+void modbusUpdate(bool applyWrites) {
+  // Apply writes first so the new image already shows them
+  if(applyWrites) {
+    ModbusWrite write;
+    bool configChanged = false;
+    bool save = false;
+
+    while(xQueueReceive(writeQueue, &write, 0) == pdTRUE) {
+      configChanged |= applyWrite(write, save);
+    }
+
+    if(save) {
+      writeEprom();
+    }
+
+    if(configChanged) {
+      setupPins();
+    }
+  }
+
+  ModbusImage &image = images[1 - frontImage];
+
+  for(int i=0; i<MODBUS_COILS; i++) {
+    image.coils[i] = pinStates[i] != 0;
+  }
+
+  for(int i=0; i<MODBUS_DISCRETES; i++) {
+    image.discretes[i] = pinStates[i] != 0;
+  }
+
+  for(int i=0; i<SIGNAL_EXPANDERS; i++) { // expander pins are digital - discretes only
+    image.inputRegs[i] = pinStates[i];
+  }
+
+  for(int i=0; i<24; i++) {
+    image.inputRegs[32+i] = pinTypes[i] == 9 ? min(captureHighMicros[i], (uint32_t)65535) : pinMillivolts[i];
+    image.holdingRegs[16+i] = pinTypes[i];
+    image.holdingRegs[48+i] = pinSources[i];
+  }
+
+  unsigned long seconds = esp_timer_get_time() / 1000000; // millis() wraps after 49.7 days
+  image.inputRegs[64] = millivolts;
+  image.inputRegs[65] = seconds >> 16;
+  image.inputRegs[66] = seconds & 0xFFFF;
+  image.inputRegs[67] = fps + 0.5f;
+
+  for(int i=0; i<4; i++) {
+    image.holdingRegs[i] = timerBaseValues[i];
+    image.holdingRegs[4+i] = timerMultipliers[i];
+    image.holdingRegs[8+i] = timerSources[i];
+  }
+
+  image.holdingRegs[96] = smoothingFactor * 1000 + 0.5f;
+  image.holdingRegs[100] = 0;
+
+  // Swap without waiting - if a request is being served the image is rebuilt next scan
+  if(xSemaphoreTake(imageLock, 0) == pdTRUE) {
+    frontImage = 1 - frontImage;
+    xSemaphoreGive(imageLock);
+  }
+}
+
+// Function to check if a GPIO is used by the Modbus UART
+bool modbusOwnsPin(int gpio) {
+#ifdef MODBUS_ENABLE
+  return gpio == MODBUS_TX_PIN || gpio == MODBUS_RX_PIN;
+#else
+  return false;
+#endif
+}
@@ -0,0 +1,84 @@
+/*************************************************************
+****************** MEMORY PLACEMENT & MAP ********************
+**************************************************************/
+
+#include <Arduino.h>
+#include <esp_heap_caps.h>          // for capability-based allocation
+#include <soc/soc_memory_layout.h> // for address range checks
+#include "placement.h"
+
+// Memory map entries
+static const char *mapNames[MEMORY_MAP_SIZE];
+static const void *mapAddresses[MEMORY_MAP_SIZE];
+static size_t mapSizes[MEMORY_MAP_SIZE];
+static int mapCount = 0;
+
+
+// Function to check if a policy should place its buffers in PSRAM
+bool memPrefersPsram(MemoryPolicy policy) {
+  return policy == MEM_BULK && psramFound();
+}
+
+// Function to record a buffer in the memory map
+void memRegister(const char *name, const void *address, size_t bytes) {
+  if(mapCount < MEMORY_MAP_SIZE) {
+    mapNames[mapCount] = name;
+    mapAddresses[mapCount] = address;
+    mapSizes[mapCount] = bytes;
+    mapCount++;
+  }
+}
+
+// Function to allocate a buffer according to a placement policy (zero filled)
+void* memAlloc(const char *name, size_t bytes, MemoryPolicy policy) {
+  const uint32_t internalCaps = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+  const uint32_t psramCaps = MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT;
+  void *buffer = nullptr;
+
+  if(memPrefersPsram(policy)) {
+    buffer = heap_caps_calloc(1, bytes, psramCaps);
+  }
+
+  if(buffer == nullptr) {
+    buffer = heap_caps_calloc(1, bytes, internalCaps);
+  }
+
+  if(buffer == nullptr && psramFound()) { // internal SRAM exhausted
+    buffer = heap_caps_calloc(1, bytes, psramCaps);
+  }
+
+  if(buffer != nullptr) {
+    memRegister(name, buffer, bytes);
+  }
+
+  return buffer;
+}
+
+// Function to name the memory region an address belongs to
+const char* memRegion(const void *address) {
+  if(esp_ptr_external_ram(address)) {
+    return "PSRAM";
+  }
+
+  if(esp_ptr_internal(address)) {
+    return "SRAM";
+  }
+
+  return "FLASH";
+}
+
+// Function to print the memory map and heap totals
+void memReport(Print &out) {
+  out.println("Memory map:");
+
+  for(int i=0; i<mapCount; i++) {
+    out.printf("  %-16s %7u bytes  %-5s  %p\n", mapNames[i], (unsigned)mapSizes[i], memRegion(mapAddresses[i]), mapAddresses[i]);
+  }
+
+  out.printf("  SRAM free: %u bytes (largest block %u)\n",
+             (unsigned)heap_caps_get_free_size(MALLOC_CAP_INTERNAL),
+             (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL));
+  out.printf("  PSRAM free: %u of %u bytes\n",
+             (unsigned)heap_caps_get_free_size(MALLOC_CAP_SPIRAM),
+             (unsigned)heap_caps_get_total_size(MALLOC_CAP_SPIRAM));
+}
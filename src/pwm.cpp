@@ -0,0 +1,181 @@
+/*************************************************************
+********************* PWM CHANNEL MANAGER ********************
+**************************************************************/
+
+#include <Arduino.h>
+#include <driver/ledc.h> // for ledc hardware fades
+#include "pwm.h"
+#include "curves.h" // per-pin transfer curves
+
+#define CHANNEL_FREE 255     // channel owner: unused
+#define CHANNEL_RESERVED 254 // channel owner: used outside the manager (backlight)
+#define NO_GPIO 255
+
+// Preset tables - order must match the "PWM FREQ" and "PWM FADE" menus
+const unsigned long pwmPresetFrequencies[PWM_PRESETS] = {5000, 1000, 20000, 50, 40000};
+const byte pwmPresetResolutions[PWM_PRESETS] = {8, 10, 8, 14, 10};
+const unsigned int pwmFadeTimes[PWM_FADES] = {0, 50, 200, 500, 1000}; // ms (0 = no fade)
+
+// Per-pin configuration and channel mapping
+byte pwmPresets[PWM_SLOTS] = {0};
+byte pwmFades[PWM_SLOTS] = {0};
+byte pwmChannels[PWM_SLOTS];
+
+// Channel bookkeeping
+static byte channelOwners[PWM_CHANNELS];
+static unsigned long channelFrequencies[PWM_CHANNELS];
+static byte channelResolutions[PWM_CHANNELS];
+
+// Per-slot output state
+static byte slotGpios[PWM_SLOTS];
+static int lastDuty[PWM_SLOTS];
+static unsigned long fadeEndTime[PWM_SLOTS];
+
+
+// Function to find a free channel for a frequency/resolution pair
+static byte findChannel(unsigned long frequency, byte resolution) {
+  // Prefer a channel whose timer partner already runs at the same setting
+  for(byte c=0; c<PWM_CHANNELS; c++) {
+    byte partner = c ^ 1;
+
+    if(channelOwners[c] == CHANNEL_FREE && channelOwners[partner] != CHANNEL_FREE &&
+       channelFrequencies[partner] == frequency && channelResolutions[partner] == resolution) {
+      return c;
+    }
+  }
+
+  // Otherwise take a channel from a completely unused timer
+  for(byte c=0; c<PWM_CHANNELS; c++) {
+    if(channelOwners[c] == CHANNEL_FREE && channelOwners[c ^ 1] == CHANNEL_FREE) {
+      return c;
+    }
+  }
+
+  return PWM_NO_CHANNEL;
+}
+
+// Function to initialize the channel manager (call once before any attach)
+void pwmBegin() {
+  for(byte c=0; c<PWM_CHANNELS; c++) {
+    channelOwners[c] = CHANNEL_FREE;
+  }
+
+  for(int i=0; i<PWM_SLOTS; i++) {
+    pwmChannels[i] = PWM_NO_CHANNEL;
+    slotGpios[i] = NO_GPIO;
+    lastDuty[i] = -1;
+  }
+
+  ledc_fade_func_install(0); // enable ledc hardware fades
+}
+
+// Function to mark a channel as used outside the manager
+void pwmReserve(byte channel, unsigned long frequency, byte resolution) {
+  channelOwners[channel] = CHANNEL_RESERVED;
+  channelFrequencies[channel] = frequency;
+  channelResolutions[channel] = resolution;
+}
+
+// Function to attach a pin slot to a channel (returns false when using the digital fallback)
+bool pwmAttach(int slot, int gpio) {
+  if(pwmPresets[slot] >= PWM_PRESETS) {
+    pwmPresets[slot] = 0;
+  }
+
+  unsigned long frequency = pwmPresetFrequencies[pwmPresets[slot]];
+  byte resolution = pwmPresetResolutions[pwmPresets[slot]];
+  byte channel = pwmChannels[slot];
+
+  // Keep the current channel if the setting has not changed (the curve may still have)
+  if(channel != PWM_NO_CHANNEL && slotGpios[slot] == gpio &&
+     channelFrequencies[channel] == frequency && channelResolutions[channel] == resolution) {
+    if(curveBuild(slot, resolution)) {
+      lastDuty[slot] = -1; // new curve - rewrite the duty
+    }
+
+    return true;
+  }
+
+  // Already on the digital fallback and still no channel free - leave the output running
+  if(channel == PWM_NO_CHANNEL && slotGpios[slot] == gpio && findChannel(frequency, resolution) == PWM_NO_CHANNEL) {
+    if(curveBuild(slot, 1)) {
+      lastDuty[slot] = -1;
+    }
+
+    return false;
+  }
+
+  pwmDetach(slot);
+  slotGpios[slot] = gpio;
+  lastDuty[slot] = -1;
+  fadeEndTime[slot] = 0;
+
+  channel = findChannel(frequency, resolution);
+
+  if(channel == PWM_NO_CHANNEL) { // out of channels - drive as digital output
+    curveBuild(slot, 1);
+    pinMode(gpio, OUTPUT);
+    digitalWrite(gpio, 0);
+    return false;
+  }
+
+  channelOwners[channel] = slot;
+  channelFrequencies[channel] = frequency;
+  channelResolutions[channel] = resolution;
+  pwmChannels[slot] = channel;
+  curveBuild(slot, resolution);
+
+  ledcSetup(channel, frequency, resolution);
+  ledcAttachPin(gpio, channel);
+  ledcWrite(channel, 0);
+
+  return true;
+}
+
+// Function to release a pin slot and its channel
+void pwmDetach(int slot) {
+  byte channel = pwmChannels[slot];
+
+  if(channel != PWM_NO_CHANNEL) {
+    ledcWrite(channel, 0);
+    ledcDetachPin(slotGpios[slot]);
+    channelOwners[channel] = CHANNEL_FREE;
+    pwmChannels[slot] = PWM_NO_CHANNEL;
+  }
+
+  slotGpios[slot] = NO_GPIO;
+}
+
+// Function to set the duty (0-255) of a pin slot - only writes on change
+void pwmWrite(int slot, int duty) {
+  if(slotGpios[slot] == NO_GPIO || duty == lastDuty[slot]) {
+    return;
+  }
+
+  byte channel = pwmChannels[slot];
+
+  if(channel == PWM_NO_CHANNEL) { // digital fallback
+    lastDuty[slot] = duty;
+    digitalWrite(slotGpios[slot], curveTables[slot][duty]);
+    return;
+  }
+
+  uint32_t scaled = curveTables[slot][duty]; // curve already scaled to the channel resolution
+  unsigned int fadeTime = pwmFadeTimes[pwmFades[slot] < PWM_FADES ? pwmFades[slot] : 0];
+
+  if(fadeTime == 0) {
+    lastDuty[slot] = duty;
+    ledcWrite(channel, scaled);
+    return;
+  }
+
+  // A running fade would block the next fade call, so retry once it has finished
+  if((long)(millis() - fadeEndTime[slot]) < 0) {
+    return;
+  }
+
+  lastDuty[slot] = duty;
+  fadeEndTime[slot] = millis() + fadeTime + 1;
+  ledc_set_fade_with_time(LEDC_LOW_SPEED_MODE, (ledc_channel_t)channel, scaled, fadeTime);
+  ledc_fade_start(LEDC_LOW_SPEED_MODE, (ledc_channel_t)channel, LEDC_FADE_NO_WAIT);
+}
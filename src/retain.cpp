@@ -0,0 +1,99 @@
+/*************************************************************
+******************* RETAINED RUNTIME STATE *******************
+**************************************************************/
+
+#include <Arduino.h>
+#include <esp_system.h> // for esp_reset_reason()
+#include "retain.h"
+#include "signals.h" // signal table layout
+
+#define RETAIN_MAGIC 0x54494F53 // "TIOS"
+
+// Runtime state (main.cpp)
+extern byte pinTypes[SIGNAL_COUNT];
+extern byte pinSources[SIGNAL_COUNT];
+extern int pinStates[SIGNAL_COUNT];
+extern bool pinButtonPressed[SIGNAL_COUNT];
+extern unsigned long currentTime[2];
+
+// State kept in RTC memory across warm resets
+struct RetainedState {
+  uint32_t magic;
+  uint32_t configHash;            // pin configuration the state belongs to
+  bool switchStates[SIGNAL_COUNT]; // ON/OFF switch toggles
+  byte timerStates[2];            // T1/T2 output level
+  unsigned long timerElapsed[2];  // ms spent in the current timer phase
+  uint32_t checksum;
+};
+
+RTC_NOINIT_ATTR static RetainedState retained;
+static uint32_t appliedHash = 0; // hash of the configuration set up by setupPins()
+
+
+// Function to hash the pin configuration (FNV-1a)
+static uint32_t configHash() {
+  uint32_t hash = 2166136261UL;
+
+  for(int i=0; i<SIGNAL_COUNT; i++) {
+    hash = (hash ^ pinTypes[i]) * 16777619UL;
+    hash = (hash ^ pinSources[i]) * 16777619UL;
+  }
+
+  return hash;
+}
+
+// Function to checksum the retained state (everything before the checksum field)
+static uint32_t stateChecksum() {
+  const uint8_t *bytes = (const uint8_t*)&retained;
+  uint32_t sum = 0;
+
+  for(size_t i=0; i<offsetof(RetainedState, checksum); i++) {
+    sum = (sum << 1 | sum >> 31) + bytes[i];
+  }
+
+  return sum;
+}
+
+// Function to restore switch and timer state after a warm reset (true if restored)
+bool retainRestore() {
+  if(esp_reset_reason() == ESP_RST_POWERON || retained.magic != RETAIN_MAGIC ||
+     retained.checksum != stateChecksum() || retained.configHash != configHash()) {
+    return false;
+  }
+
+  for(int i=0; i<SIGNAL_COUNT; i++) {
+    if(pinTypes[i] == 2) { // ON/OFF switch
+      pinButtonPressed[i] = retained.switchStates[i];
+      pinStates[i] = retained.switchStates[i];
+    }
+  }
+
+  for(int t=0; t<2; t++) {
+    pinStates[26+t] = retained.timerStates[t];
+    currentTime[t] = millis() - retained.timerElapsed[t];
+  }
+
+  return true;
+}
+
+// Function to note the pin configuration that was set up (called by setupPins)
+void retainConfigure() {
+  appliedHash = configHash();
+}
+
+// Function to mirror the runtime state into RTC memory (called every scan)
+void retainSave() {
+  retained.magic = RETAIN_MAGIC;
+  retained.configHash = appliedHash;
+
+  for(int i=0; i<SIGNAL_COUNT; i++) {
+    retained.switchStates[i] = pinButtonPressed[i];
+  }
+
+  for(int t=0; t<2; t++) {
+    retained.timerStates[t] = pinStates[26+t];
+    retained.timerElapsed[t] = millis() - currentTime[t];
+  }
+
+  retained.checksum = stateChecksum();
+}
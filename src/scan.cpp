@@ -0,0 +1,248 @@
+/*************************************************************
+************************* SCAN CYCLE *************************
+**************************************************************/
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include <esp_timer.h> // for the cycle timer
+#include "scan.h"
+#include "colours.h" // UI colours and sprite colour depth
+
+// Display objects (main.cpp)
+extern TFT_eSprite sprite;
+
+// Period table - order must match the "SCAN CYCLE" menu
+const unsigned int scanPeriods[SCAN_PERIODS] = {0, 1000, 5000, 10000};
+const unsigned int scanBinLimits[SCAN_BINS-1] = {10, 20, 50, 100, 200, 500, 1000, 2000, 5000};
+
+// Cycle state
+static void (*cycleFunction)() = nullptr;
+static byte period = 0;
+static esp_timer_handle_t cycleTimer;
+static TaskHandle_t scanTask;
+static int64_t nextDue = 0; // start time of the next cycle (us)
+
+// Statistics
+static unsigned long jitterBins[SCAN_BINS];
+static unsigned long execBins[SCAN_BINS];
+static unsigned long cycleCount = 0;
+static unsigned long overruns = 0;
+static unsigned long maxJitter = 0;
+static unsigned long maxExec = 0;
+static uint64_t totalExec = 0;
+static unsigned long cycleRate = 0;  // cycles in the last second
+static int64_t rateStart = 0;
+static unsigned long rateCycles = 0; // cycle count at rateStart
+
+
+// Function to find the histogram bucket of a time
+static int binOf(unsigned long micros) {
+  int bin = 0;
+
+  while(bin < SCAN_BINS-1 && micros >= scanBinLimits[bin]) {
+    bin++;
+  }
+
+  return bin;
+}
+
+// Function to run and time one cycle (jitter < 0 = not measured)
+static void runCycle(long jitter) {
+  int64_t start = esp_timer_get_time();
+  cycleFunction();
+  unsigned long exec = esp_timer_get_time() - start;
+
+  execBins[binOf(exec)]++;
+  maxExec = max(maxExec, exec);
+  totalExec += exec;
+  cycleCount++;
+
+  // Cycles per second, with everything else loop() does (FREE RUN) - measured each second
+  if(start - rateStart >= 1000000) {
+    cycleRate = (uint64_t)(cycleCount - rateCycles) * 1000000 / (start - rateStart);
+    rateStart = start;
+    rateCycles = cycleCount;
+  }
+
+  if(jitter >= 0) {
+    jitterBins[binOf(jitter)]++;
+    maxJitter = max(maxJitter, (unsigned long)jitter);
+
+    if(jitter + exec > scanPeriods[period]) {
+      overruns++; // still running when the next cycle was due
+    }
+  }
+}
+
+// Function to wake the scan task (esp_timer task)
+static void cycleTick(void *parameter) {
+  xTaskNotifyGive(scanTask);
+}
+
+// Function to run fixed-period cycles (scan task, core 1)
+static void scanLoop(void *parameter) {
+  for(;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    if(period == 0) {
+      continue; // switched to free run
+    }
+
+    unsigned int periodMicros = scanPeriods[period];
+    int64_t now = esp_timer_get_time();
+    long jitter = now - nextDue;
+
+    // Skip cycles that were missed completely
+    if(jitter >= (long)periodMicros) {
+      nextDue += (int64_t)(jitter / periodMicros) * periodMicros;
+      jitter = now - nextDue;
+    }
+
+    nextDue += periodMicros;
+    runCycle(max(jitter, 0L));
+  }
+}
+
+// Function to set up the scan task and timer (the cycle starts in FREE RUN)
+void scanBegin(void (*cycle)()) {
+  cycleFunction = cycle;
+
+  esp_timer_create_args_t timerArgs = {};
+  timerArgs.callback = cycleTick;
+  timerArgs.name = "scan";
+  esp_timer_create(&timerArgs, &cycleTimer);
+
+  // Above loop() on the same core, so drawing never delays a cycle
+  xTaskCreatePinnedToCore(scanLoop, "scan", 4096, nullptr, 5, &scanTask, 1);
+  scanReset();
+}
+
+// Function to select the cycle period (index into scanPeriods)
+void scanSetPeriod(byte index) {
+  if(index >= SCAN_PERIODS) {
+    index = 0;
+  }
+
+  esp_timer_stop(cycleTimer);
+  period = index;
+  scanReset();
+
+  if(period != 0) {
+    nextDue = esp_timer_get_time() + scanPeriods[period];
+    esp_timer_start_periodic(cycleTimer, scanPeriods[period]);
+  }
+}
+
+// Function to get the selected period index
+byte scanPeriod() {
+  return period;
+}
+
+// Function to check if the cycle runs in its own task
+bool scanFixed() {
+  return period != 0;
+}
+
+// Function to run one cycle from loop() in FREE RUN
+void scanFreeRun() {
+  runCycle(-1);
+}
+
+// Function to clear the statistics
+void scanReset() {
+  for(int i=0; i<SCAN_BINS; i++) {
+    jitterBins[i] = 0;
+    execBins[i] = 0;
+  }
+
+  cycleCount = 0;
+  overruns = 0;
+  maxJitter = 0;
+  maxExec = 0;
+  totalExec = 0;
+  cycleRate = 0;
+  rateStart = esp_timer_get_time();
+  rateCycles = 0;
+}
+
+// Function to get the cycles per second the execution time alone would allow (0 = not measured)
+static unsigned long execBound() {
+  return totalExec > 0 ? (uint64_t)cycleCount * 1000000 / totalExec : 0;
+}
+
+// Function to print a histogram on one line
+static void reportBins(Print &out, const char *name, const unsigned long *bins) {
+  out.printf("  %-7s", name);
+
+  for(int i=0; i<SCAN_BINS; i++) {
+    if(i < SCAN_BINS-1) {
+      out.printf(" <%u:%lu", scanBinLimits[i], bins[i]);
+    }
+    else {
+      out.printf(" >=%u:%lu", scanBinLimits[i-1], bins[i]);
+    }
+  }
+
+  out.println();
+}
+
+// Function to print the cycle statistics
+void scanReport(Print &out, bool histograms) {
+  if(period == 0) {
+    out.printf("Scan free run: %lu cycles, %lu/s (exec bound %lu/s), exec max %lu us\n", cycleCount, cycleRate, execBound(), maxExec);
+  }
+  else {
+    out.printf("Scan %u us: %lu cycles, %lu overruns, jitter max %lu us, exec max %lu us (bound %lu/s)\n",
+               scanPeriods[period], cycleCount, overruns, maxJitter, maxExec, execBound());
+  }
+
+  if(histograms) {
+    reportBins(out, "jitter", jitterBins);
+    reportBins(out, "exec", execBins);
+  }
+}
+
+// Function to draw one histogram as horizontal bars
+static void drawBins(const char *title, const unsigned long *bins, int y) {
+  unsigned long largest = 1;
+
+  for(int i=0; i<SCAN_BINS; i++) {
+    largest = max(largest, bins[i]);
+  }
+
+  sprite.setTextColor(tftWhite, tftBlack);
+  sprite.drawString(title, 4, y);
+
+  for(int i=0; i<SCAN_BINS; i++) {
+    int rowY = y + 12 + i * 9;
+    String label = i < SCAN_BINS-1 ? "<" + String(scanBinLimits[i]) : ">=" + String(scanBinLimits[i-1]);
+    int barWidth = bins[i] == 0 ? 0 : max(1, (int)(bins[i] * 112 / largest));
+
+    sprite.setTextColor(offWhite, tftBlack);
+    sprite.drawString(label, 4, rowY);
+    sprite.fillRect(48, rowY, barWidth, 7, period == 0 || (i < SCAN_BINS-1 && scanBinLimits[i] <= scanPeriods[period] / 2) ? seaGreen : orange);
+  }
+}
+
+// Function to draw the statistics page
+void drawScanStats() {
+  sprite.fillSprite(tftBlack);
+  sprite.setTextDatum(0);
+  sprite.setTextColor(tftWhite, tftBlack);
+  sprite.drawString(period == 0 ? "SCAN FREE RUN" : "SCAN " + String(scanPeriods[period] / 1000) + " ms", 4, 4, 2);
+
+  sprite.setTextColor(offWhite, tftBlack);
+  sprite.drawString("Cycles   " + String(cycleCount) + " (" + String(cycleRate) + "/s)", 4, 26);
+  sprite.drawString("Overruns " + String(overruns), 4, 36);
+  sprite.drawString("Jitter   " + String(maxJitter) + " us max", 4, 46);
+  sprite.drawString("Exec     " + String(maxExec) + " us max", 4, 56);
+
+  drawBins("START JITTER (us)", jitterBins, 72);
+  drawBins("EXECUTION TIME (us)", execBins, 178);
+
+  sprite.setTextColor(offWhite, tftBlack);
+  sprite.drawString("SEL: print to serial", 4, 280);
+  sprite.drawString("OK: reset", 4, 292);
+  sprite.drawString("BOTH: exit", 4, 304);
+  sprite.pushSprite(0, 0);
+}
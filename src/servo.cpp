@@ -0,0 +1,160 @@
+/*************************************************************
+****************** SERVO & PULSE-TRAIN OUTPUTS ***************
+**************************************************************/
+
+#include <Arduino.h>
+#include <driver/rmt.h> // for hardware-timed pulses
+#include "servo.h"
+
+#define NO_GPIO 255
+#define TICK_DIVIDER 80      // 80 MHz APB / 80 = 1 us per RMT tick
+#define FRAME_MICROS 20000   // servo frame (50 Hz)
+#define MIN_PULSE 500        // servo pulse at value 0 (us)
+#define MAX_PULSE 2500       // servo pulse at value 255 (us)
+#define BURST_HALF_PERIOD 500 // burst pulse high/low time (1 kHz)
+
+// Burst table - order must match the "SERVO MODE" menu
+const unsigned int servoBurstCounts[SERVO_MODES] = {0, 10, 100, 1000};
+
+// Per-pin configuration and channel mapping
+byte servoModes[SERVO_SLOTS] = {0};
+byte servoChannels[SERVO_SLOTS];
+
+// Channel bookkeeping and per-slot output state
+static byte channelOwners[SERVO_CHANNELS];
+static byte slotGpios[SERVO_SLOTS];
+static byte slotModes[SERVO_SLOTS]; // mode the channel was set up for
+static int lastValue[SERVO_SLOTS];
+static unsigned long burstEndTime[SERVO_SLOTS];
+
+
+// Function to build the RMT item of a servo frame for a value (0-255)
+static rmt_item32_t servoItem(int value) {
+  rmt_item32_t item;
+  uint32_t pulse = MIN_PULSE + (uint32_t)constrain(value, 0, 255) * (MAX_PULSE - MIN_PULSE) / 255;
+  item.level0 = 1;
+  item.duration0 = pulse;
+  item.level1 = 0;
+  item.duration1 = FRAME_MICROS - pulse;
+  return item;
+}
+
+// Function to initialize the channel table (call once before any attach)
+void servoBegin() {
+  for(byte c=0; c<SERVO_CHANNELS; c++) {
+    channelOwners[c] = NO_GPIO;
+  }
+
+  for(int i=0; i<SERVO_SLOTS; i++) {
+    servoChannels[i] = SERVO_NO_CHANNEL;
+    slotGpios[i] = NO_GPIO;
+    lastValue[i] = -1;
+  }
+}
+
+// Function to attach a pin slot to an RMT channel (returns false when the pin is held LOW)
+bool servoAttach(int slot, int gpio) {
+  if(servoModes[slot] >= SERVO_MODES) {
+    servoModes[slot] = SERVO_PULSE;
+  }
+
+  // Same pin and mode - keep the channel running. A new mode sets the channel up again,
+  // as the servo loop runs forever and a burst leaves autostop and a loop count behind
+  if(servoChannels[slot] != SERVO_NO_CHANNEL && slotGpios[slot] == gpio && slotModes[slot] == servoModes[slot]) {
+    return true;
+  }
+
+  servoDetach(slot);
+  slotGpios[slot] = gpio;
+  slotModes[slot] = servoModes[slot];
+  lastValue[slot] = -1;
+  burstEndTime[slot] = millis();
+
+  byte channel = SERVO_NO_CHANNEL;
+
+  for(byte c=0; c<SERVO_CHANNELS && channel == SERVO_NO_CHANNEL; c++) {
+    if(channelOwners[c] == NO_GPIO) {
+      channel = c;
+    }
+  }
+
+  if(channel == SERVO_NO_CHANNEL) { // out of channels - hold LOW
+    pinMode(gpio, OUTPUT);
+    digitalWrite(gpio, 0);
+    return false;
+  }
+
+  rmt_config_t config = RMT_DEFAULT_CONFIG_TX((gpio_num_t)gpio, (rmt_channel_t)channel);
+  config.clk_div = TICK_DIVIDER;
+  config.tx_config.idle_output_en = true; // LOW between bursts
+
+  if(rmt_config(&config) != ESP_OK || rmt_driver_install((rmt_channel_t)channel, 0, 0) != ESP_OK) {
+    pinMode(gpio, OUTPUT);
+    digitalWrite(gpio, 0);
+    return false;
+  }
+
+  channelOwners[channel] = slot;
+  servoChannels[slot] = channel;
+  return true;
+}
+
+// Function to release a pin slot and its channel
+void servoDetach(int slot) {
+  byte channel = servoChannels[slot];
+
+  if(channel != SERVO_NO_CHANNEL) {
+    rmt_tx_stop((rmt_channel_t)channel);
+    rmt_driver_uninstall((rmt_channel_t)channel);
+    channelOwners[channel] = NO_GPIO;
+    servoChannels[slot] = SERVO_NO_CHANNEL;
+  }
+
+  slotGpios[slot] = NO_GPIO;
+}
+
+// Function to update a pin slot (call every scan) - only touches the RMT when something changed
+void servoWrite(int slot, int value) {
+  byte channel = servoChannels[slot];
+
+  if(channel == SERVO_NO_CHANNEL || value == lastValue[slot]) {
+    return;
+  }
+
+  rmt_channel_t rmt = (rmt_channel_t)channel;
+  int previous = lastValue[slot];
+  lastValue[slot] = value;
+
+  // Servo - the first write starts the loop, later ones only replace the item
+  if(servoModes[slot] == SERVO_PULSE) {
+    rmt_item32_t item = servoItem(value);
+
+    if(previous < 0) {
+      rmt_set_tx_loop_mode(rmt, true);
+      rmt_write_items(rmt, &item, 1, false);
+    }
+    else {
+      rmt_fill_tx_items(rmt, &item, 1, 0); // taken over at the next frame
+    }
+
+    return;
+  }
+
+  // Burst - rising edge only, and not while the previous burst is still running
+  if(previous != 0 || value == 0 || (long)(millis() - burstEndTime[slot]) < 0) {
+    return;
+  }
+
+  unsigned int count = servoBurstCounts[servoModes[slot]];
+  rmt_item32_t item;
+  item.level0 = 1;
+  item.duration0 = BURST_HALF_PERIOD;
+  item.level1 = 0;
+  item.duration1 = BURST_HALF_PERIOD;
+
+  rmt_set_tx_loop_count(rmt, count);
+  rmt_enable_tx_loop_autostop(rmt, true);
+  rmt_set_tx_loop_mode(rmt, true);
+  rmt_write_items(rmt, &item, 1, false);
+  burstEndTime[slot] = millis() + count * BURST_HALF_PERIOD * 2 / 1000 + 1;
+}
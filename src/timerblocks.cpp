@@ -0,0 +1,153 @@
+/*************************************************************
+************************ TIMER BLOCKS ************************
+**************************************************************/
+
+#include <Arduino.h>
+#include "timerblocks.h"
+
+// Preset table - order must match the "TIME" menu
+const unsigned long blockPresetTimes[BLOCK_PRESETS] = {100, 250, 500, 1000, 2000, 5000, 10000, 30000, 60000};
+
+// Block configuration (stored in EEPROM)
+byte blockModes[TIMER_BLOCKS] = {BLOCK_OFF, BLOCK_OFF, BLOCK_OFF, BLOCK_OFF};
+byte blockTriggers[TIMER_BLOCKS] = {100, 100, 100, 100};
+byte blockPresets[TIMER_BLOCKS] = {3, 3, 3, 3};
+byte blockTimeSources[TIMER_BLOCKS] = {BLOCK_FIXED, BLOCK_FIXED, BLOCK_FIXED, BLOCK_FIXED};
+
+// Block state
+static bool lastTriggers[TIMER_BLOCKS];
+static unsigned long dueTimes[TIMER_BLOCKS]; // millis() at expiry
+static byte pending[TIMER_BLOCKS];           // running blocks, earliest deadline first
+static int pendingCount = 0;
+
+
+// Function to read a trigger signal (source encoding as for OUT pins)
+static bool triggerActive(byte source, const int *states) {
+  if(source < 100) { // direct signal
+    return states[source] != 0;
+  }
+
+  if(source > 100 && source < 200) { // inverted signal
+    return states[source - 100] == 0;
+  }
+
+  return false; // no trigger
+}
+
+// Function to work out the time of a block (preset, or preset scaled by an analog pin)
+static unsigned long blockTime(int block, const int *states) {
+  unsigned long time = blockPresetTimes[blockPresets[block]];
+
+  if(blockTimeSources[block] < 24) {
+    time = time * states[blockTimeSources[block]] / 255;
+  }
+
+  return time;
+}
+
+// Function to take a block out of the deadline queue
+static void cancel(int block) {
+  for(int i=0; i<pendingCount; i++) {
+    if(pending[i] == block) {
+      pendingCount--;
+      memmove(&pending[i], &pending[i+1], pendingCount - i);
+      return;
+    }
+  }
+}
+
+// Function to (re)start the timing of a block - insertion keeps the queue ordered
+// (deadlines are compared as differences to now, so millis() can wrap)
+static void start(int block, unsigned long now, const int *states) {
+  cancel(block);
+  dueTimes[block] = now + blockTime(block, states);
+
+  int i = pendingCount;
+
+  while(i > 0 && (long)(dueTimes[pending[i-1]] - now) > (long)(dueTimes[block] - now)) {
+    pending[i] = pending[i-1];
+    i--;
+  }
+
+  pending[i] = block;
+  pendingCount++;
+}
+
+// Function to clear every block (after a configuration change) - outputs go OFF, as
+// a pulse or off-delay that was running has lost its deadline
+void timerBlocksReset(int *states) {
+  pendingCount = 0;
+
+  for(int b=0; b<TIMER_BLOCKS; b++) {
+    lastTriggers[b] = false; // a trigger that is already ON counts as a rising edge
+    states[SIGNAL_TIMER_BLOCKS + b] = 0;
+  }
+}
+
+// Function to update the timer block signals (called once per scan)
+void timerBlocksEvaluate(int *states) {
+  unsigned long now = millis();
+
+  // Trigger edges
+  for(int b=0; b<TIMER_BLOCKS; b++) {
+    int *output = &states[SIGNAL_TIMER_BLOCKS + b];
+
+    if(blockModes[b] == BLOCK_OFF) {
+      *output = 0;
+      continue;
+    }
+
+    bool trigger = triggerActive(blockTriggers[b], states);
+
+    if(trigger == lastTriggers[b]) {
+      continue;
+    }
+
+    lastTriggers[b] = trigger;
+
+    switch(blockModes[b]) {
+      case BLOCK_TON:
+        if(trigger) {
+          start(b, now, states);
+        }
+        else {
+          cancel(b);
+          *output = 0;
+        }
+        break;
+
+      case BLOCK_TOF:
+        if(trigger) {
+          cancel(b);
+          *output = 1;
+        }
+        else {
+          start(b, now, states);
+        }
+        break;
+
+      case BLOCK_TP:
+        if(trigger && *output == 0) {
+          start(b, now, states);
+          *output = 1;
+        }
+        break;
+
+      case BLOCK_RETRIGGER:
+        if(trigger) {
+          start(b, now, states);
+          *output = 1;
+        }
+        break;
+    }
+  }
+
+  // Expired deadlines - the queue is ordered, so this stops at the first block not yet due
+  while(pendingCount > 0 && (long)(now - dueTimes[pending[0]]) >= 0) {
+    int b = pending[0];
+    pendingCount--;
+    memmove(&pending[0], &pending[1], pendingCount);
+
+    states[SIGNAL_TIMER_BLOCKS + b] = blockModes[b] == BLOCK_TON; // TON turns ON, the others end their pulse
+  }
+}
@@ -0,0 +1,76 @@
+/*************************************************************
+************************ TOUCH LOGIC *************************
+**************************************************************/
+
+#include "touch.h"
+
+#define FILTER_SHIFT 2    // IIR filter: 1/4 of each new reading
+#define BASELINE_SHIFT 6  // baseline follows drift with 1/64 of the difference
+#define RELEASE_EIGHTHS 7 // released below 7/8 of the threshold (hysteresis)
+
+// Threshold table - order must match the "THRESHOLD" menu
+const uint8_t touchPercents[TOUCH_LEVELS] = {5, 10, 20, 40};
+
+
+// Function to get the touch threshold (difference to the baseline) of a pad
+uint32_t touchThreshold(uint32_t baseline, uint8_t level) {
+  uint32_t threshold = baseline / 100 * touchPercents[level < TOUCH_LEVELS ? level : 1];
+  return threshold > 0 ? threshold : 1;
+}
+
+// Function to apply a touch or release event to a signal value
+int touchOutput(uint8_t mode, int output, bool touched) {
+  if(mode == TOUCH_TOGGLE) {
+    return touched ? !output : output;
+  }
+
+  return touched ? 1 : 0;
+}
+
+// Function to restart a model (the next reading becomes the baseline)
+void touchModelReset(TouchModel &model) {
+  model.filtered = 0;
+  model.baseline = 0;
+  model.touched = false;
+  model.started = false;
+}
+
+// Function to feed one reading into the model (true when the touch state changed)
+// The threshold is absolute, as programmed into the hardware (see touchThreshold)
+bool touchModelUpdate(TouchModel &model, uint32_t raw, uint32_t threshold) {
+  uint32_t scaled = raw << 4;
+
+  if(!model.started) {
+    model.filtered = scaled;
+    model.baseline = scaled;
+    model.started = true;
+    return false;
+  }
+
+  model.filtered += ((int32_t)(scaled - model.filtered)) >> FILTER_SHIFT;
+
+  threshold <<= 4;
+  uint32_t rise = model.filtered > model.baseline ? model.filtered - model.baseline : 0;
+
+  if(!model.touched && rise > threshold) {
+    model.touched = true;
+    return true;
+  }
+
+  if(model.touched && rise < threshold / 8 * RELEASE_EIGHTHS) {
+    model.touched = false;
+    return true;
+  }
+
+  // The baseline only tracks drift while the pad is released, so a held finger is not learned
+  if(!model.touched) {
+    model.baseline += ((int32_t)(model.filtered - model.baseline)) >> BASELINE_SHIFT;
+  }
+
+  return false;
+}
+
+// Function to get the baseline of a model
+uint32_t touchModelBaseline(const TouchModel &model) {
+  return model.baseline >> 4;
+}
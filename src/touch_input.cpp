@@ -0,0 +1,127 @@
+/*************************************************************
+*********************** TOUCH INPUTS *************************
+**************************************************************/
+
+#include <Arduino.h>
+#include <driver/touch_sensor.h> // for the hardware IIR filter
+#include "touch_input.h"
+
+#define NO_GPIO 255
+
+struct TouchEvent {
+  byte slot;
+  bool touched;
+};
+
+// Per-pin configuration (stored in EEPROM) and raw readings
+byte touchModes[TOUCH_SLOTS] = {0};
+byte touchLevels[TOUCH_SLOTS] = {0};
+uint32_t touchValues[TOUCH_SLOTS] = {0};
+
+// Per-slot state
+static byte slotGpios[TOUCH_SLOTS];
+static byte slotLevels[TOUCH_SLOTS];            // threshold level the pin was attached with
+static volatile bool slotTouched[TOUCH_SLOTS];  // last state reported by the interrupt
+static QueueHandle_t eventQueue;
+static bool filterEnabled = false;
+
+
+// Function to queue a touch or release (touch interrupt)
+static void IRAM_ATTR touchChange(void *parameter) {
+  byte slot = (byte)(uintptr_t)parameter;
+  TouchEvent event = {slot, touchInterruptGetLastStatus(slotGpios[slot])};
+  BaseType_t woken = pdFALSE;
+
+  slotTouched[slot] = event.touched;
+  xQueueSendFromISR(eventQueue, &event, &woken);
+  portYIELD_FROM_ISR(woken);
+}
+
+// Function to enable the IIR filter of the touch FSM (after the first pad is set up)
+static void enableFilter() {
+  touch_filter_config_t filter = {};
+  filter.mode = TOUCH_PAD_FILTER_IIR_16;
+  filter.debounce_cnt = 1;
+  filter.noise_thr = 0;
+  filter.jitter_step = 4;
+  filter.smh_lvl = TOUCH_PAD_SMOOTH_IIR_2;
+
+  touch_pad_filter_set_config(&filter);
+  touch_pad_filter_enable();
+  filterEnabled = true;
+}
+
+// Function to initialize the event queue (call once before any attach)
+void touchInputBegin() {
+  eventQueue = xQueueCreate(TOUCH_EVENT_QUEUE, sizeof(TouchEvent));
+
+  for(int i=0; i<TOUCH_SLOTS; i++) {
+    slotGpios[i] = NO_GPIO;
+  }
+}
+
+// Function to check if a GPIO is an ESP32-S3 touch channel
+bool touchCapable(int gpio) {
+  return gpio >= 1 && gpio <= 14;
+}
+
+// Function to attach a pin slot to its touch channel (false if the GPIO has none)
+// The reading at attach time is taken as the untouched baseline for the threshold
+bool touchInputAttach(int slot, int gpio) {
+  if(!touchCapable(gpio)) {
+    return false;
+  }
+
+  if(slotGpios[slot] == gpio && slotLevels[slot] == touchLevels[slot]) {
+    return true; // unchanged
+  }
+
+  touchInputDetach(slot);
+
+  uint32_t baseline = touchRead(gpio); // also sets the channel up
+
+  if(!filterEnabled) {
+    enableFilter();
+  }
+
+  slotGpios[slot] = gpio;
+  slotLevels[slot] = touchLevels[slot];
+  slotTouched[slot] = false;
+  touchValues[slot] = baseline;
+  touchAttachInterruptArg(gpio, touchChange, (void*)(uintptr_t)slot, touchThreshold(baseline, touchLevels[slot]));
+
+  return true;
+}
+
+// Function to release a pin slot
+void touchInputDetach(int slot) {
+  if(slotGpios[slot] != NO_GPIO) {
+    touchDetachInterrupt(slotGpios[slot]);
+    slotGpios[slot] = NO_GPIO;
+  }
+}
+
+// Function to check if a pad is being touched (display)
+bool touchInputActive(int slot) {
+  return slotGpios[slot] != NO_GPIO && slotTouched[slot];
+}
+
+// Function to apply the queued touch events to the signal values (called once per scan)
+void touchInputsRead(int *states) {
+  TouchEvent event;
+
+  while(xQueueReceive(eventQueue, &event, 0) == pdTRUE) {
+    if(slotGpios[event.slot] != NO_GPIO) { // ignore events of pins detached since
+      states[event.slot] = touchOutput(touchModes[event.slot], states[event.slot], event.touched);
+    }
+  }
+}
+
+// Function to take the raw reading of every touch pin (10 Hz job, display only)
+void touchInputsSample() {
+  for(int i=0; i<TOUCH_SLOTS; i++) {
+    if(slotGpios[i] != NO_GPIO) {
+      touchValues[i] = touchRead(slotGpios[i]);
+    }
+  }
+}
@@ -0,0 +1,333 @@
+/*************************************************************
+************************* TREND VIEW *************************
+**************************************************************/
+
+#include <Arduino.h>
+#include <TFT_eSPI.h>
+#include "trend.h"
+#include "signals.h"   // signal table layout
+#include "colours.h"   // UI colours and sprite colour depth
+#include "placement.h" // memory placement policy and map
+
+// Display objects and pin tables (main.cpp)
+extern TFT_eSPI lcd;
+extern TFT_eSprite sprite;
+extern int pinStates[SIGNAL_COUNT];
+extern byte pinTypes[SIGNAL_COUNT];
+extern String pinLabels1[SIGNAL_COUNT];
+
+// Page layout
+#define PLOT_X 5
+#define PLOT_Y 28
+#define STATUS_Y (PLOT_Y + TREND_HEIGHT + 6)
+#define STATUS_H 48
+
+// Trigger states
+#define TRIG_ARMED 0
+#define TRIG_RUNNING 1 // triggered, collecting post-trigger columns
+#define TRIG_HELD 2
+
+const unsigned int trendTimebases[TREND_TIMEBASES] = {10, 50, 200, 1000, 5000}; // ms per column
+
+// History ring - [slot][column][0 = min, 1 = max]
+static uint8_t (*history)[TREND_POINTS][2] = nullptr;
+static int head = 0;                    // next column to write
+static unsigned long columnCount = 0;   // columns committed since the last reset
+static unsigned long lastColumnTime = 0;
+static uint8_t columnMin[24];
+static uint8_t columnMax[24];
+
+// View state
+static byte mode = TREND_ROLL;
+static byte trigState = TRIG_ARMED;
+static int postRemaining = 0;
+static int trendPin = -1;
+static byte timebase = 1;
+static bool pageDrawn = false;
+static unsigned long drawnCount = 0;    // columns already in the plot sprite
+
+// Plot drawn in its own sprite so it can be scrolled and pushed on its own
+static TFT_eSprite plot = TFT_eSprite(&lcd);
+
+
+// Function to allocate the history buffer (bulk data - PSRAM)
+void trendBegin() {
+  history = (uint8_t (*)[TREND_POINTS][2])memAlloc("trend history", 24 * TREND_POINTS * 2, MEM_BULK);
+
+  for(int i=0; i<24; i++) {
+    columnMin[i] = 255;
+    columnMax[i] = 0;
+  }
+}
+
+// Function to clear the history (timebase change)
+static void resetHistory() {
+  if(history != nullptr) {
+    memset(history, 0, 24 * TREND_POINTS * 2);
+  }
+
+  head = 0;
+  columnCount = 0;
+  drawnCount = 0;
+  lastColumnTime = millis();
+}
+
+// Function to check the trigger condition on the newest column
+static void checkTrigger(int column) {
+  if(mode != TREND_TRIGGER || trendPin < 0) {
+    return;
+  }
+
+  if(trigState == TRIG_ARMED && columnCount > TREND_PRETRIGGER) {
+    int previous = (column + TREND_POINTS - 1) % TREND_POINTS;
+
+    if(history[trendPin][previous][1] < TREND_TRIGGER_LEVEL && history[trendPin][column][1] >= TREND_TRIGGER_LEVEL) {
+      trigState = TRIG_RUNNING;
+      postRemaining = TREND_POINTS - TREND_PRETRIGGER;
+    }
+  }
+  else if(trigState == TRIG_RUNNING) {
+    postRemaining--;
+
+    if(postRemaining <= 0) {
+      trigState = TRIG_HELD;
+    }
+  }
+}
+
+// Function to add the latest pin values to the history (called every scan)
+void trendSample() {
+  if(history == nullptr || (mode == TREND_TRIGGER && trigState == TRIG_HELD)) {
+    return; // capture held
+  }
+
+  // Min/max decimation of all samples within the current column
+  for(int i=0; i<24; i++) {
+    if(pinTypes[i] == 4) {
+      uint8_t value = pinStates[i];
+      columnMin[i] = min(columnMin[i], value);
+      columnMax[i] = max(columnMax[i], value);
+    }
+  }
+
+  unsigned long period = trendTimebases[timebase];
+
+  // Sampling was paused (menu) - only catch up on one screen width of columns
+  if(millis() - lastColumnTime > period * TREND_POINTS) {
+    lastColumnTime = millis() - period * TREND_POINTS;
+  }
+
+  while(millis() - lastColumnTime >= period) {
+    lastColumnTime += period;
+
+    for(int i=0; i<24; i++) {
+      if(columnMin[i] > columnMax[i]) { // no sample in this slot - hold the last value
+        columnMin[i] = columnMax[i] = pinStates[i];
+      }
+
+      history[i][head][0] = columnMin[i];
+      history[i][head][1] = columnMax[i];
+      columnMin[i] = 255;
+      columnMax[i] = 0;
+    }
+
+    int column = head;
+    head = (head + 1) % TREND_POINTS;
+    columnCount++;
+    checkTrigger(column);
+
+    if(mode == TREND_TRIGGER && trigState == TRIG_HELD) {
+      break;
+    }
+  }
+}
+
+// Function to find the next analog pin after the current one (-1 if none)
+static int nextAnalogPin(int from) {
+  for(int n=1; n<=24; n++) {
+    int i = (from + n + 24) % 24;
+
+    if(pinTypes[i] == 4) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+// Function to open the trend page
+void trendEnter(byte newMode) {
+  mode = newMode;
+  trigState = TRIG_ARMED;
+
+  if(trendPin < 0 || pinTypes[trendPin] != 4) {
+    trendPin = nextAnalogPin(-1);
+  }
+
+  pageDrawn = false;
+}
+
+// Function to show the next analog pin
+void trendNextPin() {
+  trendPin = nextAnalogPin(trendPin);
+  pageDrawn = false;
+}
+
+// Function to select the next timebase
+void trendNextTimebase() {
+  timebase = (timebase + 1) % TREND_TIMEBASES;
+  resetHistory();
+  trigState = TRIG_ARMED;
+  pageDrawn = false;
+}
+
+// Function to re-arm the trigger
+void trendArm() {
+  trigState = TRIG_ARMED;
+  pageDrawn = false;
+}
+
+// Function to get the current trend mode
+byte trendMode() {
+  return mode;
+}
+
+// Function to draw one history column at the given plot x position
+static void drawColumn(int x, int column) {
+  for(int y=0; y<TREND_HEIGHT; y+=32) { // horizontal grid
+    plot.drawPixel(x, y, grey);
+  }
+
+  if(mode == TREND_TRIGGER && (x & 1)) { // dotted trigger level
+    plot.drawPixel(x, (TREND_HEIGHT-1) - (TREND_TRIGGER_LEVEL >> 1), orange);
+  }
+
+  int top = (TREND_HEIGHT-1) - (history[trendPin][column][1] >> 1);
+  int bottom = (TREND_HEIGHT-1) - (history[trendPin][column][0] >> 1);
+  plot.drawFastVLine(x, top, bottom - top + 1, lightBlue);
+}
+
+// Function to shift the plot rows left with one memmove per row (TFT_eSprite::scroll() reads
+// and writes pixel by pixel, slow on packed 4-bpp rows) - returns the columns shifted
+static unsigned long shiftPlot(unsigned long columns) {
+#if SPRITE_DEPTH == 4
+  columns &= ~1UL; // two pixels per byte - an odd column waits for the next frame
+#endif
+  const size_t rowBytes = TREND_POINTS * SPRITE_DEPTH / 8;
+  const size_t shift = columns * SPRITE_DEPTH / 8;
+  uint8_t *row = (uint8_t*)plot.getPointer();
+
+  for(int y=0; y<TREND_HEIGHT; y++, row += rowBytes) {
+    memmove(row, row + shift, rowBytes - shift);
+    memset(row + rowBytes - shift, 0, shift); // black (palette index 0 / RGB 0)
+  }
+
+  return columns;
+}
+
+// Function to update the plot sprite - scrolls and draws only the new columns
+static void updatePlot() {
+  unsigned long pending = columnCount - drawnCount;
+  int columns = min(columnCount, (unsigned long)TREND_POINTS);
+
+  if(pending > TREND_POINTS || drawnCount == 0) { // full redraw
+    plot.fillSprite(tftBlack);
+
+    for(int c=0; c<columns; c++) {
+      drawColumn(TREND_POINTS - columns + c, (head + TREND_POINTS - columns + c) % TREND_POINTS);
+    }
+
+    drawnCount = columnCount;
+  }
+  else if(pending > 0) {
+    unsigned long shifted = shiftPlot(pending);
+
+    for(unsigned long c=0; c<shifted; c++) {
+      drawColumn(TREND_POINTS - shifted + c, (head + TREND_POINTS - pending + c) % TREND_POINTS);
+    }
+
+    drawnCount += shifted;
+  }
+}
+
+// Function to draw the status lines below the plot
+static void drawStatus() {
+  sprite.fillRect(0, STATUS_Y, 170, STATUS_H, tftBlack);
+  sprite.setTextDatum(0);
+  sprite.setTextColor(tftWhite, tftBlack);
+
+  String state = "ROLL";
+
+  if(mode == TREND_TRIGGER) {
+    state = trigState == TRIG_ARMED ? "ARMED" : (trigState == TRIG_RUNNING ? "TRIGGERED" : "HOLD");
+  }
+
+  int newest = (head + TREND_POINTS - 1) % TREND_POINTS;
+  int columns = min(columnCount, (unsigned long)TREND_POINTS);
+  int low = 255, high = 0;
+
+  for(int c=0; c<columns; c++) {
+    int column = (head + TREND_POINTS - 1 - c) % TREND_POINTS;
+    low = min(low, (int)history[trendPin][column][0]);
+    high = max(high, (int)history[trendPin][column][1]);
+  }
+
+  if(columns == 0) {
+    low = high = 0;
+  }
+
+  sprite.drawString("Mode: " + state, 4, STATUS_Y, 2);
+  sprite.drawString("Time: " + String(trendTimebases[timebase]) + "ms/px", 4, STATUS_Y+16, 2);
+  sprite.drawString("Last:" + String(history[trendPin][newest][1]) + " Min:" + String(low) + " Max:" + String(high), 4, STATUS_Y+32);
+}
+
+// Function to draw the trend page (first frame full, afterwards plot and status only)
+void drawTrend() {
+  if(!plot.created()) {
+    plot.setColorDepth(SPRITE_DEPTH);
+    plot.setAttribute(PSRAM_ENABLE, false); // scrolled every frame - keep in SRAM
+    plot.createSprite(TREND_POINTS, TREND_HEIGHT);
+
+#if SPRITE_DEPTH == 4
+    plot.createPalette(spritePalette, 16);
+#endif
+
+    memRegister("trend plot", plot.getPointer(), TREND_POINTS * TREND_HEIGHT * SPRITE_DEPTH / 8);
+  }
+
+  if(!pageDrawn) {
+    sprite.fillSprite(tftBlack);
+    sprite.setTextDatum(0);
+    sprite.setTextColor(tftWhite, tftBlack);
+
+    if(trendPin < 0) {
+      sprite.drawString("TREND", 4, 4, 2);
+      sprite.drawString("No analog pins", 4, 40, 2);
+      sprite.pushSprite(0, 0);
+      pageDrawn = true;
+      return;
+    }
+
+    sprite.drawString("TREND PIN " + pinLabels1[trendPin], 4, 4, 2);
+    sprite.drawRect(PLOT_X-1, PLOT_Y-1, TREND_POINTS+2, TREND_HEIGHT+2, grey);
+    sprite.setTextColor(offWhite, tftBlack);
+    sprite.drawString("SEL: next pin", 4, 280);
+    sprite.drawString(mode == TREND_ROLL ? "OK: timebase" : "OK: re-arm", 4, 292);
+    sprite.drawString("BOTH: exit", 4, 304);
+    drawStatus();
+    sprite.pushSprite(0, 0);
+
+    drawnCount = 0; // plot needs a full redraw
+    pageDrawn = true;
+  }
+
+  if(trendPin < 0) {
+    return;
+  }
+
+  updatePlot();
+  plot.pushSprite(PLOT_X, PLOT_Y);
+
+  drawStatus();
+  sprite.pushSprite(0, STATUS_Y, 0, STATUS_Y, 170, STATUS_H);
+}
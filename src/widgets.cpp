@@ -0,0 +1,276 @@
+/*************************************************************
+*********************** WIDGET STAMPS ************************
+**************************************************************/
+
+#include <Arduino.h>
+#include "widgets.h"
+#include "signals.h"   // signal table layout
+#include "colours.h"   // UI colours and sprite colour depth
+#include "placement.h" // memory placement policy and map
+
+// Display objects and UI tables (main.cpp)
+extern TFT_eSPI lcd;
+extern TFT_eSprite sprite;
+extern unsigned short typeColours[PIN_TYPES];
+extern unsigned short pinColours[24];
+extern unsigned short stateColours[2];
+extern String pinLabels1[SIGNAL_COUNT];
+extern String pinTypeLabels[PIN_TYPES];
+extern byte width;
+extern byte height;
+
+// Stamp sizes (widths are even so 4-bit stamps stay byte aligned)
+#define BADGE_W 12
+#define BADGE_H 13
+#define PILL_W 28
+#define PILL_H 13
+#define DOT_W 12
+#define DOT_H 11
+#define LEGEND_W 158
+#define LEGEND_H 12
+#define PILL_STAMPS 8
+#define NO_KEY 0xFFFFFFFF
+
+// Stamp cache - pixel buffers and the key each one was drawn with
+static uint8_t *pinBoxStamps[24][2];  // [slot][0 = pin colour, 1 = type colour]
+static uint32_t pinBoxKeys[24][2];
+static uint8_t *badgeStamps[PIN_TYPES];
+static uint32_t badgeKeys[PIN_TYPES];
+static uint8_t *pillStamps[PILL_STAMPS];
+static uint32_t pillKeys[PILL_STAMPS];
+static uint8_t *dotStamps[2];
+static uint32_t dotKeys[2];
+static uint8_t *legendStamps[2];      // [0 = light background, 1 = dark background]
+static uint32_t legendKeys[2];
+static bool stampsAllocated = false;
+
+// Off-screen sprite the stamps are rendered in
+static TFT_eSprite scratch = TFT_eSprite(&lcd);
+
+
+// Function to draw a filled rounded box (anti-aliased unless the sprite uses a palette)
+void fillBox(TFT_eSprite &target, int x, int y, int w, int h, int radius, unsigned short colour, uint32_t bgColour) {
+#if SPRITE_DEPTH == 4
+  target.fillRoundRect(x, y, w, h, radius, colour);
+#else
+  target.fillSmoothRoundRect(x, y, w, h, radius, colour, bgColour);
+#endif
+}
+
+// Function to draw a filled circle (anti-aliased unless the sprite uses a palette)
+void fillDot(TFT_eSprite &target, int x, int y, int radius, unsigned short colour, uint32_t bgColour) {
+#if SPRITE_DEPTH == 4
+  target.fillCircle(x, y, radius, colour);
+#else
+  target.fillSmoothCircle(x, y, radius, colour, bgColour);
+#endif
+}
+
+// Function to get the buffer size of a stamp
+static size_t stampBytes(int w, int h) {
+  return (size_t)w * h * SPRITE_DEPTH / 8;
+}
+
+// Function to carve all stamp buffers out of one internal SRAM block
+static void allocateStamps() {
+  int boxW = (width + 1) & ~1;
+  size_t total = 48 * stampBytes(boxW, height) + PIN_TYPES * stampBytes(BADGE_W, BADGE_H) +
+                 PILL_STAMPS * stampBytes(PILL_W, PILL_H) + 2 * stampBytes(DOT_W, DOT_H) + 2 * stampBytes(LEGEND_W, LEGEND_H);
+  uint8_t *pool = (uint8_t*)memAlloc("widget stamps", total, MEM_FAST);
+
+  for(int i=0; i<24; i++) {
+    for(int v=0; v<2; v++) {
+      pinBoxStamps[i][v] = pool;
+      pool += stampBytes(boxW, height);
+    }
+  }
+
+  for(int t=0; t<PIN_TYPES; t++) {
+    badgeStamps[t] = pool;
+    pool += stampBytes(BADGE_W, BADGE_H);
+  }
+
+  for(int p=0; p<PILL_STAMPS; p++) {
+    pillStamps[p] = pool;
+    pool += stampBytes(PILL_W, PILL_H);
+  }
+
+  for(int s=0; s<2; s++) {
+    dotStamps[s] = pool;
+    pool += stampBytes(DOT_W, DOT_H);
+    legendStamps[s] = pool;
+    pool += stampBytes(LEGEND_W, LEGEND_H);
+  }
+
+  scratch.setColorDepth(SPRITE_DEPTH);
+  scratch.setAttribute(PSRAM_ENABLE, false);
+  stampsAllocated = true;
+  widgetsInvalidate();
+}
+
+// Function to start rendering a stamp
+static void renderBegin(int w, int h, unsigned short bgColour) {
+  scratch.createSprite(w, h);
+  scratch.fillSprite(bgColour);
+  scratch.setTextDatum(4);
+}
+
+// Function to store the rendered stamp
+static void renderEnd(uint8_t *pixels, int w, int h) {
+  memcpy(pixels, scratch.getPointer(), stampBytes(w, h));
+  scratch.deleteSprite();
+}
+
+// Function to copy a stamp into the frame sprite
+static void blit(const uint8_t *pixels, int x, int y, int w, int h) {
+#if SPRITE_DEPTH == 8
+  sprite.pushImage(x, y, w, h, pixels, true);   // RGB332
+#else
+  sprite.pushImage(x, y, w, h, (uint16_t*)pixels); // RGB565 or packed 4-bit indices
+#endif
+}
+
+// Function to drop all stamps so they are redrawn on next use
+void widgetsInvalidate() {
+  for(int i=0; i<24; i++) {
+    pinBoxKeys[i][0] = NO_KEY;
+    pinBoxKeys[i][1] = NO_KEY;
+  }
+
+  for(int t=0; t<PIN_TYPES; t++) {
+    badgeKeys[t] = NO_KEY;
+  }
+
+  for(int p=0; p<PILL_STAMPS; p++) {
+    pillKeys[p] = NO_KEY;
+  }
+
+  for(int s=0; s<2; s++) {
+    dotKeys[s] = NO_KEY;
+    legendKeys[s] = NO_KEY;
+  }
+}
+
+// Function to draw a pin box (label on a rounded box, light background)
+void drawPinBox(int slot, int x, int y, unsigned short colour) {
+  if(!stampsAllocated) {
+    allocateStamps();
+  }
+
+  int boxW = (width + 1) & ~1;
+  int variant = colour == pinColours[slot] ? 0 : 1;
+  uint8_t *stamp = pinBoxStamps[slot][variant];
+
+  if(pinBoxKeys[slot][variant] != colour) {
+    renderBegin(boxW, height, offWhite);
+    fillBox(scratch, 0, 0, width, height, 2, colour, offWhite);
+    scratch.setTextColor(tftWhite, colour);
+    scratch.drawString(pinLabels1[slot], width/2, height/2, 2);
+    renderEnd(stamp, boxW, height);
+    pinBoxKeys[slot][variant] = colour;
+  }
+
+  blit(stamp, x, y, boxW, height);
+}
+
+// Function to draw a pin type badge (first letter of the type on its colour)
+void drawTypeBadge(int type, int x, int y) {
+  if(!stampsAllocated) {
+    allocateStamps();
+  }
+
+  uint8_t *stamp = badgeStamps[type];
+
+  if(badgeKeys[type] != typeColours[type]) {
+    renderBegin(BADGE_W, BADGE_H, offWhite);
+    fillBox(scratch, 0, 0, BADGE_W, BADGE_H, 2, typeColours[type]);
+    scratch.setTextColor(tftWhite, typeColours[type]);
+    scratch.drawString(pinTypeLabels[type].substring(0, 1), 6, 1+BADGE_H/2);
+    renderEnd(stamp, BADGE_W, BADGE_H);
+    badgeKeys[type] = typeColours[type];
+  }
+
+  blit(stamp, x, y, BADGE_W, BADGE_H);
+}
+
+// Function to draw an empty value pill crossing a connection line
+void drawValuePill(int x, int y, unsigned short colour, unsigned short lineColour) {
+  if(!stampsAllocated) {
+    allocateStamps();
+  }
+
+  uint32_t key = ((uint32_t)colour << 16) | lineColour;
+  int slot = -1;
+
+  for(int p=0; p<PILL_STAMPS; p++) {
+    if(pillKeys[p] == key) {
+      slot = p;
+      break;
+    }
+
+    if(slot < 0 && pillKeys[p] == NO_KEY) {
+      slot = p;
+    }
+  }
+
+  if(slot < 0) { // cache full - reuse the first entry
+    slot = 0;
+  }
+
+  if(pillKeys[slot] != key) {
+    renderBegin(PILL_W, PILL_H, offWhite);
+    scratch.drawFastHLine(0, 6, PILL_W, lineColour);
+    scratch.drawFastHLine(0, 7, PILL_W, lineColour);
+    fillBox(scratch, 0, 0, PILL_W-1, PILL_H, 4, colour);
+    renderEnd(pillStamps[slot], PILL_W, PILL_H);
+    pillKeys[slot] = key;
+  }
+
+  blit(pillStamps[slot], x, y, PILL_W, PILL_H);
+}
+
+// Function to draw a digital state dot with its 0/1 label on a connection line
+void drawStateDot(int state, int centreX, int centreY) {
+  if(!stampsAllocated) {
+    allocateStamps();
+  }
+
+  state = state != 0; // any non-zero value shows as 1
+
+  if(dotKeys[state] != stateColours[state]) {
+    renderBegin(DOT_W, DOT_H, offWhite);
+    scratch.drawFastHLine(0, 5, DOT_W, stateColours[state]);
+    scratch.drawFastHLine(0, 6, DOT_W, stateColours[state]);
+    fillDot(scratch, 5, 5, 5, stateColours[state], tftWhite);
+    scratch.setTextColor(tftWhite, stateColours[state]);
+    scratch.drawString(String(state), 6, 6);
+    renderEnd(dotStamps[state], DOT_W, DOT_H);
+    dotKeys[state] = stateColours[state];
+  }
+
+  blit(dotStamps[state], centreX-5, centreY-5, DOT_W, DOT_H);
+}
+
+// Function to draw the colour-coded pin type legend
+void drawTypeLegend(int x, int y, unsigned short bgColour, int textOffset) {
+  if(!stampsAllocated) {
+    allocateStamps();
+  }
+
+  int variant = bgColour == offWhite ? 0 : 1;
+
+  if(legendKeys[variant] != bgColour) {
+    renderBegin(LEGEND_W, LEGEND_H, bgColour);
+
+    for(int i=0; i<5; i++) {
+      fillBox(scratch, i*32, 0, 30, 12, 2, typeColours[i], bgColour);
+      scratch.setTextColor(tftWhite, typeColours[i]);
+      scratch.drawString(pinTypeLabels[i], i*32+30/2, textOffset);
+    }
+
+    renderEnd(legendStamps[variant], LEGEND_W, LEGEND_H);
+    legendKeys[variant] = bgColour;
+  }
+
+  blit(legendStamps[variant], x, y, LEGEND_W, LEGEND_H);
+}
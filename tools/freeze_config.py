@@ -0,0 +1,87 @@
+# Frozen configuration: turns an EEPROM image into constexpr tables for the frozen scan
+#
+# As a PlatformIO pre-script (env:frozen) the image is the custom_frozen_image option and
+# the header is generated into the build directory. Standalone:
+#   python tools/freeze_config.py image.eep frozen_config.h
+#
+# The image has the EEPROM layout of readEprom()/writeEprom() in src/main.cpp - the
+# simulator saves one with -e, or it can be read back from a configured unit.
+
+import os
+import sys
+
+SIGNAL_COUNT = 68
+SIGNAL_EXPANDERS = 32
+SIGNAL_TIMER_BLOCKS = 64
+EXPANDER_SLOTS = SIGNAL_TIMER_BLOCKS - SIGNAL_EXPANDERS
+SERVO_MODES = 4
+
+# EEPROM addresses (see readEprom)
+TYPES = 0
+SOURCES = 24
+SERVO_MODE = 241
+EXPANDER_TYPES = 161
+EXPANDER_SOURCES = 193
+
+
+def tables(image):
+    image = image.ljust(SERVO_MODE + 24, b"\xff")  # missing bytes read as erased flash
+    types = [0] * SIGNAL_COUNT
+    sources = [100] * SIGNAL_COUNT
+    servo_modes = [0] * 24
+
+    # Header pins (invalid types are reset as in readEprom, 6 is the T1/T2 type)
+    for i in range(24):
+        types[i] = image[TYPES + i] if image[TYPES + i] <= 9 and image[TYPES + i] != 6 else 0
+        sources[i] = image[SOURCES + i]
+        servo_modes[i] = image[SERVO_MODE + i] if image[SERVO_MODE + i] < SERVO_MODES else 0
+
+    # Buttons and timers keep their boot types (they are not stored)
+    types[24:28] = [1, 2, 6, 6]
+
+    # Expander pins are INP, OUT or not set
+    for x in range(EXPANDER_SLOTS):
+        if image[EXPANDER_TYPES + x] in (1, 3):
+            types[SIGNAL_EXPANDERS + x] = image[EXPANDER_TYPES + x]
+            sources[SIGNAL_EXPANDERS + x] = image[EXPANDER_SOURCES + x]
+
+    return types, sources, servo_modes
+
+
+def array(name, values, per_line=24):
+    lines = [", ".join(str(v) for v in values[n:n + per_line]) for n in range(0, len(values), per_line)]
+    return "constexpr uint8_t %s[%d] = {\n  %s\n};\n" % (name, len(values), ",\n  ".join(lines))
+
+
+def freeze(image_path, header_path):
+    with open(image_path, "rb") as file:
+        image = file.read()
+
+    types, sources, servo_modes = tables(image)
+    text = "// Generated by tools/freeze_config.py from %s - do not edit\n" % os.path.basename(image_path)
+    text += "#ifndef TIOS_FROZEN_CONFIG_H\n#define TIOS_FROZEN_CONFIG_H\n\n#include <stdint.h>\n\n"
+    text += array("frozenTypes", types) + "\n"
+    text += array("frozenSources", sources) + "\n"
+    text += array("frozenServoModes", servo_modes) + "\n"
+    text += "// Stored configuration (installed into EEPROM at boot)\n"
+    text += array("frozenImage", list(image), 32) + "\n#endif\n"
+
+    os.makedirs(os.path.dirname(os.path.abspath(header_path)), exist_ok=True)
+
+    if not os.path.exists(header_path) or open(header_path).read() != text:  # keep the timestamp when unchanged
+        with open(header_path, "w") as file:
+            file.write(text)
+
+
+if __name__ == "__main__":
+    if len(sys.argv) != 3:
+        sys.exit("usage: freeze_config.py image.eep frozen_config.h")
+
+    freeze(sys.argv[1], sys.argv[2])
+else:
+    Import("env")
+
+    image = os.path.join(env.subst("$PROJECT_DIR"), env.GetProjectOption("custom_frozen_image"))
+    generated = os.path.join(env.subst("$BUILD_DIR"), "frozen")
+    freeze(image, os.path.join(generated, "frozen_config.h"))
+    env.Append(CPPPATH=[generated])
@@ -0,0 +1,267 @@
+# Screen mirroring: decodes the framebuffer stream of "mirror on" (include/fbcodec.h) into PNGs
+#
+# Live, from the USB serial port (needs pyserial; sends "mirror on", Ctrl+C stops):
+#   python tools/mirror.py --port /dev/ttyACM0 out_dir
+# From a recording (e.g. the simulator's serial output, tios-sim -o stream.bin):
+#   python tools/mirror.py stream.bin out_dir
+#
+# Each complete frame is written as out_dir/frame_NNNNN.png. Text between frames (boot
+# messages, the mirror report) is passed through to stdout. A frame with a bad checksum
+# is dropped, and so are the deltas after it until the next key frame. --sums FILE lists
+# each frame with the CRC-32 of its RGB pixels (see sim/mirror_test.py).
+
+import argparse
+import os
+import struct
+import sys
+import zlib
+
+MAGIC = b"TFB1"
+HEADER_BYTES = 16
+CHECK_BYTES = 4
+KEY = 0
+DELTA = 1
+TILE = 16
+
+
+def unpack_bits(data, pos, units, unit):
+    """PackBits-decompress units (1 or 2 bytes each), returns (bytes, next position)."""
+    out = bytearray()
+
+    while len(out) < units * unit:
+        control = data[pos]
+        pos += 1
+
+        if control < 128:
+            count = (control + 1) * unit
+            out += data[pos:pos + count]
+            pos += count
+        else:
+            out += data[pos:pos + unit] * (control - 126)
+            pos += unit
+
+    if len(out) != units * unit:
+        raise ValueError("run past the end of the block")
+
+    return bytes(out), pos
+
+
+class Screen:
+    """Frame buffer in the sprite's raw format, updated by key and delta frames."""
+
+    def __init__(self):
+        self.buffer = None
+        self.format = None
+        self.palette = None
+
+    def row_bytes(self):
+        width, _, depth = self.format
+        return width * depth // 8
+
+    def key(self, fmt, payload):
+        width, height, depth = fmt
+        pos = 0
+
+        if depth == 4:
+            self.palette = struct.unpack_from("<16H", payload, 0)
+            pos = 32
+
+        unit = 2 if depth == 16 else 1
+        self.format = fmt
+        self.buffer, pos = unpack_bits(payload, pos, width * height * depth // 8 // unit, unit)
+        self.buffer = bytearray(self.buffer)
+
+    def delta(self, fmt, payload):
+        if self.buffer is None or fmt != self.format:
+            raise ValueError("delta without a key frame")
+
+        width, height, depth = fmt
+        row_bytes = self.row_bytes()
+        tile_bytes = TILE * depth // 8
+        unit = 2 if depth == 16 else 1
+        tiles_x = (width + TILE - 1) // TILE
+        tiles_y = (height + TILE - 1) // TILE
+        pos = (tiles_x * tiles_y + 7) // 8
+
+        for index in range(tiles_x * tiles_y):
+            if not payload[index // 8] & (1 << (index % 8)):
+                continue
+
+            ty, tx = divmod(index, tiles_x)
+            y0 = ty * TILE
+            x0 = tx * tile_bytes
+            rows = min(TILE, height - y0)
+            size = min(tile_bytes, row_bytes - x0)
+            tile, pos = unpack_bits(payload, pos, rows * size // unit, unit)
+
+            for y in range(rows):
+                offset = (y0 + y) * row_bytes + x0
+                self.buffer[offset:offset + size] = tile[y * size:(y + 1) * size]
+
+    def rgb(self):
+        """The frame as RGB rows."""
+        width, height, depth = self.format
+        rows = []
+
+        for y in range(height):
+            line = self.buffer[y * self.row_bytes():(y + 1) * self.row_bytes()]
+            row = bytearray()
+
+            for x in range(width):
+                if depth == 4:
+                    index = line[x // 2] >> 4 if x % 2 == 0 else line[x // 2] & 0x0F
+                    row += rgb565(self.palette[index])
+                elif depth == 8:
+                    value = line[x]
+                    row += bytes(((value >> 5) * 255 // 7, ((value >> 2) & 7) * 255 // 7, (value & 3) * 255 // 3))
+                else:
+                    row += rgb565(line[2 * x] << 8 | line[2 * x + 1])
+
+            rows.append(bytes(row))
+
+        return rows
+
+
+def rgb565(value):
+    return bytes(((value >> 11) * 255 // 31, ((value >> 5) & 0x3F) * 255 // 63, (value & 0x1F) * 255 // 31))
+
+
+def write_png(path, width, height, rows):
+    def chunk(kind, data):
+        return struct.pack(">I", len(data)) + kind + data + struct.pack(">I", zlib.crc32(kind + data))
+
+    raw = b"".join(b"\x00" + row for row in rows)
+
+    with open(path, "wb") as file:
+        file.write(b"\x89PNG\r\n\x1a\n")
+        file.write(chunk(b"IHDR", struct.pack(">IIBBBBB", width, height, 8, 2, 0, 0, 0)))
+        file.write(chunk(b"IDAT", zlib.compress(raw)))
+        file.write(chunk(b"IEND", b""))
+
+
+class Decoder:
+    """Splits the byte stream into frames and text, and writes the frames."""
+
+    def __init__(self, out_dir, sums=None):
+        self.out_dir = out_dir
+        self.sums = sums
+        self.screen = Screen()
+        self.pending = bytearray()
+        self.synced = False  # a key frame has been decoded since the last bad frame
+        self.frames = 0
+        self.dropped = 0
+
+    def feed(self, data):
+        self.pending += data
+
+        while True:
+            start = self.pending.find(MAGIC)
+
+            if start < 0:
+                keep = len(MAGIC) - 1  # the magic may be split across reads
+                self.text(self.pending[:-keep] if len(self.pending) > keep else b"")
+                del self.pending[:max(len(self.pending) - keep, 0)]
+                return
+
+            self.text(self.pending[:start])
+            del self.pending[:start]
+
+            if len(self.pending) < HEADER_BYTES:
+                return
+
+            kind, depth, width, height, number, length = struct.unpack_from("<BBHHHI", self.pending, 4)
+            size = HEADER_BYTES + length + CHECK_BYTES
+
+            if kind not in (KEY, DELTA) or depth not in (4, 8, 16) or length > width * height * 3 + 4096:
+                self.text(self.pending[:1])  # not a frame header
+                del self.pending[:1]
+                continue
+
+            if len(self.pending) < size:
+                return
+
+            frame = bytes(self.pending[:size])
+            del self.pending[:size]
+            self.frame(frame, kind, (width, height, depth), number, length)
+
+    def frame(self, frame, kind, fmt, number, length):
+        check, = struct.unpack_from("<I", frame, HEADER_BYTES + length)
+        payload = frame[HEADER_BYTES:HEADER_BYTES + length]
+
+        try:
+            if zlib.adler32(frame[:HEADER_BYTES + length]) != check:
+                raise ValueError("bad checksum")
+
+            if kind == KEY:
+                self.screen.key(fmt, payload)
+                self.synced = True
+            elif self.synced:
+                self.screen.delta(fmt, payload)
+            else:
+                self.dropped += 1
+                return
+        except (ValueError, IndexError) as error:
+            print("mirror: frame %d dropped (%s)" % (number, error), file=sys.stderr)
+            self.synced = False
+            self.dropped += 1
+            return
+
+        self.frames += 1
+        name = "frame_%05d.png" % self.frames
+        rows = self.screen.rgb()
+        write_png(os.path.join(self.out_dir, name), fmt[0], fmt[1], rows)
+
+        if self.sums is not None:
+            self.sums.write("%s %s %08x\n" % (name, "key" if kind == KEY else "delta", zlib.crc32(b"".join(rows))))
+
+    def finish(self):
+        """Passes the text held back for a split magic through (end of a recording)."""
+        self.text(bytes(self.pending))
+        del self.pending[:]
+
+    def text(self, data):
+        if data:
+            sys.stdout.write(data.decode("ascii", "replace"))
+            sys.stdout.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode the screen mirroring stream into PNG files")
+    parser.add_argument("source", nargs="?", help="recorded stream (omit with --port)")
+    parser.add_argument("out_dir", help="directory for the PNG files")
+    parser.add_argument("--port", help="serial port of the unit (live)")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--sums", help="file for the frame checksums")
+    args = parser.parse_args()
+
+    if (args.port is None) == (args.source is None):
+        parser.error("give either a recorded stream or --port")
+
+    os.makedirs(args.out_dir, exist_ok=True)
+    sums = open(args.sums, "w") if args.sums else None
+    decoder = Decoder(args.out_dir, sums)
+
+    if args.port is None:
+        with open(args.source, "rb") as file:
+            decoder.feed(file.read())
+            decoder.finish()
+    else:
+        import serial  # pyserial
+
+        with serial.Serial(args.port, args.baud, timeout=0.1) as port:
+            port.write(b"mirror on\n")
+
+            try:
+                while True:
+                    decoder.feed(port.read(4096))
+            except KeyboardInterrupt:
+                port.write(b"mirror off\n")
+
+    if sums is not None:
+        sums.close()
+
+    print("mirror: %d frames written, %d dropped" % (decoder.frames, decoder.dropped), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()